@@ -0,0 +1,85 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_BATCH_BATCH_H
+#define LV2_BATCH_BATCH_H
+
+/**
+   @defgroup batch Batch
+   @ingroup lv2
+
+   Running several instances of a plugin in one call.
+
+   See <http://lv2plug.in/ns/ext/batch> for details.
+
+   @{
+*/
+
+#include <lv2/core/lv2.h>
+
+#include <stdint.h>
+
+// clang-format off
+
+#define LV2_BATCH_URI    "http://lv2plug.in/ns/ext/batch"  ///< http://lv2plug.in/ns/ext/batch
+#define LV2_BATCH_PREFIX LV2_BATCH_URI "#"                 ///< http://lv2plug.in/ns/ext/batch#
+
+#define LV2_BATCH__interface LV2_BATCH_PREFIX "interface"  ///< http://lv2plug.in/ns/ext/batch#interface
+
+// clang-format on
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Plugin interface for running several instances in lockstep.
+
+   The plugin's extension_data() method should return an LV2_Batch_Interface
+   when called with LV2_BATCH__interface as its argument.
+*/
+typedef struct {
+  /**
+     The maximum number of instances in a batch, or zero for no limit.
+
+     Hosts with more instances than this must run them in several batches.
+  */
+  uint32_t max_instances;
+
+  /**
+     Run several instances of the plugin for a block.
+
+     This has the same effect as connecting the ports of every instance to
+     its part of the batch buffers, then calling LV2_Descriptor::run() for
+     each, so the same rules apply.  Ports connected with connect_port() are
+     not used or changed.
+
+     Each port has a single buffer for the whole batch.  For audio and CV
+     ports, this is an array of `sample_count * n_instances` floats where
+     sample `s` of instance `i` is at index `s * n_instances + i`.  For
+     control ports, it is an array of `n_instances` floats.  For other ports,
+     it is an array of `n_instances` pointers to the buffer of each instance.
+
+     This function is in the audio threading class for every instance.
+
+     @param instances Array of `n_instances` distinct instances, which must
+     all be from the same descriptor and activated.
+     @param n_instances Number of instances in the batch, at least 1.
+     @param ports Array of batch buffers for every port, indexed by port.
+     @param sample_count The block size in samples.
+  */
+  void (*run_batch)(const LV2_Handle* instances,
+                    uint32_t          n_instances,
+                    void* const*      ports,
+                    uint32_t          sample_count);
+} LV2_Batch_Interface;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_BATCH_BATCH_H
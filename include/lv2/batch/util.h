@@ -0,0 +1,101 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_BATCH_UTIL_H
+#define LV2_BATCH_UTIL_H
+
+/**
+   @file util.h Helpers for the batch buffer layout.
+
+   Hosts that keep a separate buffer for each instance can use these to copy
+   audio and CV signals into a batch buffer before run_batch(), and back out
+   afterwards.  Hosts that allocate batch buffers directly, and plugins, can
+   use lv2_batch_index() to find the value of an instance.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup batch_util Utilities
+   @ingroup batch
+
+   Helpers for the batch buffer layout.
+
+   @{
+*/
+
+#include <lv2/batch/batch.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Return the index of a sample of an instance in a batch audio buffer.
+*/
+static inline size_t
+lv2_batch_index(const uint32_t n_instances,
+                const uint32_t instance,
+                const uint32_t sample)
+{
+  return ((size_t)sample * n_instances) + instance;
+}
+
+/**
+   Copy separate signals of every instance into a batch buffer.
+
+   @param batch Batch buffer of `sample_count * n_instances` floats.
+   @param buffers Array of `n_instances` buffers of `sample_count` floats.
+   @param n_instances Number of instances in the batch.
+   @param sample_count Number of samples to copy.
+*/
+static inline void
+lv2_batch_interleave(float* const              batch,
+                     const float* const* const buffers,
+                     const uint32_t            n_instances,
+                     const uint32_t            sample_count)
+{
+  for (uint32_t i = 0U; i < n_instances; ++i) {
+    const float* const buffer = buffers[i];
+    for (uint32_t s = 0U; s < sample_count; ++s) {
+      batch[lv2_batch_index(n_instances, i, s)] = buffer[s];
+    }
+  }
+}
+
+/**
+   Copy the signals of every instance from a batch buffer to separate ones.
+
+   @param buffers Array of `n_instances` buffers of `sample_count` floats.
+   @param batch Batch buffer of `sample_count * n_instances` floats.
+   @param n_instances Number of instances in the batch.
+   @param sample_count Number of samples to copy.
+*/
+static inline void
+lv2_batch_deinterleave(float* const* const buffers,
+                       const float* const  batch,
+                       const uint32_t      n_instances,
+                       const uint32_t      sample_count)
+{
+  for (uint32_t i = 0U; i < n_instances; ++i) {
+    float* const buffer = buffers[i];
+    for (uint32_t s = 0U; s < sample_count; ++s) {
+      buffer[s] = batch[lv2_batch_index(n_instances, i, s)];
+    }
+  }
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_BATCH_UTIL_H
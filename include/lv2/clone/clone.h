@@ -0,0 +1,69 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_CLONE_CLONE_H
+#define LV2_CLONE_CLONE_H
+
+/**
+   @defgroup clone Clone
+   @ingroup lv2
+
+   Duplicating plugin instances.
+
+   See <http://lv2plug.in/ns/ext/clone> for details.
+
+   @{
+*/
+
+#include <lv2/core/lv2.h>
+
+// clang-format off
+
+#define LV2_CLONE_URI    "http://lv2plug.in/ns/ext/clone"  ///< http://lv2plug.in/ns/ext/clone
+#define LV2_CLONE_PREFIX LV2_CLONE_URI "#"                 ///< http://lv2plug.in/ns/ext/clone#
+
+#define LV2_CLONE__interface LV2_CLONE_PREFIX "interface"  ///< http://lv2plug.in/ns/ext/clone#interface
+
+// clang-format on
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Plugin interface for creating a copy of an instance.
+
+   The plugin's extension_data() method should return an LV2_Clone_Interface
+   when called with LV2_CLONE__interface as its argument.
+*/
+typedef struct {
+  /**
+     Create a copy of an instance.
+
+     The returned instance is equivalent to the original, as if it had been
+     instantiated with the same sample rate and bundle path and had its state
+     and signal processing state copied.  It is activated if the original is,
+     and has no ports connected.  Immutable resources may be shared with the
+     original, but either instance may be cleaned up first.
+
+     This function is in the instantiation threading class, and must not be
+     called concurrently with any other function of `instance`.
+
+     @param instance The instance to copy.
+     @param features Features for the new instance, as for instantiate().  Any
+     URID map must be consistent with that of the original.
+     @return A new instance, or NULL on error, in which case the host may
+     instantiate the plugin and restore its state instead.
+  */
+  LV2_Handle (*clone)(LV2_Handle instance, const LV2_Feature* const* features);
+} LV2_Clone_Interface;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_CLONE_CLONE_H
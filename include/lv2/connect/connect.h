@@ -0,0 +1,72 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_CONNECT_CONNECT_H
+#define LV2_CONNECT_CONNECT_H
+
+/**
+   @defgroup connect Connect
+   @ingroup lv2
+
+   Connecting many ports to buffers at once.
+
+   See <http://lv2plug.in/ns/ext/connect> for details.
+
+   @{
+*/
+
+#include <lv2/core/lv2.h>
+
+#include <stdint.h>
+
+// clang-format off
+
+#define LV2_CONNECT_URI    "http://lv2plug.in/ns/ext/connect"  ///< http://lv2plug.in/ns/ext/connect
+#define LV2_CONNECT_PREFIX LV2_CONNECT_URI "#"                 ///< http://lv2plug.in/ns/ext/connect#
+
+#define LV2_CONNECT__interface LV2_CONNECT_PREFIX "interface"  ///< http://lv2plug.in/ns/ext/connect#interface
+
+// clang-format on
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Plugin interface for connecting several ports at once.
+
+   The plugin's extension_data() method should return an LV2_Connect_Interface
+   when called with LV2_CONNECT__interface as its argument.
+*/
+typedef struct {
+  /**
+     Connect a range of ports to buffers.
+
+     This has the same effect as calling LV2_Descriptor::connect_port() for
+     every port from `first` to `first + n_ports - 1`, in order, so the same
+     rules apply.  Entries of `data_locations` may be NULL if the
+     corresponding port is lv2:connectionOptional.
+
+     This function is in the same threading class as connect_port().
+
+     @param instance The plugin instance.
+     @param first Index of the first port to connect.
+     @param n_ports Number of ports to connect.
+     @param data_locations Array of `n_ports` buffers, which is only valid
+     during this call.
+  */
+  void (*connect_ports)(LV2_Handle   instance,
+                        uint32_t     first,
+                        uint32_t     n_ports,
+                        void* const* data_locations);
+} LV2_Connect_Interface;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_CONNECT_CONNECT_H
@@ -0,0 +1,91 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_CONNECT_UTIL_H
+#define LV2_CONNECT_UTIL_H
+
+/**
+   @file util.h Helpers for connecting many ports at once.
+
+   These let a host always connect ports in bulk, whether or not the plugin
+   provides LV2_Connect_Interface, by falling back to calling connect_port()
+   for each port.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup connect_util Utilities
+   @ingroup connect
+
+   Helpers for connecting many ports at once.
+
+   @{
+*/
+
+#include <lv2/connect/connect.h>
+#include <lv2/core/lv2.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Return the connect interface of a plugin, or NULL.
+
+   This calls extension_data(), so it should be called once, not per cycle.
+*/
+static inline const LV2_Connect_Interface*
+lv2_connect_interface(const LV2_Descriptor* const descriptor)
+{
+  return descriptor->extension_data
+           ? (const LV2_Connect_Interface*)descriptor->extension_data(
+               LV2_CONNECT__interface)
+           : NULL;
+}
+
+/**
+   Connect a range of ports to buffers.
+
+   This calls LV2_Connect_Interface::connect_ports() if the plugin provides
+   it, and otherwise LV2_Descriptor::connect_port() for every port.
+
+   @param descriptor Plugin descriptor.
+   @param iface Connect interface of the plugin, or NULL.
+   @param instance Plugin instance.
+   @param first Index of the first port to connect.
+   @param n_ports Number of ports to connect.
+   @param data_locations Array of `n_ports` buffers.
+*/
+static inline void
+lv2_connect_ports(const LV2_Descriptor* const        descriptor,
+                  const LV2_Connect_Interface* const iface,
+                  const LV2_Handle                   instance,
+                  const uint32_t                     first,
+                  const uint32_t                     n_ports,
+                  void* const* const                 data_locations)
+{
+  if (iface && iface->connect_ports) {
+    iface->connect_ports(instance, first, n_ports, data_locations);
+    return;
+  }
+
+  for (uint32_t i = 0U; i < n_ports; ++i) {
+    descriptor->connect_port(instance, first + i, data_locations[i]);
+  }
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_CONNECT_UTIL_H
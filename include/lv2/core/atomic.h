@@ -0,0 +1,182 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_CORE_ATOMIC_H
+#define LV2_CORE_ATOMIC_H
+
+/**
+   @file atomic.h Minimal atomic operations for lock-free helpers.
+
+   These are the few operations needed by the non-normative lock-free helpers
+   in other headers, implemented with compiler intrinsics so that they work in
+   both C99 and C++.  Loads have acquire semantics, stores have release
+   semantics, and read-modify-write operations are sequentially consistent.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup atomic Atomics
+   @ingroup lv2
+
+   Minimal atomic operations for lock-free helpers.
+
+   @{
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#elif !defined(__GNUC__)
+#  error "lv2/core/atomic.h requires GCC, Clang, or MSVC intrinsics"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Load a 32-bit value with acquire semantics. */
+static inline uint32_t
+lv2_atomic_load(const volatile uint32_t* const ptr)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return (uint32_t)_InterlockedOr((volatile long*)ptr, 0);
+#else
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/** Store a 32-bit value with release semantics. */
+static inline void
+lv2_atomic_store(volatile uint32_t* const ptr, const uint32_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  _InterlockedExchange((volatile long*)ptr, (long)value);
+#else
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/** Add to a 32-bit value and return the previous value. */
+static inline uint32_t
+lv2_atomic_add(volatile uint32_t* const ptr, const uint32_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return (uint32_t)_InterlockedExchangeAdd((volatile long*)ptr, (long)value);
+#else
+  return __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/** Subtract from a 32-bit value and return the previous value. */
+static inline uint32_t
+lv2_atomic_sub(volatile uint32_t* const ptr, const uint32_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return (uint32_t)_InterlockedExchangeAdd((volatile long*)ptr, -(long)value);
+#else
+  return __atomic_fetch_sub(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/** Replace a 32-bit value and return the previous value. */
+static inline uint32_t
+lv2_atomic_exchange(volatile uint32_t* const ptr, const uint32_t value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return (uint32_t)_InterlockedExchange((volatile long*)ptr, (long)value);
+#else
+  return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+   Set a 32-bit value to `desired` if it is currently `expected`.
+
+   @return True if the value was changed.
+*/
+static inline bool
+lv2_atomic_cas(volatile uint32_t* const ptr,
+               uint32_t                 expected,
+               const uint32_t           desired)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _InterlockedCompareExchange(
+           (volatile long*)ptr, (long)desired, (long)expected) ==
+         (long)expected;
+#else
+  return __atomic_compare_exchange_n(
+    ptr, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/** Load a pointer with acquire semantics. */
+static inline void*
+lv2_atomic_load_ptr(void* const volatile* const ptr)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _InterlockedCompareExchangePointer((void* volatile*)ptr, NULL, NULL);
+#else
+  return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/** Store a pointer with release semantics. */
+static inline void
+lv2_atomic_store_ptr(void* volatile* const ptr, void* const value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  _InterlockedExchangePointer(ptr, value);
+#else
+  __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/** Replace a pointer and return the previous value. */
+static inline void*
+lv2_atomic_exchange_ptr(void* volatile* const ptr, void* const value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _InterlockedExchangePointer(ptr, value);
+#else
+  return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+   Hint to the processor that the calling thread is spinning.
+
+   This should be called in every iteration of a busy-wait loop, which saves
+   power and lets a sibling hyperthread run, including one that the spinning
+   thread is waiting for.  It does nothing on unknown architectures.
+*/
+static inline void
+lv2_atomic_pause(void)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+#  if defined(_M_IX86) || defined(_M_X64)
+  _mm_pause();
+#  elif defined(_M_ARM) || defined(_M_ARM64)
+  __yield();
+#  endif
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_CORE_ATOMIC_H
@@ -0,0 +1,452 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_CORE_BUFFERS_H
+#define LV2_CORE_BUFFERS_H
+
+/**
+   @file buffers.h Planning port buffers for a sequence of plugins.
+
+   A host that runs several plugins connected together needs a buffer for
+   every connection.  Giving every port its own buffer is simple, but wastes
+   memory and cache, since most buffers are only used for a short part of
+   each cycle.  This plans a minimal set of buffers for a sequence of plugin
+   instances, which are run in order, by reusing buffers as soon as the data
+   in them is no longer needed.
+
+   The host describes every port with an LV2_Buffers_Port, and every instance
+   with an LV2_Buffers_Node, in the order they are run.  Ports are listed in
+   the same order, so the ports of each node follow those of the previous one.
+   Every input may be connected to an output of an earlier node.  Planning
+   then assigns a buffer to every port:
+
+     - An output is given a buffer of an input of the same node, so that the
+       plugin processes in place, if the plugin is not lv2:inPlaceBroken,
+       nothing else reads that input afterwards, and neither port is
+       LV2_BUFFERS_UNSHARED.
+
+     - Otherwise, an output is given a buffer that is no longer used, or a new
+       one if there are none.
+
+     - An input that is not connected is given a silent buffer that is never
+       written, or no buffer at all if it is lv2:connectionOptional.  Inputs
+       of the same size share a silent buffer, unless they are
+       LV2_BUFFERS_UNSHARED, which get one of their own.
+
+     - An output that is not connected is given a scratch buffer which is
+       reused by later nodes, or no buffer at all if it is
+       lv2:connectionOptional.
+
+   Every buffer is placed in a single block of memory, and aligned to a cache
+   line, so the host only needs to allocate and clear one block:
+
+       LV2_Buffers_Plan plan = {buffers, 0U, 0U};
+       if (lv2_buffers_plan(nodes, n_nodes, ports, n_ports, &plan, max)) {
+         void* block = aligned_alloc(LV2_BUFFERS_ALIGN, plan.size);
+         memset(block, 0, plan.size);
+
+         for (uint32_t p = 0U; p < n_ports; ++p) {
+           connect_port(..., lv2_buffers_data(&plan, &ports[p], block));
+         }
+       }
+
+   Ports connected to buffers outside the plan, like those of the host's
+   audio interface, should have the LV2_BUFFERS_EXTERNAL flag.  They are not
+   given a buffer, and can not be connected to other ports.
+
+   Control and atom ports should have the LV2_BUFFERS_UNSHARED flag.  The host
+   writes the value of an unconnected control input, which must not change
+   other inputs, and the capacity of an atom output before running its node,
+   which must not overwrite an input.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup lv2_buffers Buffers
+   @ingroup lv2core
+
+   Planning port buffers for a sequence of plugins.
+
+   @{
+*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The alignment of every buffer in bytes, the size of a cache line.
+*/
+#define LV2_BUFFERS_ALIGN 64U
+
+/**
+   An index that refers to no port or buffer.
+*/
+#define LV2_BUFFERS_NONE UINT32_MAX
+
+/**
+   Flags that describe a port.
+*/
+typedef enum {
+  LV2_BUFFERS_OUTPUT   = 1U << 0U, ///< Output port, otherwise an input
+  LV2_BUFFERS_OPTIONAL = 1U << 1U, ///< Port is lv2:connectionOptional
+  LV2_BUFFERS_EXTERNAL = 1U << 2U, ///< Port is connected by the host
+  LV2_BUFFERS_UNSHARED = 1U << 3U, ///< Port is a control or atom port
+} LV2_Buffers_Port_Flags;
+
+/**
+   A port of a plugin instance.
+
+   The host sets the first three fields, and planning sets the rest.
+*/
+typedef struct {
+  uint32_t flags;   ///< LV2_Buffers_Port_Flags
+  uint32_t size;    ///< Buffer size in bytes
+  uint32_t source;  ///< Index of the output connected to an input, or NONE
+  uint32_t buffer;  ///< Index of the assigned buffer, or NONE for NULL
+  uint32_t n_reads; ///< Number of inputs connected to an output
+} LV2_Buffers_Port;
+
+/**
+   A plugin instance.
+*/
+typedef struct {
+  uint32_t n_ports;         ///< Number of ports
+  bool     in_place_broken; ///< True if the plugin is lv2:inPlaceBroken
+} LV2_Buffers_Node;
+
+/**
+   A buffer in a plan.
+*/
+typedef struct {
+  uint64_t offset;  ///< Offset from the start of the block in bytes
+  uint32_t size;    ///< Size in bytes, a multiple of LV2_BUFFERS_ALIGN
+  uint32_t n_users; ///< Number of reads left while planning
+  uint32_t last;    ///< Index of the last node that used the buffer
+  uint32_t writer;   ///< Index of the last node that wrote the buffer
+  bool     silent;   ///< True if the buffer is only read, and stays silent
+  bool     unshared; ///< True if the buffer is only used by a single input
+} LV2_Buffers_Buffer;
+
+/**
+   A set of buffers in a single block of memory.
+*/
+typedef struct {
+  LV2_Buffers_Buffer* buffers;   ///< Array of buffers
+  uint32_t            n_buffers; ///< Number of buffers
+  uint64_t            size;      ///< Size of the block in bytes
+} LV2_Buffers_Plan;
+
+/**
+   Return `size` rounded up to a multiple of LV2_BUFFERS_ALIGN.
+*/
+static inline uint32_t
+lv2_buffers_pad(const uint32_t size)
+{
+  return (size + LV2_BUFFERS_ALIGN - 1U) & ~(LV2_BUFFERS_ALIGN - 1U);
+}
+
+/**
+   Add a new buffer to a plan.
+
+   @return The index of the new buffer, or LV2_BUFFERS_NONE if it is full.
+*/
+static inline uint32_t
+lv2_buffers_add(LV2_Buffers_Plan* const plan,
+                const uint32_t          max_buffers,
+                const uint32_t          size,
+                const uint32_t          node)
+{
+  if (plan->n_buffers >= max_buffers) {
+    return LV2_BUFFERS_NONE;
+  }
+
+  LV2_Buffers_Buffer* const buffer = &plan->buffers[plan->n_buffers];
+
+  buffer->offset   = 0U;
+  buffer->size     = size;
+  buffer->n_users  = 0U;
+  buffer->last     = node;
+  buffer->writer   = LV2_BUFFERS_NONE;
+  buffer->silent   = false;
+  buffer->unshared = false;
+  return plan->n_buffers++;
+}
+
+/**
+   Return the silent buffer for an unconnected input.
+
+   Every unconnected input of the same size shares a single silent buffer,
+   except unshared inputs, which are each given a new one.
+*/
+static inline uint32_t
+lv2_buffers_silence(LV2_Buffers_Plan* const plan,
+                    const uint32_t          max_buffers,
+                    const uint32_t          size,
+                    const bool              unshared,
+                    const uint32_t          node)
+{
+  for (uint32_t b = 0U; !unshared && b < plan->n_buffers; ++b) {
+    if (plan->buffers[b].silent && !plan->buffers[b].unshared &&
+        plan->buffers[b].size == size) {
+      return b;
+    }
+  }
+
+  const uint32_t b = lv2_buffers_add(plan, max_buffers, size, node);
+  if (b != LV2_BUFFERS_NONE) {
+    plan->buffers[b].silent   = true;
+    plan->buffers[b].unshared = unshared;
+  }
+
+  return b;
+}
+
+/**
+   Find the buffer of an input that an output can process in place.
+
+   This is the buffer of an input of the node with the same size, which is
+   read by no other port, and has not already been given to another output.
+   Unshared ports never process in place, so the caller must not call this
+   for an unshared output.
+
+   @return The index of the buffer, or LV2_BUFFERS_NONE.
+*/
+static inline uint32_t
+lv2_buffers_in_place(const LV2_Buffers_Plan* const plan,
+                     const LV2_Buffers_Port* const ports,
+                     const uint32_t                first,
+                     const uint32_t                n_ports,
+                     const uint32_t                size,
+                     const uint32_t                node)
+{
+  for (uint32_t p = first; p < first + n_ports; ++p) {
+    const uint32_t b = ports[p].buffer;
+    if ((ports[p].flags & (LV2_BUFFERS_OUTPUT | LV2_BUFFERS_UNSHARED)) ||
+        ports[p].size != size || b == LV2_BUFFERS_NONE ||
+        plan->buffers[b].silent || plan->buffers[b].n_users ||
+        plan->buffers[b].writer == node) {
+      continue;
+    }
+
+    // Only use a buffer if it is connected to a single input of the node
+    uint32_t n_inputs = 0U;
+    for (uint32_t q = first; q < first + n_ports; ++q) {
+      if (!(ports[q].flags & LV2_BUFFERS_OUTPUT) && ports[q].buffer == b) {
+        ++n_inputs;
+      }
+    }
+
+    if (n_inputs == 1U) {
+      return b;
+    }
+  }
+
+  return LV2_BUFFERS_NONE;
+}
+
+/**
+   Find the best unused buffer for an output.
+
+   This is the smallest free buffer that is large enough, or if there are
+   none, the largest free buffer which can be grown.
+
+   @return The index of the buffer, or LV2_BUFFERS_NONE.
+*/
+static inline uint32_t
+lv2_buffers_unused(const LV2_Buffers_Plan* const plan,
+                   const uint32_t                size,
+                   const uint32_t                node)
+{
+  uint32_t best = LV2_BUFFERS_NONE;
+  for (uint32_t b = 0U; b < plan->n_buffers; ++b) {
+    const LV2_Buffers_Buffer* const buffer = &plan->buffers[b];
+    if (buffer->silent || buffer->n_users || buffer->last >= node) {
+      continue;
+    }
+
+    if (best == LV2_BUFFERS_NONE) {
+      best = b;
+    } else {
+      const uint32_t best_size = plan->buffers[best].size;
+      if (best_size < size ? buffer->size > best_size
+                           : buffer->size >= size && buffer->size < best_size) {
+        best = b;
+      }
+    }
+  }
+
+  return best;
+}
+
+/**
+   Plan the buffers for a sequence of nodes.
+
+   @param nodes Nodes in the order they are run.
+   @param n_nodes Number of nodes.
+   @param ports Ports of every node in order, which are updated with their
+   assigned buffers.
+   @param n_ports Number of ports, which must be the total of all nodes.
+   @param plan Plan to write, with `buffers` set to an array.
+   @param max_buffers Capacity of the buffer array.  Planning never needs more
+   buffers than there are ports.
+   @return True on success, or false if the description is invalid or there
+   are too many buffers.
+*/
+static inline bool
+lv2_buffers_plan(const LV2_Buffers_Node* const nodes,
+                 const uint32_t                n_nodes,
+                 LV2_Buffers_Port* const       ports,
+                 const uint32_t                n_ports,
+                 LV2_Buffers_Plan* const       plan,
+                 const uint32_t                max_buffers)
+{
+  plan->n_buffers = 0U;
+  plan->size      = 0U;
+
+  // Count the reads of every output, and check connections go forwards
+  uint32_t first = 0U;
+  for (uint32_t p = 0U; p < n_ports; ++p) {
+    ports[p].buffer  = LV2_BUFFERS_NONE;
+    ports[p].n_reads = 0U;
+  }
+
+  for (uint32_t n = 0U; n < n_nodes; ++n) {
+    if (nodes[n].n_ports > n_ports - first) {
+      return false;
+    }
+
+    for (uint32_t p = first; p < first + nodes[n].n_ports; ++p) {
+      const uint32_t source = ports[p].source;
+      if (ports[p].size > UINT32_MAX - LV2_BUFFERS_ALIGN) {
+        return false;
+      }
+
+      if (!(ports[p].flags & (LV2_BUFFERS_OUTPUT | LV2_BUFFERS_EXTERNAL)) &&
+          source != LV2_BUFFERS_NONE) {
+        if (source >= first || !(ports[source].flags & LV2_BUFFERS_OUTPUT) ||
+            (ports[source].flags & LV2_BUFFERS_EXTERNAL)) {
+          return false;
+        }
+
+        ++ports[source].n_reads;
+      }
+    }
+
+    first += nodes[n].n_ports;
+  }
+
+  if (first != n_ports) {
+    return false;
+  }
+
+  // Assign buffers to every node in order
+  first = 0U;
+  for (uint32_t n = 0U; n < n_nodes; ++n) {
+    const uint32_t last = first + nodes[n].n_ports;
+
+    // Connect inputs to the buffers of their sources, or silence
+    for (uint32_t p = first; p < last; ++p) {
+      LV2_Buffers_Port* const port = &ports[p];
+      if (port->flags & (LV2_BUFFERS_OUTPUT | LV2_BUFFERS_EXTERNAL)) {
+        continue;
+      }
+
+      if (port->source != LV2_BUFFERS_NONE) {
+        port->buffer = ports[port->source].buffer;
+        plan->buffers[port->buffer].last = n;
+        --plan->buffers[port->buffer].n_users;
+      } else if (!(port->flags & LV2_BUFFERS_OPTIONAL)) {
+        const uint32_t size     = lv2_buffers_pad(port->size);
+        const bool     unshared = port->flags & LV2_BUFFERS_UNSHARED;
+        if ((port->buffer = lv2_buffers_silence(
+               plan, max_buffers, size, unshared, n)) == LV2_BUFFERS_NONE) {
+          return false;
+        }
+      }
+    }
+
+    // Give outputs a buffer of an input, an unused buffer, or a new one
+    for (uint32_t p = first; p < last; ++p) {
+      LV2_Buffers_Port* const port = &ports[p];
+      if (!(port->flags & LV2_BUFFERS_OUTPUT) ||
+          (port->flags & LV2_BUFFERS_EXTERNAL) ||
+          (!port->n_reads && (port->flags & LV2_BUFFERS_OPTIONAL))) {
+        continue;
+      }
+
+      const uint32_t size = lv2_buffers_pad(port->size);
+      uint32_t       b    = LV2_BUFFERS_NONE;
+      if (!nodes[n].in_place_broken &&
+          !(port->flags & LV2_BUFFERS_UNSHARED)) {
+        b = lv2_buffers_in_place(
+          plan, ports, first, nodes[n].n_ports, port->size, n);
+      }
+
+      if (b == LV2_BUFFERS_NONE) {
+        b = lv2_buffers_unused(plan, size, n);
+      }
+
+      if (b == LV2_BUFFERS_NONE &&
+          (b = lv2_buffers_add(plan, max_buffers, size, n)) ==
+            LV2_BUFFERS_NONE) {
+        return false;
+      }
+
+      LV2_Buffers_Buffer* const buffer = &plan->buffers[b];
+      if (buffer->size < size) {
+        buffer->size = size;
+      }
+
+      buffer->n_users = port->n_reads;
+      buffer->last    = n;
+      buffer->writer  = n;
+      port->buffer    = b;
+    }
+
+    first = last;
+  }
+
+  // Place every buffer in the block
+  for (uint32_t b = 0U; b < plan->n_buffers; ++b) {
+    plan->buffers[b].offset = plan->size;
+    plan->size += plan->buffers[b].size;
+  }
+
+  return true;
+}
+
+/**
+   Return the data location to connect a port to, or NULL.
+
+   @param plan The plan made for the port.
+   @param port The port.
+   @param block The block of memory for the plan, aligned to
+   LV2_BUFFERS_ALIGN.
+*/
+static inline void*
+lv2_buffers_data(const LV2_Buffers_Plan* const plan,
+                 const LV2_Buffers_Port* const port,
+                 void* const                   block)
+{
+  return port->buffer == LV2_BUFFERS_NONE
+           ? NULL
+           : (void*)((uint8_t*)block + plan->buffers[port->buffer].offset);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_CORE_BUFFERS_H
@@ -0,0 +1,193 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_CORE_EXTENSIONS_H
+#define LV2_CORE_EXTENSIONS_H
+
+/**
+   @file extensions.h Cached dispatch of LV2_Descriptor::extension_data().
+
+   Plugins typically implement extension_data() by comparing the URI to each
+   interface they support, and hosts call it whenever they need an interface,
+   often several times for every instance.  Since the returned data depends
+   only on the descriptor, this is wasted work.
+
+   The host side of this header resolves a set of interfaces once per
+   descriptor into an LV2_Extension_Table, a dense array indexed like an array
+   of interface URIs chosen by the host.  For example, a host can get the
+   state interface of any instance with:
+
+       enum { STATE, WORKER, N_INTERFACES };
+
+       static const char* const uris[N_INTERFACES] = {
+         LV2_STATE__interface,
+         LV2_WORKER__interface,
+       };
+
+       const void*         data[N_INTERFACES];
+       LV2_Extension_Table table;
+       lv2_extension_table_init(&table, descriptor, uris, N_INTERFACES, data);
+
+       const LV2_State_Interface* state =
+         (const LV2_State_Interface*)lv2_extension_table_get(&table, STATE);
+
+   Since tables are keyed on URIs, this header does not depend on any
+   extension, and works with any interface, including new ones.
+
+   The plugin side is a macro that defines extension_data() from an array of
+   LV2_Extension_Data entries:
+
+       static const LV2_Extension_Data extensions[] = {
+         {LV2_STATE__interface, &state_interface},
+         {LV2_WORKER__interface, &worker_interface},
+       };
+
+       LV2_EXTENSION_DATA_FUNCTION(extension_data, extensions)
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup lv2_extensions Extensions
+   @ingroup lv2core
+
+   Cached dispatch of LV2_Descriptor::extension_data().
+
+   @{
+*/
+
+#include <lv2/core/lv2.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The extension data of a descriptor for a set of interfaces.
+*/
+typedef struct {
+  const LV2_Descriptor* descriptor; ///< Plugin descriptor
+  const char* const*    uris;       ///< Array of interface URIs
+  const void**          data;       ///< Extension data for each URI
+  uint32_t              n_uris;     ///< Number of URIs
+} LV2_Extension_Table;
+
+/**
+   An extension interface provided by a plugin.
+*/
+typedef struct {
+  const char* uri;  ///< Interface URI
+  const void* data; ///< Interface data returned by extension_data()
+} LV2_Extension_Data;
+
+/**
+   Resolve a set of interfaces of a descriptor.
+
+   This calls extension_data() once for every interface, and should be done
+   once per descriptor, not per instance.
+
+   @param table Table to initialise.
+   @param descriptor Plugin descriptor.
+   @param uris Array of `n_uris` interface URIs, which must outlive the table.
+   @param n_uris Number of interfaces.
+   @param data Array of `n_uris` pointers to store the extension data in.
+*/
+static inline void
+lv2_extension_table_init(LV2_Extension_Table* const  table,
+                         const LV2_Descriptor* const descriptor,
+                         const char* const* const    uris,
+                         const uint32_t              n_uris,
+                         const void** const          data)
+{
+  table->descriptor = descriptor;
+  table->uris       = uris;
+  table->data       = data;
+  table->n_uris     = n_uris;
+  for (uint32_t i = 0U; i < n_uris; ++i) {
+    data[i] =
+      descriptor->extension_data ? descriptor->extension_data(uris[i]) : NULL;
+  }
+}
+
+/**
+   Return the extension data for the interface at an index, or NULL.
+
+   This is realtime safe.
+*/
+static inline const void*
+lv2_extension_table_get(const LV2_Extension_Table* const table,
+                        const uint32_t                   index)
+{
+  return (index < table->n_uris) ? table->data[index] : NULL;
+}
+
+/**
+   Return the extension data for any interface URI, or NULL.
+
+   Interfaces in the table are returned from it, and others are queried from
+   the descriptor.
+*/
+static inline const void*
+lv2_extension_table_find(const LV2_Extension_Table* const table,
+                         const char* const                uri)
+{
+  for (uint32_t i = 0U; i < table->n_uris; ++i) {
+    if (!strcmp(uri, table->uris[i])) {
+      return table->data[i];
+    }
+  }
+
+  return table->descriptor->extension_data
+           ? table->descriptor->extension_data(uri)
+           : NULL;
+}
+
+/**
+   Return the data for a URI in an array of extension interfaces, or NULL.
+
+   This is the implementation of extension_data() defined by
+   LV2_EXTENSION_DATA_FUNCTION().
+*/
+static inline const void*
+lv2_extension_data_find(const LV2_Extension_Data* const extensions,
+                        const size_t                    n_extensions,
+                        const char* const               uri)
+{
+  for (size_t i = 0U; i < n_extensions; ++i) {
+    if (!strcmp(uri, extensions[i].uri)) {
+      return extensions[i].data;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   Define a static extension_data() function for a plugin.
+
+   @param name Name of the function to define.
+   @param extensions Array of LV2_Extension_Data with a size known at compile
+   time.
+*/
+#define LV2_EXTENSION_DATA_FUNCTION(name, extensions)                   \
+  static const void* name(const char* const uri)                        \
+  {                                                                     \
+    return lv2_extension_data_find(                                     \
+      (extensions), sizeof(extensions) / sizeof((extensions)[0]), uri); \
+  }
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_CORE_EXTENSIONS_H
@@ -1,4 +1,4 @@
-// Copyright 2016 David Robillard <d@drobilla.net>
+// Copyright 2016-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #ifndef LV2_CORE_LV2_UTIL_H
@@ -14,6 +14,7 @@
 
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
 #ifdef __cplusplus
@@ -40,6 +41,164 @@ lv2_features_data(const LV2_Feature* const* features, const char* const uri)
   return NULL;
 }
 
+/**
+   The number of slots in an LV2_Features_Index.
+
+   This is a power of two, and an index is used for arrays of up to three
+   quarters as many features.
+*/
+#define LV2_FEATURES_INDEX_SIZE 64U
+
+/**
+   A hash index of a features array.
+
+   This is small enough to be allocated on the stack, and makes looking up
+   several features cheaper than scanning the array with strcmp() for each.
+*/
+typedef struct {
+  const LV2_Feature* const* features;                        ///< Indexed array
+  const LV2_Feature*        slots[LV2_FEATURES_INDEX_SIZE];  ///< Slot features
+  uint32_t                  hashes[LV2_FEATURES_INDEX_SIZE]; ///< Slot hashes
+  bool                      complete;                        ///< All indexed
+} LV2_Features_Index;
+
+/**
+   A feature to look up with lv2_features_resolve().
+*/
+typedef struct {
+  const char* uri;      ///< Feature URI, or NULL to terminate an array
+  void**      data;     ///< Set to the feature data, or NULL if not found
+  bool        required; ///< True if the feature is required
+} LV2_Feature_Query;
+
+/** Return the 32-bit FNV-1a hash of a feature URI. */
+static inline uint32_t
+lv2_features_hash(const char* const uri)
+{
+  uint32_t hash = 2166136261U;
+  for (const char* c = uri; *c; ++c) {
+    hash = (hash ^ (uint8_t)*c) * 16777619U;
+  }
+
+  return hash;
+}
+
+/**
+   Build an index of a features array in a single pass.
+
+   The features array must remain valid while the index is used.  If it has
+   more features than fit in the index, lookups fall back to scanning it.
+*/
+static inline void
+lv2_features_index_init(LV2_Features_Index* const       index,
+                        const LV2_Feature* const* const features)
+{
+  const uint32_t mask = LV2_FEATURES_INDEX_SIZE - 1U;
+  uint32_t       n    = 0U;
+
+  memset(index->slots, 0, sizeof(index->slots));
+  index->features = features;
+  index->complete = true;
+  for (const LV2_Feature* const* f = features; f && *f; ++f) {
+    if (++n > LV2_FEATURES_INDEX_SIZE * 3U / 4U) {
+      index->complete = false;
+      return;
+    }
+
+    // Duplicates go later in the probe sequence, so the first is found
+    const uint32_t hash = lv2_features_hash((*f)->URI);
+    uint32_t       i    = hash & mask;
+    while (index->slots[i]) {
+      i = (i + 1U) & mask;
+    }
+
+    index->slots[i]  = *f;
+    index->hashes[i] = hash;
+  }
+}
+
+/**
+   Return the data for a feature in an index, or NULL.
+
+   This is equivalent to lv2_features_data() on the indexed array.
+*/
+static inline void*
+lv2_features_index_data(const LV2_Features_Index* const index,
+                        const char* const               uri)
+{
+  if (!index->complete) {
+    return lv2_features_data(index->features, uri);
+  }
+
+  const uint32_t mask = LV2_FEATURES_INDEX_SIZE - 1U;
+  const uint32_t hash = lv2_features_hash(uri);
+  for (uint32_t i = hash & mask; index->slots[i]; i = (i + 1U) & mask) {
+    if (index->hashes[i] == hash && !strcmp(uri, index->slots[i]->URI)) {
+      return index->slots[i]->data;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   Look up several features at once, and report every missing one.
+
+   The features array is indexed once, then each query is resolved with a
+   hash lookup.  Unlike lv2_features_query(), this does not stop at the first
+   missing required feature, so a plugin can report all of them at once.
+   For example:
+
+   @code
+   LV2_URID_Log* log = NULL;
+   LV2_URID_Map* map = NULL;
+
+   const LV2_Feature_Query queries[] = {
+     {LV2_LOG__log, (void**)&log, false},
+     {LV2_URID__map, (void**)&map, true},
+     {NULL, NULL, false},
+   };
+
+   const char*    missing[2];
+   const uint32_t n_missing =
+     lv2_features_resolve(features, queries, missing, 2U);
+   for (uint32_t i = 0U; i < n_missing && i < 2U; ++i) {
+     fprintf(stderr, "Missing feature <%s>\n", missing[i]);
+   }
+   @endcode
+
+   @param features Features array, which may be NULL.
+   @param queries Array of queries terminated by one with a NULL URI.
+   @param missing Array set to the URIs of missing required features, or
+   NULL.
+   @param max_missing Capacity of `missing`.
+   @return The number of missing required features, which may be larger than
+   `max_missing`.
+*/
+static inline uint32_t
+lv2_features_resolve(const LV2_Feature* const* const features,
+                     const LV2_Feature_Query* const  queries,
+                     const char** const              missing,
+                     const uint32_t                  max_missing)
+{
+  LV2_Features_Index index;
+  lv2_features_index_init(&index, features);
+
+  uint32_t n_missing = 0U;
+  for (const LV2_Feature_Query* q = queries; q->uri; ++q) {
+    *q->data = lv2_features_index_data(&index, q->uri);
+    if (q->required && !*q->data) {
+      if (missing && n_missing < max_missing) {
+        missing[n_missing] = q->uri;
+      }
+
+      ++n_missing;
+    }
+  }
+
+  return n_missing;
+}
+
 /**
    Query a features array.
 
@@ -65,6 +224,9 @@ lv2_features_data(const LV2_Feature* const* features, const char* const uri)
 static inline const char*
 lv2_features_query(const LV2_Feature* const* features, ...)
 {
+  LV2_Features_Index index;
+  lv2_features_index_init(&index, features);
+
   va_list args; // NOLINT(cppcoreguidelines-init-variables)
   va_start(args, features);
 
@@ -73,7 +235,7 @@ lv2_features_query(const LV2_Feature* const* features, ...)
     void**     data     = va_arg(args, void**);
     const bool required = (bool)va_arg(args, int);
 
-    *data = lv2_features_data(features, uri);
+    *data = lv2_features_index_data(&index, uri);
     if (required && !*data) {
       va_end(args);
       return uri;
@@ -0,0 +1,490 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_CORE_SCHEDULE_H
+#define LV2_CORE_SCHEDULE_H
+
+/**
+   @file schedule.h A parallel scheduler for graphs of plugin instances.
+
+   This runs a graph of plugin instances, where every instance is run only
+   after all of the instances that it depends on, using several host threads.
+   The graph is analysed once when it is built, and the schedule is reused
+   for every cycle, so a cycle does no allocation or sorting.
+
+   Every thread is a worker with a deque of instances that are ready to run.
+   When a worker has run an instance, it decrements the number of pending
+   dependencies of every instance that depends on it, and runs one that has
+   become ready next, pushing any others onto its deque.  An idle worker takes
+   instances from its own deque first, then steals from others, so work is
+   balanced automatically while related instances tend to run on the same
+   thread.  At the start of every cycle, the instances with no dependencies
+   are dealt to the workers in the same way, so each tends to run on the same
+   thread in every cycle.
+
+   The host owns all threads and memory.  A typical host:
+
+     - Describes the graph with an array of LV2_Schedule_Node and an array of
+       LV2_Schedule_Edge, and calls lv2_schedule_init() whenever it changes.
+
+     - Creates one thread for every worker but the first, with the same
+       realtime priority as the audio thread, and ideally pinned to its own
+       core.
+
+     - Calls lv2_schedule_run() in the audio thread for every cycle, which
+       acts as the first worker.
+
+     - Calls lv2_schedule_help() in every other worker thread when it is
+       notified, with the index of that worker.
+
+   With a single worker, instances are simply run in order in the calling
+   thread, without any atomic operations.  Nothing here allocates memory or
+   blocks, but workers spin while they wait for dependencies to finish.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup lv2_schedule Schedule
+   @ingroup lv2core
+
+   A parallel scheduler for graphs of plugin instances.
+
+   @{
+*/
+
+#include <lv2/core/atomic.h>
+#include <lv2/core/lv2.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The maximum number of nodes in a graph.
+*/
+#define LV2_SCHEDULE_MAX_NODES 0xFFFFU
+
+/**
+   An index that refers to no node.
+*/
+#define LV2_SCHEDULE_NONE UINT32_MAX
+
+/**
+   Flag set in LV2_Schedule::state while workers may join a cycle.
+*/
+#define LV2_SCHEDULE_OPEN 0x80000000U
+
+/**
+   A plugin instance in a graph.
+
+   The host sets the first two fields, and lv2_schedule_init() sets the rest.
+*/
+typedef struct {
+  const LV2_Descriptor* descriptor;     ///< Plugin descriptor
+  LV2_Handle            instance;       ///< Plugin instance
+  uint32_t              first;          ///< Index of the first successor
+  uint32_t              n_successors;   ///< Number of successors
+  uint32_t              n_predecessors; ///< Number of predecessors
+  volatile uint32_t     pending;        ///< Predecessors not run this cycle
+} LV2_Schedule_Node;
+
+/**
+   A dependency between two nodes.
+*/
+typedef struct {
+  uint32_t from; ///< Index of the node that must run first
+  uint32_t to;   ///< Index of the node that depends on it
+} LV2_Schedule_Edge;
+
+/**
+   A worker with a deque of nodes that are ready to run.
+
+   The owner pushes and pops nodes at the bottom, and other workers steal
+   from the top.  Both ends are packed into a single value, so every change is
+   a single atomic operation.  A deque never wraps around within a cycle,
+   since every node is pushed at most once.
+*/
+typedef struct {
+  volatile uint32_t ends;     ///< Top index in the high bits, bottom in low
+  uint32_t*         slots;    ///< Node indices, with room for every node
+  uint32_t          n_run;    ///< Number of nodes run by this worker
+  uint32_t          n_stolen; ///< Number of nodes stolen by this worker
+} LV2_Schedule_Worker;
+
+/**
+   A function that wakes up workers at the start of a cycle.
+
+   This is called in the audio thread, so it must be realtime safe, for
+   example by posting a semaphore for every worker thread.
+*/
+typedef void (*LV2_Schedule_Notify_Function)(void* handle);
+
+/**
+   A schedule for running a graph.
+*/
+typedef struct {
+  LV2_Schedule_Node*           nodes;        ///< Nodes in the graph
+  uint32_t                     n_nodes;      ///< Number of nodes
+  uint32_t*                    successors;   ///< Successors of every node
+  uint32_t*                    order;        ///< Nodes in a sequential order
+  uint32_t                     n_sources;    ///< Nodes with no predecessors
+  LV2_Schedule_Worker*         workers;      ///< Workers
+  uint32_t                     n_workers;    ///< Number of workers
+  LV2_Schedule_Notify_Function notify;       ///< Wake function, or NULL
+  void*                        handle;       ///< Handle for `notify`
+  uint32_t                     sample_count; ///< Sample count of this cycle
+  volatile uint32_t            state;        ///< Open flag, and joined workers
+  volatile uint32_t            n_done;       ///< Number of nodes run
+} LV2_Schedule;
+
+/**
+   Return the number of `uint32_t` elements of memory needed for a schedule.
+*/
+static inline size_t
+lv2_schedule_memory_size(const uint32_t n_nodes,
+                         const uint32_t n_edges,
+                         const uint32_t n_workers)
+{
+  return (size_t)n_edges + n_nodes + ((size_t)n_workers * n_nodes);
+}
+
+/**
+   Push a ready node onto the bottom of the deque of a worker.
+
+   This must only be called by the owner of the deque.
+*/
+static inline void
+lv2_schedule_push(LV2_Schedule_Worker* const worker, const uint32_t node)
+{
+  uint32_t ends = lv2_atomic_load(&worker->ends);
+
+  worker->slots[ends & 0xFFFFU] = node;
+  while (!lv2_atomic_cas(&worker->ends, ends, ends + 1U)) {
+    ends = lv2_atomic_load(&worker->ends);
+  }
+}
+
+/**
+   Pop a node from the bottom of the deque of a worker.
+
+   This must only be called by the owner of the deque.
+
+   @return The index of a node, or LV2_SCHEDULE_NONE if the deque is empty.
+*/
+static inline uint32_t
+lv2_schedule_pop(LV2_Schedule_Worker* const worker)
+{
+  for (;;) {
+    const uint32_t ends   = lv2_atomic_load(&worker->ends);
+    const uint32_t bottom = ends & 0xFFFFU;
+    if (bottom <= (ends >> 16U)) {
+      return LV2_SCHEDULE_NONE;
+    }
+
+    if (lv2_atomic_cas(&worker->ends, ends, ends - 1U)) {
+      return worker->slots[bottom - 1U];
+    }
+  }
+}
+
+/**
+   Steal a node from the top of the deque of another worker.
+
+   The slot is only read after the top is taken, since the owner can never
+   write to it again in this cycle.
+
+   @return The index of a node, or LV2_SCHEDULE_NONE if the deque is empty.
+*/
+static inline uint32_t
+lv2_schedule_steal(LV2_Schedule_Worker* const victim)
+{
+  for (;;) {
+    const uint32_t ends = lv2_atomic_load(&victim->ends);
+    const uint32_t top  = ends >> 16U;
+    if ((ends & 0xFFFFU) <= top) {
+      return LV2_SCHEDULE_NONE;
+    }
+
+    if (lv2_atomic_cas(&victim->ends, ends, ends + 0x10000U)) {
+      return victim->slots[top];
+    }
+  }
+}
+
+/**
+   Run nodes as a worker until every node in the cycle has run.
+*/
+static inline void
+lv2_schedule_work(LV2_Schedule* const schedule, const uint32_t index)
+{
+  LV2_Schedule_Worker* const worker    = &schedule->workers[index];
+  const uint32_t             n_workers = schedule->n_workers;
+
+  while (lv2_atomic_load(&schedule->n_done) < schedule->n_nodes) {
+    // Take a node from our own deque, or steal one from another worker
+    uint32_t node = lv2_schedule_pop(worker);
+    for (uint32_t i = 1U; node == LV2_SCHEDULE_NONE && i < n_workers; ++i) {
+      const uint32_t victim = (index + i) % n_workers;
+
+      node = lv2_schedule_steal(&schedule->workers[victim]);
+      if (node != LV2_SCHEDULE_NONE) {
+        ++worker->n_stolen;
+      }
+    }
+
+    if (node == LV2_SCHEDULE_NONE) {
+      lv2_atomic_pause(); // Wait for running nodes to make others ready
+      continue;
+    }
+
+    // Run the node, then continue with a successor that it made ready
+    while (node != LV2_SCHEDULE_NONE) {
+      const LV2_Schedule_Node* const current = &schedule->nodes[node];
+      const uint32_t                 first   = current->first;
+      uint32_t                       next    = LV2_SCHEDULE_NONE;
+
+      current->descriptor->run(current->instance, schedule->sample_count);
+      ++worker->n_run;
+
+      for (uint32_t s = first; s < first + current->n_successors; ++s) {
+        const uint32_t succ = schedule->successors[s];
+        if (lv2_atomic_sub(&schedule->nodes[succ].pending, 1U) == 1U) {
+          if (next == LV2_SCHEDULE_NONE) {
+            next = succ;
+          } else {
+            lv2_schedule_push(worker, succ);
+          }
+        }
+      }
+
+      lv2_atomic_add(&schedule->n_done, 1U);
+      node = next;
+    }
+  }
+}
+
+/**
+   Build a schedule for a graph.
+
+   This sorts the graph, and must be called again whenever the nodes or edges
+   change.  It must not be called while a cycle is running.
+
+   @param schedule Schedule to initialise.
+   @param nodes Nodes, with the descriptor and instance of each set.
+   @param n_nodes Number of nodes, at most LV2_SCHEDULE_MAX_NODES.
+   @param edges Dependencies between nodes.
+   @param n_edges Number of edges.
+   @param workers Array of `n_workers` workers.
+   @param n_workers Number of workers, including the thread that calls
+   lv2_schedule_run().
+   @param memory Memory of at least lv2_schedule_memory_size() elements.
+   @param notify Function to wake up workers when a cycle starts, or NULL.
+   @param handle Handle passed to `notify`.
+   @return True on success, or false if the graph has a cycle or an invalid
+   edge.
+*/
+static inline bool
+lv2_schedule_init(LV2_Schedule* const                schedule,
+                  LV2_Schedule_Node* const           nodes,
+                  const uint32_t                     n_nodes,
+                  const LV2_Schedule_Edge* const     edges,
+                  const uint32_t                     n_edges,
+                  LV2_Schedule_Worker* const         workers,
+                  const uint32_t                     n_workers,
+                  uint32_t* const                    memory,
+                  const LV2_Schedule_Notify_Function notify,
+                  void* const                        handle)
+{
+  if (n_nodes > LV2_SCHEDULE_MAX_NODES || !n_workers) {
+    return false;
+  }
+
+  schedule->nodes        = nodes;
+  schedule->n_nodes      = n_nodes;
+  schedule->successors   = memory;
+  schedule->order        = memory + n_edges;
+  schedule->n_sources    = 0U;
+  schedule->workers      = workers;
+  schedule->n_workers    = n_workers;
+  schedule->notify       = notify;
+  schedule->handle       = handle;
+  schedule->sample_count = 0U;
+  schedule->state        = 0U;
+  schedule->n_done       = 0U;
+
+  for (uint32_t w = 0U; w < n_workers; ++w) {
+    workers[w].ends     = 0U;
+    workers[w].slots    = schedule->order + n_nodes + ((size_t)w * n_nodes);
+    workers[w].n_run    = 0U;
+    workers[w].n_stolen = 0U;
+  }
+
+  // Count the edges of every node, and lay out the successors of each
+  for (uint32_t n = 0U; n < n_nodes; ++n) {
+    nodes[n].first          = 0U;
+    nodes[n].n_successors   = 0U;
+    nodes[n].n_predecessors = 0U;
+  }
+
+  for (uint32_t e = 0U; e < n_edges; ++e) {
+    if (edges[e].from >= n_nodes || edges[e].to >= n_nodes ||
+        edges[e].from == edges[e].to) {
+      return false;
+    }
+
+    ++nodes[edges[e].from].n_successors;
+    ++nodes[edges[e].to].n_predecessors;
+  }
+
+  uint32_t first = 0U;
+  for (uint32_t n = 0U; n < n_nodes; ++n) {
+    nodes[n].first   = first;
+    nodes[n].pending = 0U;
+    first += nodes[n].n_successors;
+  }
+
+  // Fill in the successors, temporarily using pending as a count
+  for (uint32_t e = 0U; e < n_edges; ++e) {
+    LV2_Schedule_Node* const from = &nodes[edges[e].from];
+
+    schedule->successors[from->first + from->pending++] = edges[e].to;
+  }
+
+  // Sort the nodes, starting with the sources, to find any cycles
+  uint32_t n_sorted = 0U;
+  for (uint32_t n = 0U; n < n_nodes; ++n) {
+    nodes[n].pending = nodes[n].n_predecessors;
+    if (!nodes[n].n_predecessors) {
+      schedule->order[n_sorted++] = n;
+    }
+  }
+
+  schedule->n_sources = n_sorted;
+  for (uint32_t i = 0U; i < n_sorted; ++i) {
+    const LV2_Schedule_Node* const node = &nodes[schedule->order[i]];
+    for (uint32_t s = node->first; s < node->first + node->n_successors; ++s) {
+      const uint32_t succ = schedule->successors[s];
+      if (!--nodes[succ].pending) {
+        schedule->order[n_sorted++] = succ;
+      }
+    }
+  }
+
+  return n_sorted == n_nodes;
+}
+
+/**
+   Run every node in order in the calling thread.
+
+   This is used by lv2_schedule_run() if there is only one worker, and can be
+   used by hosts to run small graphs where parallelism is not worthwhile.
+*/
+static inline void
+lv2_schedule_run_serial(LV2_Schedule* const schedule,
+                        const uint32_t      sample_count)
+{
+  for (uint32_t i = 0U; i < schedule->n_nodes; ++i) {
+    const LV2_Schedule_Node* const node = &schedule->nodes[schedule->order[i]];
+
+    node->descriptor->run(node->instance, sample_count);
+  }
+
+  schedule->workers[0].n_run += schedule->n_nodes;
+}
+
+/**
+   Run a cycle of the graph, and wait for every node to finish.
+
+   This must be called by one thread at a time, which acts as the first
+   worker.
+
+   @param schedule The schedule of the graph.
+   @param sample_count The sample count to pass to every run() call.
+*/
+static inline void
+lv2_schedule_run(LV2_Schedule* const schedule, const uint32_t sample_count)
+{
+  if (schedule->n_workers == 1U) {
+    lv2_schedule_run_serial(schedule, sample_count);
+    return;
+  }
+
+  // Reset the cycle, which no other worker can see until it is opened
+  for (uint32_t n = 0U; n < schedule->n_nodes; ++n) {
+    schedule->nodes[n].pending = schedule->nodes[n].n_predecessors;
+  }
+
+  for (uint32_t w = 0U; w < schedule->n_workers; ++w) {
+    schedule->workers[w].ends = 0U;
+  }
+
+  // Deal the sources to the workers, so each tends to run the same nodes
+  for (uint32_t i = 0U; i < schedule->n_sources; ++i) {
+    LV2_Schedule_Worker* const worker =
+      &schedule->workers[i % schedule->n_workers];
+
+    worker->slots[worker->ends++] = schedule->order[i];
+  }
+
+  schedule->sample_count = sample_count;
+  lv2_atomic_store(&schedule->n_done, 0U);
+  lv2_atomic_add(&schedule->state, LV2_SCHEDULE_OPEN);
+  if (schedule->notify) {
+    schedule->notify(schedule->handle);
+  }
+
+  lv2_schedule_work(schedule, 0U);
+
+  // Close the cycle, and wait for other workers to leave
+  lv2_atomic_sub(&schedule->state, LV2_SCHEDULE_OPEN);
+  while (lv2_atomic_load(&schedule->state)) {
+    lv2_atomic_pause();
+  }
+}
+
+/**
+   Help run the current cycle as another worker.
+
+   This should be called by every worker thread but the first when it is
+   notified.  It returns when every node in the cycle has run, or immediately
+   if no cycle is running.
+
+   @param schedule The schedule of the graph.
+   @param index The index of the calling worker, from 1 to `n_workers - 1`.
+   @return True if the worker joined a cycle.
+*/
+static inline bool
+lv2_schedule_help(LV2_Schedule* const schedule, const uint32_t index)
+{
+  // Join the cycle if it is open, so it stays valid until we leave
+  uint32_t state = lv2_atomic_load(&schedule->state);
+  while ((state & LV2_SCHEDULE_OPEN) &&
+         !lv2_atomic_cas(&schedule->state, state, state + 1U)) {
+    state = lv2_atomic_load(&schedule->state);
+  }
+
+  if (!(state & LV2_SCHEDULE_OPEN)) {
+    return false;
+  }
+
+  lv2_schedule_work(schedule, index);
+  lv2_atomic_sub(&schedule->state, 1U);
+  return true;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_CORE_SCHEDULE_H
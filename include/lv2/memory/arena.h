@@ -0,0 +1,649 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_MEMORY_ARENA_H
+#define LV2_MEMORY_ARENA_H
+
+/**
+   @file arena.h A reference realtime safe allocator for plugin instances.
+
+   This is a host-side implementation of LV2_Memory_Allocator, based on the
+   Two-Level Segregated Fit (TLSF) algorithm.  Free blocks are kept in lists
+   by size class, with a two-level bitmap of the non-empty lists, so finding
+   a suitable block for an allocation takes a few bit operations regardless
+   of how many blocks there are.  Blocks are split when allocated and merged
+   with their neighbours when freed, so fragmentation stays low.
+
+   The host owns all memory.  A typical host:
+
+     - Allocates a large block of memory, and locks it in physical memory
+       with mlock() or similar so that using it never causes a page fault.
+
+     - Calls lv2_memory_arena_init() with that memory.
+
+     - For each instance, calls lv2_memory_client_init() with the arena and
+       the budget of the instance, and passes the `allocator` field as the
+       data of the mem:allocator feature.
+
+     - Reads the statistics of each client with lv2_memory_client_stats() to
+       account for the memory used by each instance.
+
+     - Calls lv2_memory_client_cleanup() after the instance is cleaned up.
+
+   Every arena is protected by a spin lock, which is only held for a bounded
+   time.  A client with a budget takes a region of that size from the shared
+   arena when it is initialised, and allocates from its own sub-arena within
+   it, so calls for different instances never contend.  Only threads that
+   call into the same instance, such as its audio and worker threads, can
+   wait for each other.  If one is preempted while holding the lock, the
+   others spin until it runs again, so hosts should give the threads that use
+   one instance the same realtime priority, as is typical for workers.
+   Clients without a budget allocate from the shared arena directly, and
+   contend with every other such client.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup memory_arena Arena
+   @ingroup memory
+
+   A reference realtime safe allocator for plugin instances.
+
+   @{
+*/
+
+#include <lv2/core/atomic.h>
+#include <lv2/memory/memory.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The minimum alignment of allocated memory. */
+#define LV2_MEMORY_ALIGN 16U
+
+/** The size of a block header, which precedes every allocation. */
+#define LV2_MEMORY_HEADER 16U
+
+/** The minimum size of a block, including its header. */
+#define LV2_MEMORY_MIN_BLOCK 32U
+
+/** The base two logarithm of the number of lists in each size class. */
+#define LV2_MEMORY_SL_LOG2 4U
+
+/** The number of lists in each size class. */
+#define LV2_MEMORY_SL_COUNT (1U << LV2_MEMORY_SL_LOG2)
+
+/** The base two logarithm of the smallest size in the second class. */
+#define LV2_MEMORY_FL_SHIFT 8U
+
+/** The number of size classes. */
+#define LV2_MEMORY_FL_COUNT 31U
+
+/** Flag set in LV2_Memory_Block::size for allocated blocks. */
+#define LV2_MEMORY_USED 1U
+
+/**
+   The header of a block of memory in an arena.
+
+   Free blocks have pointers to the next and previous free blocks in their
+   list after the header.
+*/
+typedef struct LV2_Memory_Block {
+  size_t prev_size; ///< Size of the previous block, or zero for the first
+  size_t size;      ///< Size including the header, and used flag
+} LV2_Memory_Block;
+
+/**
+   An arena of memory which blocks are allocated from.
+*/
+typedef struct {
+  uint8_t*          memory;    ///< Aligned start of the memory
+  size_t            size;      ///< Size of the memory used by the arena
+  uint32_t          fl_bitmap; ///< Size classes with free blocks
+  volatile uint32_t lock;      ///< Spin lock, non-zero while held
+
+  /** Lists with free blocks in each size class. */
+  uint32_t sl_bitmaps[LV2_MEMORY_FL_COUNT];
+
+  /** First free block in each list. */
+  LV2_Memory_Block* heads[LV2_MEMORY_FL_COUNT][LV2_MEMORY_SL_COUNT];
+} LV2_Memory_Arena;
+
+/**
+   Memory statistics of a client.
+*/
+typedef struct {
+  size_t   used;       ///< Bytes allocated, including headers
+  size_t   peak;       ///< Maximum bytes allocated at once
+  uint32_t n_allocs;   ///< Number of successful allocations
+  uint32_t n_frees;    ///< Number of frees
+  uint32_t n_failures; ///< Number of failed allocations
+} LV2_Memory_Stats;
+
+/**
+   A client of an arena, typically a plugin instance.
+*/
+typedef struct {
+  LV2_Memory_Allocator allocator; ///< Feature for the instance
+  LV2_Memory_Arena*    arena;     ///< Arena to allocate from
+  LV2_Memory_Arena*    parent;    ///< Shared arena
+  void*                region;    ///< Region of `parent` used, or NULL
+  size_t               budget;    ///< Maximum bytes used, or zero
+  LV2_Memory_Stats     stats;     ///< Statistics, protected by the lock
+  LV2_Memory_Arena     own;       ///< Sub-arena in `region`
+} LV2_Memory_Client;
+
+/**
+   @name Blocks
+   @{
+*/
+
+/** Return the index of the most significant set bit in a non-zero value. */
+static inline uint32_t
+lv2_memory_fls(const uint64_t x)
+{
+  uint64_t v = x;
+  uint32_t r = 0U;
+  for (uint32_t shift = 32U; shift; shift >>= 1U) {
+    if (v >> shift) {
+      v >>= shift;
+      r += shift;
+    }
+  }
+
+  return r;
+}
+
+/** Return the index of the least significant set bit in a non-zero value. */
+static inline uint32_t
+lv2_memory_ffs(const uint32_t x)
+{
+  return lv2_memory_fls(x & (~x + 1U));
+}
+
+/** Return the size of a block including its header. */
+static inline size_t
+lv2_memory_block_size(const LV2_Memory_Block* const block)
+{
+  return block->size & ~(size_t)LV2_MEMORY_USED;
+}
+
+/** Return the block after a block in memory. */
+static inline LV2_Memory_Block*
+lv2_memory_block_next(LV2_Memory_Block* const block)
+{
+  return (LV2_Memory_Block*)((uint8_t*)block + lv2_memory_block_size(block));
+}
+
+/** Return the list links of a free block. */
+static inline LV2_Memory_Block**
+lv2_memory_block_links(LV2_Memory_Block* const block)
+{
+  return (LV2_Memory_Block**)((uint8_t*)block + LV2_MEMORY_HEADER);
+}
+
+/** Set the size of a block, and the previous size of the following one. */
+static inline void
+lv2_memory_block_resize(LV2_Memory_Block* const block,
+                        const size_t            size,
+                        const size_t            flags)
+{
+  block->size                             = size | flags;
+  lv2_memory_block_next(block)->prev_size = size;
+}
+
+/**
+   Get the list for a block size.
+
+   @return False if the size is too large for any list.
+*/
+static inline bool
+lv2_memory_mapping(const size_t    size,
+                   uint32_t* const fl,
+                   uint32_t* const sl)
+{
+  if (size < (1U << LV2_MEMORY_FL_SHIFT)) {
+    *fl = 0U;
+    *sl = (uint32_t)(size / LV2_MEMORY_ALIGN);
+    return true;
+  }
+
+  const uint32_t f = lv2_memory_fls(size);
+
+  *fl = f - LV2_MEMORY_FL_SHIFT + 1U;
+  *sl = (uint32_t)(size >> (f - LV2_MEMORY_SL_LOG2)) ^ LV2_MEMORY_SL_COUNT;
+  return *fl < LV2_MEMORY_FL_COUNT;
+}
+
+/** Add a free block to its list. */
+static inline void
+lv2_memory_insert(LV2_Memory_Arena* const arena, LV2_Memory_Block* const block)
+{
+  uint32_t fl = 0U;
+  uint32_t sl = 0U;
+  lv2_memory_mapping(lv2_memory_block_size(block), &fl, &sl);
+
+  LV2_Memory_Block** const links = lv2_memory_block_links(block);
+  LV2_Memory_Block* const  head  = arena->heads[fl][sl];
+
+  links[0] = head;
+  links[1] = NULL;
+  if (head) {
+    lv2_memory_block_links(head)[1] = block;
+  }
+
+  arena->heads[fl][sl] = block;
+  arena->fl_bitmap |= 1U << fl;
+  arena->sl_bitmaps[fl] |= 1U << sl;
+}
+
+/** Remove a free block from its list. */
+static inline void
+lv2_memory_remove(LV2_Memory_Arena* const arena, LV2_Memory_Block* const block)
+{
+  uint32_t fl = 0U;
+  uint32_t sl = 0U;
+  lv2_memory_mapping(lv2_memory_block_size(block), &fl, &sl);
+
+  LV2_Memory_Block** const links = lv2_memory_block_links(block);
+  if (links[0]) {
+    lv2_memory_block_links(links[0])[1] = links[1];
+  }
+
+  if (links[1]) {
+    lv2_memory_block_links(links[1])[0] = links[0];
+  } else if (!(arena->heads[fl][sl] = links[0])) {
+    arena->sl_bitmaps[fl] &= ~(1U << sl);
+    if (!arena->sl_bitmaps[fl]) {
+      arena->fl_bitmap &= ~(1U << fl);
+    }
+  }
+}
+
+/** Find and remove a free block of at least the given size, or NULL. */
+static inline LV2_Memory_Block*
+lv2_memory_take(LV2_Memory_Arena* const arena, const size_t size)
+{
+  // Round up to the next list, so that any block there is large enough
+  size_t rounded = size;
+  if (size >= (1U << LV2_MEMORY_FL_SHIFT)) {
+    rounded += ((size_t)1U << (lv2_memory_fls(size) - LV2_MEMORY_SL_LOG2)) - 1U;
+  }
+
+  uint32_t fl = 0U;
+  uint32_t sl = 0U;
+  if (rounded < size || !lv2_memory_mapping(rounded, &fl, &sl)) {
+    return NULL;
+  }
+
+  // Find the first non-empty list in this class, or the next larger class
+  uint32_t sl_map = arena->sl_bitmaps[fl] & (~0U << sl);
+  if (!sl_map) {
+    const uint32_t fl_map =
+      (fl + 1U < 32U) ? (arena->fl_bitmap & (~0U << (fl + 1U))) : 0U;
+    if (!fl_map) {
+      return NULL;
+    }
+
+    fl     = lv2_memory_ffs(fl_map);
+    sl_map = arena->sl_bitmaps[fl];
+  }
+
+  LV2_Memory_Block* const block = arena->heads[fl][lv2_memory_ffs(sl_map)];
+  lv2_memory_remove(arena, block);
+  return block;
+}
+
+/**
+   @}
+   @name Arena
+   @{
+*/
+
+/**
+   Initialise an arena.
+
+   @param arena Arena to initialise.
+   @param memory Memory for blocks, which must remain valid while the arena
+   is used.
+   @param size Size of `memory` in bytes.
+   @return True on success, or false if `memory` is too small.
+*/
+static inline bool
+lv2_memory_arena_init(LV2_Memory_Arena* const arena,
+                      void* const             memory,
+                      const size_t            size)
+{
+  const size_t offset =
+    (LV2_MEMORY_ALIGN - ((uintptr_t)memory % LV2_MEMORY_ALIGN)) %
+    LV2_MEMORY_ALIGN;
+
+  memset(arena, 0, sizeof(LV2_Memory_Arena));
+  if (size < offset + LV2_MEMORY_MIN_BLOCK + LV2_MEMORY_HEADER) {
+    return false;
+  }
+
+  // Use as much memory as the largest size class can hold
+  const uint64_t max_size = (uint64_t)1U
+                            << (LV2_MEMORY_FL_COUNT + LV2_MEMORY_FL_SHIFT - 1U);
+
+  size_t usable = (size - offset) & ~(size_t)(LV2_MEMORY_ALIGN - 1U);
+  if ((uint64_t)usable > max_size) {
+    usable = (size_t)max_size;
+  }
+
+  arena->memory = (uint8_t*)memory + offset;
+  arena->size   = usable;
+
+  // Add a single free block, followed by a used sentinel header
+  LV2_Memory_Block* const first = (LV2_Memory_Block*)arena->memory;
+  LV2_Memory_Block* const last =
+    (LV2_Memory_Block*)(arena->memory + usable - LV2_MEMORY_HEADER);
+
+  first->prev_size = 0U;
+  last->size       = LV2_MEMORY_USED;
+  lv2_memory_block_resize(first, usable - LV2_MEMORY_HEADER, 0U);
+  lv2_memory_insert(arena, first);
+  return true;
+}
+
+/**
+   Allocate memory from an arena.
+
+   This does not lock the arena, see lv2_memory_client_allocate().
+
+   @return The allocated memory, or NULL.
+*/
+static inline void*
+lv2_memory_arena_allocate(LV2_Memory_Arena* const arena,
+                          const size_t            size,
+                          const size_t            alignment)
+{
+  const size_t align =
+    (alignment > LV2_MEMORY_ALIGN) ? alignment : LV2_MEMORY_ALIGN;
+
+  if (!size || (align & (align - 1U)) || size > arena->size ||
+      align > arena->size) {
+    return NULL;
+  }
+
+  // Calculate the block size, and the size needed for any alignment gap
+  size_t needed = (size + LV2_MEMORY_HEADER + LV2_MEMORY_ALIGN - 1U) &
+                  ~(size_t)(LV2_MEMORY_ALIGN - 1U);
+  if (needed < LV2_MEMORY_MIN_BLOCK) {
+    needed = LV2_MEMORY_MIN_BLOCK;
+  }
+
+  const size_t search =
+    (align > LV2_MEMORY_ALIGN) ? needed + align + LV2_MEMORY_MIN_BLOCK
+                               : needed;
+
+  LV2_Memory_Block* block =
+    (search >= needed) ? lv2_memory_take(arena, search) : NULL;
+  if (!block) {
+    return NULL;
+  }
+
+  // Split off a free block before the aligned payload if necessary
+  const uintptr_t payload = (uintptr_t)block + LV2_MEMORY_HEADER;
+  if (payload % align) {
+    size_t gap = align - (payload % align);
+    if (gap < LV2_MEMORY_MIN_BLOCK) {
+      gap += ((LV2_MEMORY_MIN_BLOCK - gap + align - 1U) / align) * align;
+    }
+
+    LV2_Memory_Block* const rest =
+      (LV2_Memory_Block*)((uint8_t*)block + gap);
+
+    lv2_memory_block_resize(rest, lv2_memory_block_size(block) - gap, 0U);
+    lv2_memory_block_resize(block, gap, 0U);
+    lv2_memory_insert(arena, block);
+    block = rest;
+  }
+
+  // Split off a free block after the allocation if it is large enough
+  const size_t block_size = lv2_memory_block_size(block);
+  if (block_size - needed >= LV2_MEMORY_MIN_BLOCK) {
+    LV2_Memory_Block* const rest =
+      (LV2_Memory_Block*)((uint8_t*)block + needed);
+
+    lv2_memory_block_resize(rest, block_size - needed, 0U);
+    lv2_memory_block_resize(block, needed, 0U);
+    lv2_memory_insert(arena, rest);
+  }
+
+  block->size |= LV2_MEMORY_USED;
+  return (uint8_t*)block + LV2_MEMORY_HEADER;
+}
+
+/**
+   Return the size of the block of an allocation, including its header.
+*/
+static inline size_t
+lv2_memory_arena_block_size(const void* const ptr)
+{
+  return lv2_memory_block_size(
+    (const LV2_Memory_Block*)((const uint8_t*)ptr - LV2_MEMORY_HEADER));
+}
+
+/**
+   Free memory allocated from an arena, merging it with any free neighbours.
+
+   This does not lock the arena, see lv2_memory_client_deallocate().
+*/
+static inline void
+lv2_memory_arena_deallocate(LV2_Memory_Arena* const arena, void* const ptr)
+{
+  LV2_Memory_Block* block =
+    (LV2_Memory_Block*)((uint8_t*)ptr - LV2_MEMORY_HEADER);
+
+  size_t                  size = lv2_memory_block_size(block);
+  LV2_Memory_Block* const next = lv2_memory_block_next(block);
+  if (!(next->size & LV2_MEMORY_USED)) {
+    lv2_memory_remove(arena, next);
+    size += lv2_memory_block_size(next);
+  }
+
+  if (block->prev_size) {
+    LV2_Memory_Block* const prev =
+      (LV2_Memory_Block*)((uint8_t*)block - block->prev_size);
+
+    if (!(prev->size & LV2_MEMORY_USED)) {
+      lv2_memory_remove(arena, prev);
+      size += lv2_memory_block_size(prev);
+      block = prev;
+    }
+  }
+
+  lv2_memory_block_resize(block, size, 0U);
+  lv2_memory_insert(arena, block);
+}
+
+/**
+   Lock an arena, spinning until it is available.
+*/
+static inline void
+lv2_memory_arena_lock(LV2_Memory_Arena* const arena)
+{
+  while (!lv2_atomic_cas(&arena->lock, 0U, 1U)) {
+    lv2_atomic_pause();
+  }
+}
+
+/**
+   Unlock an arena.
+*/
+static inline void
+lv2_memory_arena_unlock(LV2_Memory_Arena* const arena)
+{
+  lv2_atomic_store(&arena->lock, 0U);
+}
+
+/**
+   @}
+   @name Client
+   @{
+*/
+
+/**
+   Allocate memory for a client.
+
+   This is the LV2_Memory_Allocator::allocate() implementation.
+*/
+static inline void*
+lv2_memory_client_allocate(LV2_Memory_Handle handle,
+                           const size_t      size,
+                           const size_t      alignment)
+{
+  LV2_Memory_Client* const client = (LV2_Memory_Client*)handle;
+  LV2_Memory_Arena* const  arena  = client->arena;
+  LV2_Memory_Stats* const  stats  = &client->stats;
+
+  lv2_memory_arena_lock(arena);
+
+  void* const ptr = lv2_memory_arena_allocate(arena, size, alignment);
+  if (ptr) {
+    const size_t block_size = lv2_memory_arena_block_size(ptr);
+    if (client->budget && stats->used + block_size > client->budget) {
+      lv2_memory_arena_deallocate(arena, ptr);
+      ++stats->n_failures;
+      lv2_memory_arena_unlock(arena);
+      return NULL;
+    }
+
+    stats->used += block_size;
+    stats->peak = (stats->used > stats->peak) ? stats->used : stats->peak;
+    ++stats->n_allocs;
+  } else {
+    ++stats->n_failures;
+  }
+
+  lv2_memory_arena_unlock(arena);
+  return ptr;
+}
+
+/**
+   Free memory allocated for a client.
+
+   This is the LV2_Memory_Allocator::deallocate() implementation.
+*/
+static inline void
+lv2_memory_client_deallocate(LV2_Memory_Handle handle, void* const ptr)
+{
+  LV2_Memory_Client* const client = (LV2_Memory_Client*)handle;
+  LV2_Memory_Arena* const  arena  = client->arena;
+
+  if (ptr) {
+    lv2_memory_arena_lock(arena);
+    client->stats.used -= lv2_memory_arena_block_size(ptr);
+    ++client->stats.n_frees;
+    lv2_memory_arena_deallocate(arena, ptr);
+    lv2_memory_arena_unlock(arena);
+  }
+}
+
+/**
+   Free the resources of a client.
+
+   This returns the region of a client with a budget to the shared arena, so
+   every allocation made for the client becomes invalid.  This locks the
+   shared arena, so it should not be called in a realtime thread.
+*/
+static inline void
+lv2_memory_client_cleanup(LV2_Memory_Client* const client)
+{
+  if (client->region) {
+    lv2_memory_arena_lock(client->parent);
+    lv2_memory_arena_deallocate(client->parent, client->region);
+    lv2_memory_arena_unlock(client->parent);
+    client->region = NULL;
+  }
+
+  client->arena = client->parent;
+}
+
+/**
+   Initialise a client of an arena.
+
+   This locks the shared arena, so it should not be called in a realtime
+   thread.
+
+   @param client Client to initialise.
+   @param arena Shared arena to allocate from.
+   @param budget Maximum number of bytes the client may use at once,
+   including headers, or zero for no limit.
+   @return True on success, or false if the shared arena does not have enough
+   free memory for the budget.
+*/
+static inline bool
+lv2_memory_client_init(LV2_Memory_Client* const client,
+                       LV2_Memory_Arena* const  arena,
+                       const size_t             budget)
+{
+  memset(client, 0, sizeof(LV2_Memory_Client));
+  client->allocator.handle     = client;
+  client->allocator.allocate   = lv2_memory_client_allocate;
+  client->allocator.deallocate = lv2_memory_client_deallocate;
+  client->arena                = arena;
+  client->parent               = arena;
+  client->budget               = budget;
+  if (!budget) {
+    return true;
+  }
+
+  // Take a region with room for the budget and the sub-arena's sentinel
+  const size_t aligned = (budget + LV2_MEMORY_ALIGN - 1U) &
+                         ~(size_t)(LV2_MEMORY_ALIGN - 1U);
+  const size_t size    = aligned + LV2_MEMORY_HEADER;
+  if (aligned < budget || size < aligned) {
+    return false;
+  }
+
+  lv2_memory_arena_lock(arena);
+  client->region = lv2_memory_arena_allocate(arena, size, 0U);
+  lv2_memory_arena_unlock(arena);
+
+  if (!client->region ||
+      !lv2_memory_arena_init(&client->own, client->region, size)) {
+    lv2_memory_client_cleanup(client);
+    return false;
+  }
+
+  client->arena = &client->own;
+  return true;
+}
+
+/**
+   Get a consistent copy of the statistics of a client.
+*/
+static inline void
+lv2_memory_client_stats(LV2_Memory_Client* const client,
+                        LV2_Memory_Stats* const  stats)
+{
+  lv2_memory_arena_lock(client->arena);
+  *stats = client->stats;
+  lv2_memory_arena_unlock(client->arena);
+}
+
+/**
+   @}
+*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_MEMORY_ARENA_H
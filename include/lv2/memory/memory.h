@@ -0,0 +1,83 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_MEMORY_MEMORY_H
+#define LV2_MEMORY_MEMORY_H
+
+/**
+   @defgroup memory Memory
+   @ingroup lv2
+
+   Realtime safe dynamic memory allocation.
+
+   See <http://lv2plug.in/ns/ext/memory> for details.
+
+   @{
+*/
+
+#include <stddef.h>
+
+// clang-format off
+
+#define LV2_MEMORY_URI    "http://lv2plug.in/ns/ext/memory"  ///< http://lv2plug.in/ns/ext/memory
+#define LV2_MEMORY_PREFIX LV2_MEMORY_URI "#"                 ///< http://lv2plug.in/ns/ext/memory#
+
+#define LV2_MEMORY__allocator LV2_MEMORY_PREFIX "allocator"  ///< http://lv2plug.in/ns/ext/memory#allocator
+
+// clang-format on
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Opaque handle for LV2_Memory_Allocator. */
+typedef void* LV2_Memory_Handle;
+
+/**
+   Allocator Host Feature.
+
+   The host passes this feature to provide functions for allocating memory in
+   bounded time, which the plugin may use in any method including run().
+*/
+typedef struct {
+  /**
+     Opaque host data.
+  */
+  LV2_Memory_Handle handle;
+
+  /**
+     Allocate memory.
+
+     This function is realtime safe, and may be called from any thread,
+     including concurrently.  It takes a bounded amount of time which does not
+     depend on the number of existing allocations.
+
+     @param handle The handle field of this struct.
+     @param size The size of the memory to allocate in bytes.
+     @param alignment The alignment of the memory, which must be a power of
+     two, or zero for an alignment suitable for any basic type.
+     @return A pointer to the memory, or NULL if there is not enough memory
+     available for this instance.
+  */
+  void* (*allocate)(LV2_Memory_Handle handle, size_t size, size_t alignment);
+
+  /**
+     Free memory allocated with allocate().
+
+     This function is realtime safe, and may be called from any thread.
+
+     @param handle The handle field of this struct.
+     @param ptr The memory to free, or NULL.
+  */
+  void (*deallocate)(LV2_Memory_Handle handle, void* ptr);
+} LV2_Memory_Allocator;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_MEMORY_MEMORY_H
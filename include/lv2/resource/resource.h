@@ -0,0 +1,130 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_RESOURCE_RESOURCE_H
+#define LV2_RESOURCE_RESOURCE_H
+
+/**
+   @defgroup resource Resource
+   @ingroup lv2
+
+   Sharing read-only data between plugin instances.
+
+   See <http://lv2plug.in/ns/ext/resource> for details.
+
+   @{
+*/
+
+#include <stddef.h>
+
+// clang-format off
+
+#define LV2_RESOURCE_URI    "http://lv2plug.in/ns/ext/resource"  ///< http://lv2plug.in/ns/ext/resource
+#define LV2_RESOURCE_PREFIX LV2_RESOURCE_URI "#"                 ///< http://lv2plug.in/ns/ext/resource#
+
+#define LV2_RESOURCE__cache LV2_RESOURCE_PREFIX "cache"  ///< http://lv2plug.in/ns/ext/resource#cache
+
+// clang-format on
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Opaque handle for LV2_Resource_Cache. */
+typedef void* LV2_Resource_Cache_Handle;
+
+/**
+   A shared read-only resource.
+*/
+typedef struct {
+  const void* data; ///< Contents, aligned to at least 64 bytes
+  size_t      size; ///< Size of `data` in bytes
+} LV2_Resource;
+
+/**
+   A function that writes the contents of a new resource.
+
+   @param data The `data` argument passed to LV2_Resource_Cache::acquire().
+   @param buffer Buffer for the contents, aligned to at least 64 bytes.
+   @param size The size of `buffer` in bytes.
+   @return Zero on success, in which case the whole buffer must be written.
+*/
+typedef int (*LV2_Resource_Build_Function)(void* data,
+                                           void* buffer,
+                                           size_t size);
+
+/**
+   Resource Cache Host Feature.
+
+   The host passes this feature to provide access to a cache of read-only
+   resources shared by every instance in the process.
+
+   The functions here may block, and must only be called in non-realtime
+   contexts, but may be called concurrently from any thread.
+*/
+typedef struct {
+  /**
+     Opaque host data.
+  */
+  LV2_Resource_Cache_Handle handle;
+
+  /**
+     Get the contents of a file.
+
+     The host returns the same resource for every request for a file, as long
+     as the file is not modified.  The contents may be mapped into memory, so
+     pages are only read from disk when they are used.
+
+     @param handle The handle field of this struct.
+     @param path Absolute path of the file.
+     @return The file contents, which must be released, or NULL on error.
+  */
+  const LV2_Resource* (*map_file)(LV2_Resource_Cache_Handle handle,
+                                  const char*               path);
+
+  /**
+     Get a resource built by the plugin.
+
+     If a resource with `key` is cached, it is returned.  Otherwise, the host
+     allocates `size` bytes, calls `build` to write the contents, and returns
+     the new resource if it succeeds.  The host calls `build` at most once at
+     a time for any key, and other threads that request the same key wait for
+     it to finish.  The build function must not call any function of the
+     cache.
+
+     @param handle The handle field of this struct.
+     @param key Unique key for the contents, which should be a URI.
+     @param size The size of the resource in bytes, which must be non-zero.
+     @param build Function to write the contents if they are not cached.
+     @param data Data passed to `build`.
+     @return The resource, which must be released, or NULL if `build` failed
+     or a resource with the same key has a different size.
+  */
+  const LV2_Resource* (*acquire)(LV2_Resource_Cache_Handle   handle,
+                                 const char*                 key,
+                                 size_t                      size,
+                                 LV2_Resource_Build_Function build,
+                                 void*                       data);
+
+  /**
+     Release a resource returned by map_file() or acquire().
+
+     Every resource returned to the plugin must be released exactly once,
+     before cleanup() returns, and must not be used afterwards.
+
+     @param handle The handle field of this struct.
+     @param resource The resource to release.
+  */
+  void (*release)(LV2_Resource_Cache_Handle handle,
+                  const LV2_Resource*       resource);
+} LV2_Resource_Cache;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_RESOURCE_RESOURCE_H
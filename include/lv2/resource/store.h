@@ -0,0 +1,583 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_RESOURCE_STORE_H
+#define LV2_RESOURCE_STORE_H
+
+/**
+   @file store.h A reference resource cache for hosts.
+
+   This is a host-side implementation of LV2_Resource_Cache, which keeps every
+   resource in memory for as long as any instance uses it.  Resources are
+   reference counted, and freed or unmapped as soon as the last reference is
+   released, so memory is never held for resources that nothing uses.
+
+   Files are identified by their path, size, and modification time, so a file
+   that is modified is loaded again for later requests, while instances that
+   still use the old contents keep them until they release them.  Other
+   resources are identified by their key alone.
+
+   The host provides the operations for mapping files and synchronisation, so
+   that it can use mmap() or similar, and its own mutex and condition
+   variable.  The map and unmap functions may be set to the stdio
+   implementations provided here, which read files into memory.  A typical
+   host:
+
+     - Calls lv2_resource_store_init() once, with host operations that use a
+       mutex for locking, and a condition variable for waiting.
+
+     - Passes the `cache` field as the data of the res:cache feature to every
+       instance.
+
+     - Calls lv2_resource_store_cleanup() after every instance is destroyed.
+
+   The lock is only held while the list of entries is used, never while a
+   file is mapped or a resource is built.  Before loading, a placeholder entry
+   is added for the resource, so that other threads which request the same
+   resource wait for it to be loaded instead of loading it again, while
+   requests for other resources are served meanwhile.  This lets instances
+   be instantiated in parallel, even if each builds a large resource.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup resource_store Store
+   @ingroup resource
+
+   A reference resource cache for hosts.
+
+   @{
+*/
+
+#include <lv2/resource/resource.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The alignment of resource contents in bytes.
+*/
+#define LV2_RESOURCE_STORE_ALIGN 64U
+
+/**
+   Operations provided by the host.
+
+   Functions that return an int return zero on success.  The lock, wait, and
+   wake functions may be NULL if the store is only used by a single thread.
+*/
+typedef struct {
+  void* handle; ///< Opaque host data passed to every function
+
+  /**
+     Get the size and modification time of a file.
+
+     The time should have the highest available resolution, since a file that
+     is modified without changing its size or time is not loaded again.
+  */
+  int (*stat)(void*       handle,
+              const char* path,
+              uint64_t*   size,
+              uint64_t*   mtime);
+
+  /**
+     Map `size` bytes of a file into read-only memory, and return it or NULL.
+
+     The returned memory must be aligned to LV2_RESOURCE_STORE_ALIGN.
+  */
+  void* (*map)(void* handle, const char* path, size_t size);
+
+  /** Unmap memory returned by map(). */
+  void (*unmap)(void* handle, void* data, size_t size);
+
+  /** Lock the store, blocking if necessary. */
+  void (*lock)(void* handle);
+
+  /** Unlock the store. */
+  void (*unlock)(void* handle);
+
+  /**
+     Wait until woken by wake(), with the store locked.
+
+     Like pthread_cond_wait(), this must unlock the store while waiting, and
+     lock it again before returning.  It may return spuriously.
+  */
+  void (*wait)(void* handle);
+
+  /** Wake every thread that is waiting in wait(), with the store locked. */
+  void (*wake)(void* handle);
+} LV2_Resource_Store_Host;
+
+/**
+   A cached resource.
+*/
+typedef struct LV2_Resource_Store_Entry {
+  LV2_Resource                     resource; ///< Resource given to plugins
+  struct LV2_Resource_Store_Entry* next;     ///< Next entry in the store
+  char*                            key;      ///< Key, or path of a file
+  void*                            memory;   ///< Mapped or allocated data
+  uint64_t                         mtime;    ///< Modification time of a file
+  uint32_t                         n_refs;   ///< Number of references
+  bool                             file;     ///< True if mapped from a file
+  bool                             loading;  ///< True while being loaded
+  bool                             failed;   ///< True if loading failed
+} LV2_Resource_Store_Entry;
+
+/**
+   A resource cache.
+*/
+typedef struct {
+  LV2_Resource_Cache        cache;    ///< Feature for plugins
+  LV2_Resource_Store_Host   host;     ///< Host operations
+  LV2_Resource_Store_Entry* entries;  ///< Cached resources, newest first
+  uint64_t                  n_bytes;  ///< Total size of cached resources
+  uint32_t                  n_loads;  ///< Number of resources loaded or built
+  uint32_t                  n_shares; ///< Number of requests for cached ones
+} LV2_Resource_Store;
+
+/**
+   @name Utilities
+   @{
+*/
+
+/**
+   Allocate memory aligned to LV2_RESOURCE_STORE_ALIGN.
+
+   @return Aligned memory to free with lv2_resource_store_free(), or NULL.
+*/
+static inline void*
+lv2_resource_store_allocate(const size_t size)
+{
+  const size_t extra = LV2_RESOURCE_STORE_ALIGN + sizeof(void*);
+  if (size > SIZE_MAX - extra) {
+    return NULL;
+  }
+
+  void* const memory = malloc(size + extra);
+  if (!memory) {
+    return NULL;
+  }
+
+  // Align past a pointer to the allocation, which is stored before the data
+  const uintptr_t start   = (uintptr_t)memory + sizeof(void*);
+  const uintptr_t aligned = (start + LV2_RESOURCE_STORE_ALIGN - 1U) &
+                            ~(uintptr_t)(LV2_RESOURCE_STORE_ALIGN - 1U);
+
+  void** const data = (void**)aligned;
+  data[-1]          = memory;
+  return data;
+}
+
+/** Free memory allocated with lv2_resource_store_allocate(). */
+static inline void
+lv2_resource_store_free(void* const data)
+{
+  if (data) {
+    free(((void**)data)[-1]);
+  }
+}
+
+/** Read a whole file into memory with stdio. */
+static inline void*
+lv2_resource_store_stdio_map(void* const       handle,
+                             const char* const path,
+                             const size_t      size)
+{
+  (void)handle;
+
+  FILE* const file = fopen(path, "rb");
+  if (!file) {
+    return NULL;
+  }
+
+  void* const data = lv2_resource_store_allocate(size);
+  if (data && fread(data, 1U, size, file) != size) {
+    lv2_resource_store_free(data);
+    fclose(file);
+    return NULL;
+  }
+
+  fclose(file);
+  return data;
+}
+
+/** Free memory returned by lv2_resource_store_stdio_map(). */
+static inline void
+lv2_resource_store_stdio_unmap(void* const  handle,
+                               void* const  data,
+                               const size_t size)
+{
+  (void)handle;
+  (void)size;
+  lv2_resource_store_free(data);
+}
+
+/**
+   @}
+   @name Implementation
+   @{
+*/
+
+/** Lock a store if it has a lock. */
+static inline void
+lv2_resource_store_lock(const LV2_Resource_Store* const store)
+{
+  if (store->host.lock) {
+    store->host.lock(store->host.handle);
+  }
+}
+
+/** Unlock a store if it has a lock. */
+static inline void
+lv2_resource_store_unlock(const LV2_Resource_Store* const store)
+{
+  if (store->host.unlock) {
+    store->host.unlock(store->host.handle);
+  }
+}
+
+/**
+   Return the newest entry with a key, or NULL.
+
+   This must be called with the store locked.
+*/
+static inline LV2_Resource_Store_Entry*
+lv2_resource_store_find(const LV2_Resource_Store* const store,
+                        const char* const               key,
+                        const bool                      file)
+{
+  for (LV2_Resource_Store_Entry* e = store->entries; e; e = e->next) {
+    if (e->file == file && !strcmp(e->key, key)) {
+      return e;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   Add a placeholder entry for a resource that is about to be loaded.
+
+   The entry has a single reference, for the loading thread.  This must be
+   called with the store locked.
+
+   @return The new entry, or NULL if allocation failed.
+*/
+static inline LV2_Resource_Store_Entry*
+lv2_resource_store_add(LV2_Resource_Store* const store,
+                       const char* const         key,
+                       const size_t              size,
+                       const bool                file)
+{
+  const size_t key_len = strlen(key);
+
+  LV2_Resource_Store_Entry* const entry =
+    (LV2_Resource_Store_Entry*)calloc(1U, sizeof(LV2_Resource_Store_Entry));
+  if (!entry || !(entry->key = (char*)malloc(key_len + 1U))) {
+    free(entry);
+    return NULL;
+  }
+
+  memcpy(entry->key, key, key_len + 1U);
+  entry->resource.size = size;
+  entry->next          = store->entries;
+  entry->n_refs        = 1U;
+  entry->file          = file;
+  entry->loading       = true;
+
+  store->entries = entry;
+  return entry;
+}
+
+/** Free an entry that has been removed from the store. */
+static inline void
+lv2_resource_store_destroy(LV2_Resource_Store* const       store,
+                           LV2_Resource_Store_Entry* const entry)
+{
+  if (entry->memory) {
+    if (entry->file) {
+      store->host.unmap(
+        store->host.handle, entry->memory, entry->resource.size);
+    } else {
+      lv2_resource_store_free(entry->memory);
+    }
+
+    store->n_bytes -= entry->resource.size;
+  }
+
+  free(entry->key);
+  free(entry);
+}
+
+/**
+   Remove an entry from the store if it is there.
+
+   This must be called with the store locked.
+*/
+static inline void
+lv2_resource_store_unlink(LV2_Resource_Store* const       store,
+                          LV2_Resource_Store_Entry* const entry)
+{
+  LV2_Resource_Store_Entry** link = &store->entries;
+  while (*link && *link != entry) {
+    link = &(*link)->next;
+  }
+
+  if (*link) {
+    *link = entry->next;
+  }
+}
+
+/**
+   Drop a reference to an entry, and free it if it was the last.
+
+   This must be called with the store locked.
+*/
+static inline void
+lv2_resource_store_unref(LV2_Resource_Store* const       store,
+                         LV2_Resource_Store_Entry* const entry)
+{
+  if (!--entry->n_refs) {
+    lv2_resource_store_unlink(store, entry);
+    lv2_resource_store_destroy(store, entry);
+  }
+}
+
+/**
+   Finish loading an entry, and wake any threads waiting for it.
+
+   If `memory` is NULL, loading failed, and the entry is removed from the
+   store so that later requests try again.  This must be called with the
+   store locked, after lv2_resource_store_add().
+
+   @return The entry, or NULL if loading failed.
+*/
+static inline LV2_Resource_Store_Entry*
+lv2_resource_store_finish(LV2_Resource_Store* const       store,
+                          LV2_Resource_Store_Entry* const entry,
+                          void* const                     memory)
+{
+  entry->loading = false;
+  if (memory) {
+    entry->memory        = memory;
+    entry->resource.data = memory;
+    store->n_bytes += entry->resource.size;
+    ++store->n_loads;
+  } else {
+    entry->failed = true;
+    lv2_resource_store_unlink(store, entry);
+    lv2_resource_store_unref(store, entry);
+  }
+
+  if (store->host.wake) {
+    store->host.wake(store->host.handle);
+  }
+
+  return memory ? entry : NULL;
+}
+
+/**
+   Take a reference to an entry, waiting for it to be loaded if necessary.
+
+   This must be called with the store locked.
+
+   @return The entry, or NULL if loading it failed.
+*/
+static inline LV2_Resource_Store_Entry*
+lv2_resource_store_share(LV2_Resource_Store* const       store,
+                         LV2_Resource_Store_Entry* const entry)
+{
+  ++entry->n_refs;
+  while (entry->loading && store->host.wait) {
+    store->host.wait(store->host.handle);
+  }
+
+  if (entry->loading || entry->failed) {
+    lv2_resource_store_unref(store, entry);
+    return NULL;
+  }
+
+  ++store->n_shares;
+  return entry;
+}
+
+/**
+   Get the contents of a file.
+
+   This is the LV2_Resource_Cache::map_file() implementation.
+*/
+static inline const LV2_Resource*
+lv2_resource_store_map_file(LV2_Resource_Cache_Handle handle,
+                            const char* const         path)
+{
+  LV2_Resource_Store* const store = (LV2_Resource_Store*)handle;
+
+  uint64_t size  = 0U;
+  uint64_t mtime = 0U;
+  if (store->host.stat(store->host.handle, path, &size, &mtime) || !size ||
+      size != (uint64_t)(size_t)size) {
+    return NULL;
+  }
+
+  const size_t length = (size_t)size;
+
+  lv2_resource_store_lock(store);
+
+  // Share the newest mapping if the file has not changed since
+  LV2_Resource_Store_Entry* entry = lv2_resource_store_find(store, path, true);
+  if (entry && entry->resource.size == length && entry->mtime == mtime) {
+    entry = lv2_resource_store_share(store, entry);
+    lv2_resource_store_unlock(store);
+    return entry ? &entry->resource : NULL;
+  }
+
+  if (!(entry = lv2_resource_store_add(store, path, length, true))) {
+    lv2_resource_store_unlock(store);
+    return NULL;
+  }
+
+  // Map the file without the lock held, so other requests are served
+  entry->mtime = mtime;
+  lv2_resource_store_unlock(store);
+  void* const data = store->host.map(store->host.handle, path, length);
+  lv2_resource_store_lock(store);
+
+  entry = lv2_resource_store_finish(store, entry, data);
+  lv2_resource_store_unlock(store);
+  return entry ? &entry->resource : NULL;
+}
+
+/**
+   Get a resource, building it if necessary.
+
+   This is the LV2_Resource_Cache::acquire() implementation.
+*/
+static inline const LV2_Resource*
+lv2_resource_store_acquire(LV2_Resource_Cache_Handle         handle,
+                           const char* const                 key,
+                           const size_t                      size,
+                           const LV2_Resource_Build_Function build,
+                           void* const                       data)
+{
+  LV2_Resource_Store* const store = (LV2_Resource_Store*)handle;
+  if (!size) {
+    return NULL;
+  }
+
+  lv2_resource_store_lock(store);
+
+  // Share the cached resource, waiting for it if it is being built
+  LV2_Resource_Store_Entry* entry = lv2_resource_store_find(store, key, false);
+  if (entry) {
+    if (entry->resource.size == size) {
+      entry = lv2_resource_store_share(store, entry);
+    } else {
+      entry = NULL;
+    }
+
+    lv2_resource_store_unlock(store);
+    return entry ? &entry->resource : NULL;
+  }
+
+  if (!(entry = lv2_resource_store_add(store, key, size, false))) {
+    lv2_resource_store_unlock(store);
+    return NULL;
+  }
+
+  // Build the resource without the lock held, so other requests are served
+  lv2_resource_store_unlock(store);
+  void* memory = lv2_resource_store_allocate(size);
+  if (memory && build(data, memory, size)) {
+    lv2_resource_store_free(memory);
+    memory = NULL;
+  }
+
+  lv2_resource_store_lock(store);
+  entry = lv2_resource_store_finish(store, entry, memory);
+  lv2_resource_store_unlock(store);
+  return entry ? &entry->resource : NULL;
+}
+
+/**
+   Release a resource.
+
+   This is the LV2_Resource_Cache::release() implementation.
+*/
+static inline void
+lv2_resource_store_release(LV2_Resource_Cache_Handle handle,
+                           const LV2_Resource* const resource)
+{
+  LV2_Resource_Store* const store = (LV2_Resource_Store*)handle;
+
+  lv2_resource_store_lock(store);
+
+  LV2_Resource_Store_Entry* entry = store->entries;
+  while (entry && &entry->resource != resource) {
+    entry = entry->next;
+  }
+
+  if (entry) {
+    lv2_resource_store_unref(store, entry);
+  }
+
+  lv2_resource_store_unlock(store);
+}
+
+/**
+   @}
+*/
+
+/**
+   Initialise a resource cache.
+
+   @param store Store to initialise.
+   @param host Host operations, which are copied.
+*/
+static inline void
+lv2_resource_store_init(LV2_Resource_Store* const            store,
+                        const LV2_Resource_Store_Host* const host)
+{
+  memset(store, 0, sizeof(LV2_Resource_Store));
+  store->cache.handle   = store;
+  store->cache.map_file = lv2_resource_store_map_file;
+  store->cache.acquire  = lv2_resource_store_acquire;
+  store->cache.release  = lv2_resource_store_release;
+  store->host           = *host;
+}
+
+/**
+   Free every resource in a cache.
+
+   This should only be called when no instances that use the cache remain.
+   Any resources they did not release are freed.
+*/
+static inline void
+lv2_resource_store_cleanup(LV2_Resource_Store* const store)
+{
+  while (store->entries) {
+    LV2_Resource_Store_Entry* const entry = store->entries;
+
+    store->entries = entry->next;
+    lv2_resource_store_destroy(store, entry);
+  }
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_RESOURCE_STORE_H
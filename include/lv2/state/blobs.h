@@ -0,0 +1,662 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_BLOBS_H
+#define LV2_STATE_BLOBS_H
+
+/**
+   @file blobs.h Content-addressed storage for files saved with state.
+
+   This is a host-side implementation of the state:makePath, state:mapPath,
+   and state:freePath features which stores every file saved by a plugin
+   once, no matter how many instances or snapshots refer to it.
+
+   Plugins create files in a scratch directory with make_path(), and map their
+   paths with abstract_path() to store them in their state.  When a file in
+   the scratch directory is mapped, it is hashed and stored in a blob
+   directory under a name derived from its contents, for example
+   `0123456789abcdef-1024`, which is the abstract path.  If a blob with
+   that name already exists, and its contents are the same, it is shared
+   instead.  Since the abstract path only depends on the file contents, it
+   stays the same across saves while the file is unchanged, and is the same
+   for every instance that saves the same file.
+
+   The host provides the file system operations, so that it can use reflinks
+   to store blobs without copying on file systems that support them.  To
+   avoid hashing files again when they are mapped in later saves, the size and
+   modification time of every stored file are remembered in a host-provided
+   cache, which is indexed by path.
+
+   Paths outside the scratch directory, such as files from a user's sample
+   library, are mapped to themselves.
+
+   This implementation is not thread-safe, the host must not save or restore
+   several instances with the same LV2_State_Blobs concurrently.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_blobs Blobs
+   @ingroup state
+
+   Content-addressed storage for files saved with state.
+
+   @{
+*/
+
+#include <lv2/state/state.h>
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The size of the chunks in which files are read for hashing.
+*/
+#define LV2_STATE_BLOBS_CHUNK_SIZE 4096U
+
+/**
+   File system operations provided by the host.
+
+   Functions that return an int return zero on success.  The open, read, and
+   close functions may be set to the stdio implementations provided here.
+*/
+typedef struct {
+  void* handle; ///< Opaque host data passed to every function
+
+  /**
+     Get the size and modification time of a file.
+
+     The time should have the highest available resolution, since a file that
+     is modified without changing its size or time is not hashed again.
+  */
+  int (*stat)(void*       handle,
+              const char* path,
+              uint64_t*   size,
+              uint64_t*   mtime);
+
+  /** Open a file for reading, and return it or NULL. */
+  void* (*open)(void* handle, const char* path);
+
+  /** Read up to `size` bytes from a file, and return the number read. */
+  size_t (*read)(void* handle, void* file, void* buf, size_t size);
+
+  /** Close a file opened with open(). */
+  void (*close)(void* handle, void* file);
+
+  /**
+     Create a new file `dst` with a copy of the contents of `src`.
+
+     This should use a reflink (a copy-on-write clone) if possible, so that no
+     data is copied.  It must not create a hard link, since the plugin may
+     later rewrite `src` in place, for example by opening it again with
+     fopen() in "w" mode, which would also change the blob.
+  */
+  int (*copy)(void* handle, const char* src, const char* dst);
+
+  /** Create a directory and any missing parents, succeeding if it exists. */
+  int (*make_dirs)(void* handle, const char* path);
+} LV2_State_Blobs_Filesystem;
+
+/**
+   A cached mapping of a file in the scratch directory to its blob.
+*/
+typedef struct {
+  char*    path;  ///< Absolute path of the file
+  char*    name;  ///< Name of its blob, the abstract path
+  uint64_t size;  ///< Size of the file when it was hashed
+  uint64_t mtime; ///< Modification time of the file when it was hashed
+} LV2_State_Blobs_File;
+
+/**
+   A content-addressed blob store.
+*/
+typedef struct {
+  const char*                root;      ///< Blob directory
+  const char*                scratch;   ///< Scratch directory for new files
+  LV2_State_Blobs_Filesystem fs;        ///< File system operations
+  LV2_State_Blobs_File*      files;     ///< Cache of hashed files
+  uint32_t                   n_files;   ///< Number of cached files
+  uint32_t                   max_files; ///< Capacity of `files`
+  uint32_t*                  slots;     ///< Hash table of file indices
+  uint32_t                   mask;      ///< Number of slots minus one
+  uint32_t                   n_hashed;  ///< Number of files hashed
+  uint32_t                   n_stored;  ///< Number of new blobs stored
+  uint32_t                   n_shared;  ///< Number of existing blobs shared
+} LV2_State_Blobs;
+
+/**
+   The state path features of a plugin instance.
+
+   The feature data in this struct, with the instance as the handle, can be
+   passed directly to the plugin.
+*/
+typedef struct {
+  LV2_State_Blobs*    blobs;     ///< Blob store
+  const char*         name;      ///< Unique name of the instance
+  LV2_State_Make_Path make_path; ///< Data for state:makePath
+  LV2_State_Map_Path  map_path;  ///< Data for state:mapPath
+  LV2_State_Free_Path free_path; ///< Data for state:freePath
+} LV2_State_Blobs_Instance;
+
+/**
+   @name Utilities
+   @{
+*/
+
+/** Open a file for reading with stdio. */
+static inline void*
+lv2_state_blobs_stdio_open(void* const handle, const char* const path)
+{
+  (void)handle;
+  return fopen(path, "rb");
+}
+
+/** Read from a file with stdio. */
+static inline size_t
+lv2_state_blobs_stdio_read(void* const  handle,
+                           void* const  file,
+                           void* const  buf,
+                           const size_t size)
+{
+  (void)handle;
+  return fread(buf, 1U, size, (FILE*)file);
+}
+
+/** Close a file with stdio. */
+static inline void
+lv2_state_blobs_stdio_close(void* const handle, void* const file)
+{
+  (void)handle;
+  fclose((FILE*)file);
+}
+
+/** Return a newly allocated copy of a string. */
+static inline char*
+lv2_state_blobs_strdup(const char* const str)
+{
+  const size_t len  = strlen(str);
+  char* const  copy = (char*)malloc(len + 1U);
+  if (copy) {
+    memcpy(copy, str, len + 1U);
+  }
+
+  return copy;
+}
+
+/** Return a newly allocated path of `path` within `dir`. */
+static inline char*
+lv2_state_blobs_join(const char* const dir, const char* const path)
+{
+  const size_t dir_len  = strlen(dir);
+  const size_t path_len = strlen(path);
+  const bool   sep      = dir_len && dir[dir_len - 1U] != '/';
+  char* const  joined   = (char*)malloc(dir_len + sep + path_len + 1U);
+  if (joined) {
+    memcpy(joined, dir, dir_len);
+    joined[dir_len] = '/';
+    memcpy(joined + dir_len + sep, path, path_len + 1U);
+  }
+
+  return joined;
+}
+
+/**
+   Return the part of `path` within `dir`, or NULL if it is not within it.
+*/
+static inline const char*
+lv2_state_blobs_within(const char* const path, const char* const dir)
+{
+  size_t len = strlen(dir);
+  while (len && dir[len - 1U] == '/') {
+    --len;
+  }
+
+  return (!strncmp(path, dir, len) && path[len] == '/') ? path + len + 1U
+                                                         : NULL;
+}
+
+/**
+   @}
+   @name Store
+   @{
+*/
+
+/**
+   Return the number of hash slots for a cache of up to `max_files` files.
+
+   This is a power of two at least twice `max_files`, so probes stay short.
+*/
+static inline uint32_t
+lv2_state_blobs_n_slots(const uint32_t max_files)
+{
+  uint32_t n_slots = 2U;
+  while (n_slots / 2U < max_files && n_slots < 0x80000000U) {
+    n_slots <<= 1U;
+  }
+
+  return n_slots;
+}
+
+/**
+   Initialise a blob store.
+
+   @param blobs Blob store to initialise.
+   @param root Blob directory, which must exist.
+   @param scratch Scratch directory where plugins create new files.
+   @param fs File system operations.
+   @param files Array for caching hashed files.
+   @param max_files Capacity of `files`.  If it is full, files are hashed
+   again whenever they are mapped.
+   @param slots Array of lv2_state_blobs_n_slots() hash slots, used to find
+   cached files by path.
+*/
+static inline void
+lv2_state_blobs_init(LV2_State_Blobs* const                  blobs,
+                     const char* const                       root,
+                     const char* const                       scratch,
+                     const LV2_State_Blobs_Filesystem* const fs,
+                     LV2_State_Blobs_File* const             files,
+                     const uint32_t                          max_files,
+                     uint32_t* const                         slots)
+{
+  const uint32_t n_slots = lv2_state_blobs_n_slots(max_files);
+
+  blobs->root      = root;
+  blobs->scratch   = scratch;
+  blobs->fs        = *fs;
+  blobs->files     = files;
+  blobs->n_files   = 0U;
+  blobs->max_files = max_files;
+  blobs->slots     = slots;
+  blobs->mask      = n_slots - 1U;
+  blobs->n_hashed  = 0U;
+  blobs->n_stored  = 0U;
+  blobs->n_shared  = 0U;
+
+  memset(slots, 0, (size_t)n_slots * sizeof(uint32_t));
+}
+
+/**
+   Free the cache of a blob store.
+
+   This does not remove any files.
+*/
+static inline void
+lv2_state_blobs_cleanup(LV2_State_Blobs* const blobs)
+{
+  for (uint32_t i = 0U; i < blobs->n_files; ++i) {
+    free(blobs->files[i].path);
+    free(blobs->files[i].name);
+  }
+
+  memset(blobs->slots, 0, ((size_t)blobs->mask + 1U) * sizeof(uint32_t));
+  blobs->n_files = 0U;
+}
+
+/**
+   Compute a 64-bit FNV-1a hash of the contents of a file.
+
+   @return True on success.
+*/
+static inline bool
+lv2_state_blobs_hash(const LV2_State_Blobs* const blobs,
+                     const char* const            path,
+                     uint64_t* const              hash)
+{
+  void* const file = blobs->fs.open(blobs->fs.handle, path);
+  if (!file) {
+    return false;
+  }
+
+  uint8_t buf[LV2_STATE_BLOBS_CHUNK_SIZE];
+  size_t  n = 0U;
+
+  *hash = 0xCBF29CE484222325U;
+  while ((n = blobs->fs.read(blobs->fs.handle, file, buf, sizeof(buf)))) {
+    for (size_t i = 0U; i < n; ++i) {
+      *hash = (*hash ^ buf[i]) * 0x100000001B3U;
+    }
+  }
+
+  blobs->fs.close(blobs->fs.handle, file);
+  return true;
+}
+
+/**
+   Return true if two files have the same contents.
+
+   This is used to guard against hash collisions before sharing a blob.
+*/
+static inline bool
+lv2_state_blobs_equal(const LV2_State_Blobs* const blobs,
+                      const char* const            a_path,
+                      const char* const            b_path)
+{
+  void* const a = blobs->fs.open(blobs->fs.handle, a_path);
+  void* const b = a ? blobs->fs.open(blobs->fs.handle, b_path) : NULL;
+
+  uint8_t a_buf[LV2_STATE_BLOBS_CHUNK_SIZE];
+  uint8_t b_buf[LV2_STATE_BLOBS_CHUNK_SIZE];
+  bool    equal = a && b;
+  while (equal) {
+    const size_t a_n =
+      blobs->fs.read(blobs->fs.handle, a, a_buf, sizeof(a_buf));
+    const size_t b_n =
+      blobs->fs.read(blobs->fs.handle, b, b_buf, sizeof(b_buf));
+
+    equal = a_n == b_n && !memcmp(a_buf, b_buf, a_n);
+    if (!a_n) {
+      break;
+    }
+  }
+
+  if (b) {
+    blobs->fs.close(blobs->fs.handle, b);
+  }
+
+  if (a) {
+    blobs->fs.close(blobs->fs.handle, a);
+  }
+
+  return equal;
+}
+
+/**
+   Return a newly allocated blob name for a file.
+
+   The name only depends on the contents, not the name of the file, so that
+   files with the same contents are stored once regardless of their names.
+*/
+static inline char*
+lv2_state_blobs_name(const uint64_t hash, const uint64_t size)
+{
+  char      name[48];
+  const int len =
+    snprintf(name, sizeof(name), "%016" PRIx64 "-%" PRIu64, hash, size);
+
+  return (len > 0) ? lv2_state_blobs_strdup(name) : NULL;
+}
+
+/**
+   Return true if a string is a blob name made by lv2_state_blobs_name().
+
+   Only these are mapped to and from blobs, so that any other abstract path
+   is passed through unchanged.
+*/
+static inline bool
+lv2_state_blobs_is_name(const char* const name)
+{
+  size_t i = 0U;
+  for (; i < 16U; ++i) {
+    if (!((name[i] >= '0' && name[i] <= '9') ||
+          (name[i] >= 'a' && name[i] <= 'f'))) {
+      return false;
+    }
+  }
+
+  if (name[i] != '-' || name[i + 1U] < '0' || name[i + 1U] > '9') {
+    return false;
+  }
+
+  for (++i; name[i] >= '0' && name[i] <= '9'; ++i) {
+  }
+
+  return !name[i];
+}
+
+/**
+   Return the hash slot for a file path in the cache.
+
+   A slot holds a file index plus one.  The returned slot either has the
+   path, or is the empty slot where it would be added.
+*/
+static inline uint32_t*
+lv2_state_blobs_slot(const LV2_State_Blobs* const blobs, const char* const path)
+{
+  uint32_t hash = 2166136261U;
+  for (const char* c = path; *c; ++c) {
+    hash = (hash ^ (uint8_t)*c) * 16777619U;
+  }
+
+  // The table is never more than half full, so there is always an empty slot
+  for (uint32_t i = hash;; ++i) {
+    uint32_t* const slot = &blobs->slots[i & blobs->mask];
+    if (!*slot || !strcmp(blobs->files[*slot - 1U].path, path)) {
+      return slot;
+    }
+  }
+}
+
+/** Return the cached entry for a file, or NULL. */
+static inline LV2_State_Blobs_File*
+lv2_state_blobs_find(const LV2_State_Blobs* const blobs, const char* const path)
+{
+  const uint32_t* const slot = lv2_state_blobs_slot(blobs, path);
+
+  return *slot ? &blobs->files[*slot - 1U] : NULL;
+}
+
+/**
+   Store a file as a blob, or share an existing blob with the same contents.
+
+   @return The newly allocated name of the blob, or NULL on error.
+*/
+static inline char*
+lv2_state_blobs_store(LV2_State_Blobs* const blobs, const char* const path)
+{
+  uint64_t size  = 0U;
+  uint64_t mtime = 0U;
+  if (blobs->fs.stat(blobs->fs.handle, path, &size, &mtime)) {
+    return NULL;
+  }
+
+  // Use the cached blob if the file has not changed since it was hashed
+  LV2_State_Blobs_File* file = lv2_state_blobs_find(blobs, path);
+  if (file && file->size == size && file->mtime == mtime) {
+    return lv2_state_blobs_strdup(file->name);
+  }
+
+  uint64_t hash = 0U;
+  if (!lv2_state_blobs_hash(blobs, path, &hash)) {
+    return NULL;
+  }
+
+  ++blobs->n_hashed;
+
+  char* const name = lv2_state_blobs_name(hash, size);
+  char* const blob = name ? lv2_state_blobs_join(blobs->root, name) : NULL;
+  if (!blob) {
+    free(name);
+    return NULL;
+  }
+
+  uint64_t blob_size  = 0U;
+  uint64_t blob_mtime = 0U;
+  bool     stored     = false;
+  if (!blobs->fs.stat(blobs->fs.handle, blob, &blob_size, &blob_mtime)) {
+    stored = lv2_state_blobs_equal(blobs, path, blob);
+    blobs->n_shared += stored ? 1U : 0U;
+  } else {
+    stored = !blobs->fs.copy(blobs->fs.handle, path, blob);
+    blobs->n_stored += stored ? 1U : 0U;
+  }
+
+  free(blob);
+  if (!stored) {
+    free(name);
+    return NULL;
+  }
+
+  // Remember the blob of this file to avoid hashing it again
+  if (!file && blobs->n_files < blobs->max_files) {
+    char* const copy = lv2_state_blobs_strdup(path);
+    if (copy) {
+      file       = &blobs->files[blobs->n_files];
+      file->path = copy;
+      file->name = NULL;
+
+      *lv2_state_blobs_slot(blobs, path) = ++blobs->n_files;
+    }
+  }
+
+  if (file) {
+    char* const copy = lv2_state_blobs_strdup(name);
+    if (copy) {
+      free(file->name);
+      file->name  = copy;
+      file->size  = size;
+      file->mtime = mtime;
+    }
+  }
+
+  return name;
+}
+
+/**
+   @}
+   @name Features
+   @{
+*/
+
+/**
+   Return a path for a new file in the scratch directory of an instance.
+
+   This is the LV2_State_Make_Path::path() implementation, with an
+   LV2_State_Blobs_Instance as the handle.
+*/
+static inline char*
+lv2_state_blobs_make_path(LV2_State_Make_Path_Handle handle,
+                          const char* const          path)
+{
+  LV2_State_Blobs_Instance* const inst  = (LV2_State_Blobs_Instance*)handle;
+  LV2_State_Blobs* const          blobs = inst->blobs;
+
+  char* const dir  = lv2_state_blobs_join(blobs->scratch, inst->name);
+  char* const full = dir ? lv2_state_blobs_join(dir, path) : NULL;
+  free(dir);
+  if (!full) {
+    return NULL;
+  }
+
+  // Create leading directories
+  char* const last = strrchr(full, '/');
+  *last            = '\0';
+  const int st     = blobs->fs.make_dirs(blobs->fs.handle, full);
+  *last            = '/';
+  if (st) {
+    free(full);
+    return NULL;
+  }
+
+  return full;
+}
+
+/**
+   Map an absolute path to an abstract path.
+
+   This is the LV2_State_Map_Path::abstract_path() implementation, with an
+   LV2_State_Blobs_Instance as the handle.  Files in the scratch directory
+   are stored as blobs, and mapped to the blob name, as are existing blobs.
+   If that fails, or the path is anywhere else, it is mapped to itself.
+*/
+static inline char*
+lv2_state_blobs_abstract_path(LV2_State_Map_Path_Handle handle,
+                              const char* const         absolute_path)
+{
+  LV2_State_Blobs_Instance* const inst  = (LV2_State_Blobs_Instance*)handle;
+  LV2_State_Blobs* const          blobs = inst->blobs;
+
+  const char* const name = lv2_state_blobs_within(absolute_path, blobs->root);
+  if (name && lv2_state_blobs_is_name(name)) {
+    return lv2_state_blobs_strdup(name);
+  }
+
+  if (lv2_state_blobs_within(absolute_path, blobs->scratch)) {
+    char* const blob = lv2_state_blobs_store(blobs, absolute_path);
+    if (blob) {
+      return blob;
+    }
+  }
+
+  return lv2_state_blobs_strdup(absolute_path);
+}
+
+/**
+   Map an abstract path to an absolute path.
+
+   This is the LV2_State_Map_Path::absolute_path() implementation, with an
+   LV2_State_Blobs_Instance as the handle.  Blob names are mapped to the path
+   of the blob, and any other path, even a relative one, is mapped to itself.
+*/
+static inline char*
+lv2_state_blobs_absolute_path(LV2_State_Map_Path_Handle handle,
+                              const char* const         abstract_path)
+{
+  const LV2_State_Blobs_Instance* const inst =
+    (const LV2_State_Blobs_Instance*)handle;
+
+  return lv2_state_blobs_is_name(abstract_path)
+           ? lv2_state_blobs_join(inst->blobs->root, abstract_path)
+           : lv2_state_blobs_strdup(abstract_path);
+}
+
+/**
+   Free a path returned by another feature.
+
+   This is the LV2_State_Free_Path::free_path() implementation.
+*/
+static inline void
+lv2_state_blobs_free_path(LV2_State_Free_Path_Handle handle, char* const path)
+{
+  (void)handle;
+  free(path);
+}
+
+/**
+   Initialise the state path features of an instance.
+
+   @param inst Instance features to initialise.
+   @param blobs Blob store.
+   @param name Unique name of the instance, used as its scratch directory.
+*/
+static inline void
+lv2_state_blobs_instance_init(LV2_State_Blobs_Instance* const inst,
+                              LV2_State_Blobs* const          blobs,
+                              const char* const               name)
+{
+  inst->blobs                  = blobs;
+  inst->name                   = name;
+  inst->make_path.handle       = inst;
+  inst->make_path.path         = lv2_state_blobs_make_path;
+  inst->map_path.handle        = inst;
+  inst->map_path.abstract_path = lv2_state_blobs_abstract_path;
+  inst->map_path.absolute_path = lv2_state_blobs_absolute_path;
+  inst->free_path.handle       = inst;
+  inst->free_path.free_path    = lv2_state_blobs_free_path;
+}
+
+/**
+   @}
+*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_BLOBS_H
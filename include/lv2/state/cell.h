@@ -0,0 +1,175 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_CELL_H
+#define LV2_STATE_CELL_H
+
+/**
+   @file cell.h A cell for saving state that is modified in run().
+
+   LV2_State_Interface::save() may be called while run() is executing, so a
+   plugin that modifies its state in run() must save a consistent snapshot of
+   it without disturbing the audio thread.  Taking a lock in both is simple,
+   but may cause run() to miss its deadline whenever the host saves.
+
+   An LV2_State_Cell is a triple buffer which avoids this: run() edits a
+   private copy of the state, and publishes it with
+   lv2_state_cell_publish(), while save() reads the latest published copy
+   with lv2_state_cell_read().  Both are wait-free, neither ever copies more
+   than the state, and save() never sees a partially written state.  A plugin
+   typically:
+
+     - Keeps the parts of its state that run() modifies in a plain struct,
+       and calls lv2_state_cell_init() in instantiate() with storage for three
+       copies of it.
+
+     - In run(), modifies the struct returned by lv2_state_cell_edit(), and
+       calls lv2_state_cell_publish() at the end if it changed anything.
+
+     - In save(), stores the struct returned by lv2_state_cell_read().
+
+   Only one thread may edit and publish, and only one thread may read, at a
+   time.  The state must be plain data that can be copied with memcpy(), and
+   should be small, since publishing copies it in the audio thread.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_cell Cell
+   @ingroup state
+
+   A cell for saving state that is modified in run().
+
+   @{
+*/
+
+#include <lv2/core/atomic.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Flag set in LV2_State_Cell::middle when it has not been read yet.
+*/
+#define LV2_STATE_CELL_FRESH 4U
+
+/**
+   A triple-buffered state cell.
+
+   Each of the three copies is owned by the writer (the back copy), the
+   reader (the front copy), or neither (the middle copy).  Publishing swaps
+   the back and middle copies, and reading swaps the middle and front copies
+   if a newer one has been published.
+*/
+typedef struct {
+  uint8_t*          copies;  ///< Storage for three copies
+  size_t            size;    ///< Size of one copy in bytes
+  uint32_t          back;    ///< Index of the copy owned by the writer
+  uint32_t          front;   ///< Index of the copy owned by the reader
+  volatile uint32_t middle;  ///< Index of the middle copy, and fresh flag
+  volatile uint32_t version; ///< Number of times the cell was published
+} LV2_State_Cell;
+
+/**
+   Initialise a cell.
+
+   @param cell Cell to initialise.
+   @param copies Storage for three copies, at least `3 * size` bytes, which
+   should be aligned for the state.
+   @param size Size of the state in bytes.
+   @param initial Initial state, copied to every copy.
+*/
+static inline void
+lv2_state_cell_init(LV2_State_Cell* const cell,
+                    void* const           copies,
+                    const size_t          size,
+                    const void* const     initial)
+{
+  cell->copies  = (uint8_t*)copies;
+  cell->size    = size;
+  cell->back    = 0U;
+  cell->front   = 1U;
+  cell->middle  = 2U;
+  cell->version = 0U;
+
+  for (uint32_t i = 0U; i < 3U; ++i) {
+    memcpy(cell->copies + (i * size), initial, size);
+  }
+}
+
+/**
+   Return the copy of the state that the writer may modify.
+
+   This always contains the last published state, or the initial state.  It
+   is realtime safe, and may only be called by the writer.
+*/
+static inline void*
+lv2_state_cell_edit(LV2_State_Cell* const cell)
+{
+  return cell->copies + (cell->back * cell->size);
+}
+
+/**
+   Publish the state modified by the writer.
+
+   The modified copy becomes visible to the reader, and the writer continues
+   with a new copy of it.  This is wait-free and realtime safe, and may only
+   be called by the writer.
+*/
+static inline void
+lv2_state_cell_publish(LV2_State_Cell* const cell)
+{
+  const uint32_t published = cell->back;
+  const uint32_t previous =
+    lv2_atomic_exchange(&cell->middle, published | LV2_STATE_CELL_FRESH);
+
+  cell->back = previous & ~LV2_STATE_CELL_FRESH;
+  memcpy(cell->copies + (cell->back * cell->size),
+         cell->copies + (published * cell->size),
+         cell->size);
+
+  lv2_atomic_add(&cell->version, 1U);
+}
+
+/**
+   Return the latest published state.
+
+   The returned copy remains valid and unchanged until the next call.  This
+   is wait-free, and may only be called by the reader.
+
+   @param cell Cell to read.
+   @param version If not NULL, set to the number of times the cell had been
+   published, which can be compared to detect changes since a previous save.
+*/
+static inline const void*
+lv2_state_cell_read(LV2_State_Cell* const cell, uint32_t* const version)
+{
+  if (version) {
+    *version = lv2_atomic_load(&cell->version);
+  }
+
+  if (lv2_atomic_load(&cell->middle) & LV2_STATE_CELL_FRESH) {
+    cell->front = lv2_atomic_exchange(&cell->middle, cell->front) &
+                  ~LV2_STATE_CELL_FRESH;
+  }
+
+  return cell->copies + (cell->front * cell->size);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_CELL_H
@@ -0,0 +1,423 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_DELTA_H
+#define LV2_STATE_DELTA_H
+
+/**
+   @file delta.h Incremental state saving with the reference state store.
+
+   Hosts that save state periodically, for example for autosave, can use
+   these utilities so that the cost of a save depends on how much has changed,
+   rather than on the total size of the session:
+
+     - An LV2_State_Delta_Tracker per instance counts state:StateChanged
+       notifications from the plugin, and changes made by the host, so that
+       instances which have not changed are not saved at all.
+
+     - An LV2_State_Delta per instance remembers a hash of every property
+       saved last time.  When an instance is saved with an
+       LV2_State_Delta_Writer, only properties that have changed are written
+       to the container, along with the removal of any that were not saved
+       again.
+
+     - An LV2_State_Delta_Reader restores state from a full container and any
+       number of delta containers layered over it.
+
+   A host should occasionally save a full container, for example when the
+   session is saved explicitly, by resetting the delta with
+   lv2_state_delta_reset() first, so that the number of layers stays small.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_delta Delta
+   @ingroup state
+
+   Incremental state saving with the reference state store.
+
+   @{
+*/
+
+#include <lv2/atom/atom.h>
+#include <lv2/atom/util.h>
+#include <lv2/core/atomic.h>
+#include <lv2/state/state.h>
+#include <lv2/state/store.h>
+#include <lv2/urid/urid.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   A counter of changes to the state of an instance.
+*/
+typedef struct {
+  LV2_URID          atom_Object;        ///< URID of atom:Object
+  LV2_URID          state_StateChanged; ///< URID of state:StateChanged
+  volatile uint32_t changes;            ///< Number of changes
+  uint32_t          saved;              ///< Number of changes when saved
+} LV2_State_Delta_Tracker;
+
+/**
+   The hash of a property saved for an instance.
+*/
+typedef struct {
+  LV2_URID key;        ///< Key URID
+  uint32_t generation; ///< Generation of the last save that stored the key
+  uint64_t hash;       ///< Hash of the value, type, and flags
+} LV2_State_Delta_Entry;
+
+/**
+   The hashes of every property saved for an instance, sorted by key.
+*/
+typedef struct {
+  LV2_State_Delta_Entry* entries;     ///< Array of entries
+  uint32_t               n_entries;   ///< Number of entries
+  uint32_t               max_entries; ///< Capacity of `entries`
+  uint32_t               generation;  ///< Generation of the current save
+} LV2_State_Delta;
+
+/**
+   A writer that only stores properties which have changed.
+
+   The LV2_State_Delta_Writer is the handle for lv2_state_delta_store().
+*/
+typedef struct {
+  LV2_State_Delta*        delta;       ///< Hashes of the previous save
+  LV2_State_Store_Writer* writer;      ///< Writer for the container
+  uint32_t                n_changed;   ///< Number of changed properties
+  uint32_t                n_unchanged; ///< Number of unchanged properties
+} LV2_State_Delta_Writer;
+
+/**
+   A reader that serves values from layered containers.
+
+   The LV2_State_Delta_Reader is the handle for lv2_state_delta_retrieve().
+*/
+typedef struct {
+  LV2_State_Store_Reader* layers;   ///< Readers, oldest first
+  uint32_t                n_layers; ///< Number of readers
+} LV2_State_Delta_Reader;
+
+/**
+   @name Tracking
+   @{
+*/
+
+/**
+   Initialise a tracker for an instance.
+
+   A new tracker has one change, so the instance is saved at least once.
+*/
+static inline void
+lv2_state_delta_tracker_init(LV2_State_Delta_Tracker* const tracker,
+                             LV2_URID_Map* const            map)
+{
+  tracker->atom_Object = map->map(map->handle, LV2_ATOM__Object);
+  tracker->state_StateChanged =
+    map->map(map->handle, LV2_STATE__StateChanged);
+  tracker->changes = 1U;
+  tracker->saved   = 0U;
+}
+
+/**
+   Record a change to the state of an instance.
+
+   This is realtime safe, and may be called from any thread.  Hosts call this
+   when they change the state themselves, for example by sending a patch:Set
+   message, since plugins do not send notifications for such changes.
+*/
+static inline void
+lv2_state_delta_changed(LV2_State_Delta_Tracker* const tracker)
+{
+  lv2_atomic_add(&tracker->changes, 1U);
+}
+
+/**
+   Record any state:StateChanged notifications in a plugin's output.
+
+   This is realtime safe, and is typically called in the audio thread after
+   run() for every atom sequence output of the instance.
+*/
+static inline void
+lv2_state_delta_scan(LV2_State_Delta_Tracker* const tracker,
+                     const LV2_Atom_Sequence* const seq)
+{
+  LV2_ATOM_SEQUENCE_FOREACH (seq, ev) {
+    const LV2_Atom_Object* const obj = (const LV2_Atom_Object*)&ev->body;
+    if (obj->atom.type == tracker->atom_Object &&
+        obj->atom.size >= sizeof(LV2_Atom_Object_Body) &&
+        obj->body.otype == tracker->state_StateChanged) {
+      lv2_state_delta_changed(tracker);
+      return;
+    }
+  }
+}
+
+/**
+   Return true if an instance has changed since it was last saved.
+
+   @param tracker Tracker for the instance.
+   @param changes Set to the change count, to pass to lv2_state_delta_saved()
+   if the save succeeds.  Reading this before saving ensures that changes
+   made during the save are not missed.
+*/
+static inline bool
+lv2_state_delta_needs_save(const LV2_State_Delta_Tracker* const tracker,
+                           uint32_t* const                      changes)
+{
+  *changes = lv2_atomic_load(&tracker->changes);
+  return *changes != tracker->saved;
+}
+
+/**
+   Record that an instance has been saved successfully.
+*/
+static inline void
+lv2_state_delta_saved(LV2_State_Delta_Tracker* const tracker,
+                      const uint32_t                 changes)
+{
+  tracker->saved = changes;
+}
+
+/**
+   @}
+   @name Writing
+   @{
+*/
+
+/**
+   Return a 64-bit FNV-1a hash of a property value, type, and flags.
+*/
+static inline uint64_t
+lv2_state_delta_hash(const void* const value,
+                     const size_t      size,
+                     const uint32_t    type,
+                     const uint32_t    flags)
+{
+  const uint8_t* const bytes = (const uint8_t*)value;
+  const uint32_t       meta[] = {type, flags};
+  const uint8_t* const extra  = (const uint8_t*)meta;
+  uint64_t             hash   = 0xCBF29CE484222325U;
+
+  for (size_t i = 0U; i < sizeof(meta); ++i) {
+    hash = (hash ^ extra[i]) * 0x100000001B3U;
+  }
+
+  for (size_t i = 0U; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001B3U;
+  }
+
+  return hash;
+}
+
+/**
+   Initialise the property hashes of an instance.
+
+   @param delta Delta to initialise.
+   @param entries Array for at least as many entries as properties.  If it is
+   full, additional properties are always saved.
+   @param max_entries Capacity of `entries`.
+*/
+static inline void
+lv2_state_delta_init(LV2_State_Delta* const       delta,
+                     LV2_State_Delta_Entry* const entries,
+                     const uint32_t               max_entries)
+{
+  delta->entries     = entries;
+  delta->n_entries   = 0U;
+  delta->max_entries = max_entries;
+  delta->generation  = 0U;
+}
+
+/**
+   Forget all property hashes, so the next save writes a full container.
+
+   This must also be called if a save fails, since the hashes are updated as
+   properties are stored.
+*/
+static inline void
+lv2_state_delta_reset(LV2_State_Delta* const delta)
+{
+  delta->n_entries = 0U;
+}
+
+/**
+   Return the index of the first entry with a key not less than `key`.
+*/
+static inline uint32_t
+lv2_state_delta_lower_bound(const LV2_State_Delta* const delta,
+                            const LV2_URID               key)
+{
+  uint32_t lower = 0U;
+  uint32_t upper = delta->n_entries;
+  while (lower < upper) {
+    const uint32_t mid = lower + ((upper - lower) / 2U);
+    if (delta->entries[mid].key < key) {
+      lower = mid + 1U;
+    } else {
+      upper = mid;
+    }
+  }
+
+  return lower;
+}
+
+/**
+   Begin saving an instance.
+
+   @param writer Writer to initialise.
+   @param delta Hashes of the previous save of the instance.
+   @param store Initialised writer for the new container.
+*/
+static inline void
+lv2_state_delta_begin(LV2_State_Delta_Writer* const writer,
+                      LV2_State_Delta* const        delta,
+                      LV2_State_Store_Writer* const store)
+{
+  writer->delta       = delta;
+  writer->writer      = store;
+  writer->n_changed   = 0U;
+  writer->n_unchanged = 0U;
+  ++delta->generation;
+}
+
+/**
+   Store a property if it has changed since the previous save.
+
+   This is the LV2_State_Store_Function implementation, with an
+   LV2_State_Delta_Writer as the handle.  Properties with the same value,
+   type, and flags as in the previous save are not written.
+*/
+static inline LV2_State_Status
+lv2_state_delta_store(LV2_State_Handle  handle,
+                      const uint32_t    key,
+                      const void* const value,
+                      const size_t      size,
+                      const uint32_t    type,
+                      const uint32_t    flags)
+{
+  LV2_State_Delta_Writer* const writer = (LV2_State_Delta_Writer*)handle;
+  LV2_State_Delta* const        delta  = writer->delta;
+  const uint64_t hash  = lv2_state_delta_hash(value, size, type, flags);
+  const uint32_t index = lv2_state_delta_lower_bound(delta, key);
+
+  LV2_State_Delta_Entry* entry = &delta->entries[index];
+  if (index < delta->n_entries && entry->key == key && entry->hash == hash) {
+    entry->generation = delta->generation;
+    ++writer->n_unchanged;
+    return LV2_STATE_SUCCESS;
+  }
+
+  const LV2_State_Status st =
+    lv2_state_store_store(writer->writer, key, value, size, type, flags);
+  if (st) {
+    return st;
+  }
+
+  if (index == delta->n_entries || entry->key != key) {
+    if (delta->n_entries == delta->max_entries) {
+      ++writer->n_changed;
+      return LV2_STATE_SUCCESS; // Not tracked, so always saved
+    }
+
+    memmove(entry + 1,
+            entry,
+            (delta->n_entries - index) * sizeof(LV2_State_Delta_Entry));
+    ++delta->n_entries;
+    entry->key = key;
+  }
+
+  entry->generation = delta->generation;
+  entry->hash       = hash;
+  ++writer->n_changed;
+  return LV2_STATE_SUCCESS;
+}
+
+/**
+   Finish saving an instance.
+
+   Every property that was saved previously, but not in this save, is
+   recorded as removed in the container, which is then finished.
+
+   @return The total size of the container, or zero on error, in which case
+   the delta must be reset with lv2_state_delta_reset().
+*/
+static inline uint64_t
+lv2_state_delta_finish(LV2_State_Delta_Writer* const writer)
+{
+  LV2_State_Delta* const delta = writer->delta;
+  uint32_t               n     = 0U;
+
+  for (uint32_t i = 0U; i < delta->n_entries; ++i) {
+    const LV2_State_Delta_Entry* const entry = &delta->entries[i];
+    if (entry->generation == delta->generation) {
+      delta->entries[n++] = *entry;
+    } else if (lv2_state_store_remove(writer->writer, entry->key)) {
+      return 0U;
+    } else {
+      ++writer->n_changed;
+    }
+  }
+
+  delta->n_entries = n;
+  return lv2_state_store_writer_finish(writer->writer);
+}
+
+/**
+   @}
+   @name Reading
+   @{
+*/
+
+/**
+   Retrieve a property from layered containers.
+
+   This is the LV2_State_Retrieve_Function implementation, with an
+   LV2_State_Delta_Reader as the handle.  The value is taken from the newest
+   container that has an entry for the key, unless the property was removed
+   there.
+*/
+static inline const void*
+lv2_state_delta_retrieve(LV2_State_Handle handle,
+                         const uint32_t   key,
+                         size_t* const    size,
+                         uint32_t* const  type,
+                         uint32_t* const  flags)
+{
+  const LV2_State_Delta_Reader* const reader =
+    (const LV2_State_Delta_Reader*)handle;
+
+  for (uint32_t i = reader->n_layers; i > 0U; --i) {
+    LV2_State_Store_Reader* const layer = &reader->layers[i - 1U];
+    if (lv2_state_store_find(layer, key)) {
+      return lv2_state_store_retrieve(layer, key, size, type, flags);
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   @}
+*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_DELTA_H
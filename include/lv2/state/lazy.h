@@ -0,0 +1,338 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_LAZY_H
+#define LV2_STATE_LAZY_H
+
+/**
+   @file lazy.h On-demand retrieval of state from a container file.
+
+   LV2_State_Retrieve_Function is pull-based, so a plugin only receives the
+   properties it asks for, but a host that loads every container into memory
+   before calling restore() reads all values regardless, including old ones
+   the plugin no longer uses.  For sessions with large states, this costs
+   much more I/O and memory than necessary.
+
+   This reader avoids that for containers written by store.h.  Opening a
+   container reads only its header and the tables at the end, which index
+   every key by its offset in the file.  Values are then read from the file
+   only when they are retrieved, into a value cache provided by the host, and
+   compressed values are decompressed there.  A typical host restores an
+   instance from a file with:
+
+       LV2_State_Lazy_Reader reader;
+       lv2_state_lazy_open(&reader, lv2_state_lazy_stdio_read, file);
+
+       void*                  meta  = malloc(reader.meta_size);
+       LV2_URID*              urids = calloc(reader.header.n_uris, ...);
+       LV2_State_Store_Index* index = calloc(reader.header.n_entries, ...);
+       lv2_state_lazy_load(&reader, meta, map, urids, index);
+       lv2_state_lazy_set_cache(&reader, cache, cache_size);
+
+       iface->restore(instance, lv2_state_lazy_retrieve, &reader, 0, features);
+
+   The statistics in the reader show how much was actually read.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_lazy Lazy
+   @ingroup state
+
+   On-demand retrieval of state from a container file.
+
+   @{
+*/
+
+#include <lv2/state/state.h>
+#include <lv2/state/store.h>
+#include <lv2/urid/urid.h>
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   A function that reads from a container file.
+
+   @param handle Opaque host data.
+   @param offset Offset in the container to read from.
+   @param buf Buffer to read into.
+   @param size Number of bytes to read.
+   @return The number of bytes read, which is less than `size` on error.
+*/
+typedef size_t (*LV2_State_Lazy_Read)(void*    handle,
+                                      uint64_t offset,
+                                      void*    buf,
+                                      size_t   size);
+
+/**
+   A reader that reads values from a container only when retrieved.
+*/
+typedef struct {
+  LV2_State_Lazy_Read          read;       ///< Read function
+  void*                        handle;     ///< Handle for `read`
+  LV2_State_Store_Header       header;     ///< Copy of the container header
+  uint64_t                     meta_size;  ///< Size of the tables in bytes
+  const uint8_t*               meta;       ///< Tables, from header.uris
+  const LV2_State_Store_Entry* entries;    ///< Entry table in `meta`
+  const LV2_URID*              urids;      ///< URID of every URI index
+  const LV2_State_Store_Index* index;      ///< Entries sorted by key URID
+  uint8_t*                     cache;      ///< Values read from the file
+  uint64_t                     cache_size; ///< Size of `cache` in bytes
+  uint64_t                     cache_used; ///< Bytes used in `cache`
+  uint64_t                     n_bytes;    ///< Number of bytes read
+  uint32_t                     n_reads;    ///< Number of values read
+} LV2_State_Lazy_Reader;
+
+/**
+   Read from a stdio FILE.
+
+   This is an LV2_State_Lazy_Read implementation, with a FILE* as the handle.
+*/
+static inline size_t
+lv2_state_lazy_stdio_read(void* const    handle,
+                          const uint64_t offset,
+                          void* const    buf,
+                          const size_t   size)
+{
+  FILE* const file = (FILE*)handle;
+  if (offset > (uint64_t)LONG_MAX || fseek(file, (long)offset, SEEK_SET)) {
+    return 0U;
+  }
+
+  return fread(buf, 1U, size, file);
+}
+
+/**
+   Open a container by reading and checking its header.
+
+   On success, `reader->header` describes the container, and the host must
+   provide buffers for its tables to lv2_state_lazy_load(): `meta_size`
+   bytes for the tables, which must be 64-bit aligned, `header.n_uris` URIDs,
+   and `header.n_entries` index entries.
+
+   @param reader Reader to initialise.
+   @param read Function to read from the container.
+   @param handle Handle passed to `read`.
+   @return True on success, or false if the container is invalid.
+*/
+static inline bool
+lv2_state_lazy_open(LV2_State_Lazy_Reader* const reader,
+                    const LV2_State_Lazy_Read    read,
+                    void* const                  handle)
+{
+  LV2_State_Store_Header* const header = &reader->header;
+
+  memset(reader, 0, sizeof(LV2_State_Lazy_Reader));
+  reader->read   = read;
+  reader->handle = handle;
+  if (read(handle, 0U, header, sizeof(LV2_State_Store_Header)) !=
+      sizeof(LV2_State_Store_Header)) {
+    return false;
+  }
+
+  // The tables must follow the values, as written by store.h
+  if (memcmp(header->magic, LV2_STATE_STORE_MAGIC, 8U) || !header->version ||
+      header->version > LV2_STATE_STORE_VERSION ||
+      header->byte_order != LV2_STATE_STORE_BYTE_ORDER ||
+      header->uris < sizeof(LV2_State_Store_Header) ||
+      header->uris > header->entries || header->entries > header->size ||
+      (header->entries & 7U) || (header->uris & 7U) ||
+      (size_t)(header->size - header->uris) != header->size - header->uris ||
+      (uint64_t)header->n_entries * sizeof(LV2_State_Store_Entry) >
+        header->size - header->entries ||
+      (uint64_t)header->n_uris * sizeof(uint64_t) >
+        header->entries - header->uris) {
+    return false;
+  }
+
+  reader->meta_size = header->size - header->uris;
+  return true;
+}
+
+/**
+   Load the tables of an opened container, and map every URI.
+
+   The entries are checked so that a corrupt file can not cause reading
+   outside the buffers, and are indexed by key.
+
+   @param reader Reader opened with lv2_state_lazy_open().
+   @param meta Buffer of `reader->meta_size` bytes, which must be 64-bit
+   aligned.
+   @param map URID map feature.
+   @param urids Array of `reader->header.n_uris` URIDs.
+   @param index Array of `reader->header.n_entries` index entries.
+   @return LV2_STATE_SUCCESS, or LV2_STATE_ERR_UNKNOWN if the container is
+   invalid or mapping failed.
+*/
+static inline LV2_State_Status
+lv2_state_lazy_load(LV2_State_Lazy_Reader* const reader,
+                    void* const                  meta,
+                    LV2_URID_Map* const          map,
+                    LV2_URID* const              urids,
+                    LV2_State_Store_Index* const index)
+{
+  const LV2_State_Store_Header* const header = &reader->header;
+  const uint8_t* const                bytes  = (const uint8_t*)meta;
+  const uint64_t                      size   = reader->meta_size;
+
+  if (reader->read(reader->handle, header->uris, meta, (size_t)size) !=
+      size) {
+    return LV2_STATE_ERR_UNKNOWN;
+  }
+
+  reader->meta    = bytes;
+  reader->entries = (const LV2_State_Store_Entry*)(bytes + (header->entries -
+                                                            header->uris));
+  reader->n_bytes += size;
+
+  // Map every URI, checking that it is within the strings and terminated
+  for (uint32_t i = 0U; i < header->n_uris; ++i) {
+    uint64_t offset = 0U;
+    memcpy(&offset, bytes + (i * sizeof(uint64_t)), 8U);
+    if (offset < header->uris || offset >= header->entries ||
+        !memchr(bytes + (offset - header->uris),
+                0,
+                (size_t)(header->entries - offset)) ||
+        !(urids[i] = map->map(
+            map->handle, (const char*)bytes + (offset - header->uris)))) {
+      return LV2_STATE_ERR_UNKNOWN;
+    }
+  }
+
+  // Check that every value is within the values
+  for (uint32_t i = 0U; i < header->n_entries; ++i) {
+    const LV2_State_Store_Entry* const entry = &reader->entries[i];
+    if (entry->key >= header->n_uris || entry->type >= header->n_uris ||
+        entry->offset > header->uris ||
+        entry->size > header->uris - entry->offset || (entry->offset & 7U) ||
+        (size_t)entry->size != entry->size ||
+        ((entry->flags & LV2_STATE_STORE_COMPRESSED) &&
+         entry->size < sizeof(uint64_t))) {
+      return LV2_STATE_ERR_UNKNOWN;
+    }
+  }
+
+  lv2_state_store_sort(reader->entries, header->n_entries, urids, index);
+  reader->urids = urids;
+  reader->index = index;
+  return LV2_STATE_SUCCESS;
+}
+
+/**
+   Set the cache that values are read into.
+
+   Retrieved values remain valid until this is called again, so a host
+   typically sets the cache before every call to restore().  Without enough
+   space, values can not be retrieved.  A compressed value temporarily needs
+   space for both its compressed and uncompressed data.
+
+   @param reader Reader to set the cache of.
+   @param cache Buffer which should be 64-bit aligned.
+   @param size Size of `cache` in bytes.
+*/
+static inline void
+lv2_state_lazy_set_cache(LV2_State_Lazy_Reader* const reader,
+                         void* const                  cache,
+                         const uint64_t               size)
+{
+  reader->cache      = (uint8_t*)cache;
+  reader->cache_size = size;
+  reader->cache_used = 0U;
+}
+
+/**
+   Retrieve a property, reading it from the container.
+
+   This is the LV2_State_Retrieve_Function implementation, with an
+   LV2_State_Lazy_Reader as the handle.  The value is read into the cache
+   every time it is retrieved, and decompressed there if necessary.
+*/
+static inline const void*
+lv2_state_lazy_retrieve(LV2_State_Handle handle,
+                        const uint32_t   key,
+                        size_t* const    size,
+                        uint32_t* const  type,
+                        uint32_t* const  flags)
+{
+  LV2_State_Lazy_Reader* const reader = (LV2_State_Lazy_Reader*)handle;
+
+  const LV2_State_Store_Index* const item =
+    lv2_state_store_search(reader->index, reader->header.n_entries, key);
+
+  const LV2_State_Store_Entry* const entry =
+    item ? &reader->entries[item->entry] : NULL;
+  if (!entry || (entry->flags & LV2_STATE_STORE_REMOVED)) {
+    return NULL;
+  }
+
+  // Read the value, or the compressed value after space for decompressing it
+  const bool     compressed = (entry->flags & LV2_STATE_STORE_COMPRESSED);
+  uint8_t* const value      = reader->cache + reader->cache_used;
+  const uint64_t space      = reader->cache_size - reader->cache_used;
+  uint64_t       value_size = entry->size;
+  if (compressed) {
+    if (reader->read(reader->handle, entry->offset, &value_size, 8U) != 8U) {
+      return NULL;
+    }
+  }
+
+  const uint64_t padded = lv2_state_store_pad(value_size);
+  const uint64_t start  = compressed ? padded : 0U;
+  if (value_size > space || start > space || entry->size > space - start ||
+      reader->read(reader->handle,
+                   entry->offset,
+                   value + start,
+                   (size_t)entry->size) != entry->size) {
+    return NULL;
+  }
+
+  ++reader->n_reads;
+  reader->n_bytes += entry->size;
+  if (compressed && !lv2_state_store_decompress(value + start + 8U,
+                                                entry->size - 8U,
+                                                value,
+                                                value_size,
+                                                value_size,
+                                                NULL,
+                                                NULL)) {
+    return NULL;
+  }
+
+  reader->cache_used += (padded < space) ? padded : space;
+
+  if (size) {
+    *size = (size_t)value_size;
+  }
+
+  if (type) {
+    *type = reader->urids[entry->type];
+  }
+
+  if (flags) {
+    *flags = entry->flags & ~LV2_STATE_STORE_COMPRESSED;
+  }
+
+  return value;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_LAZY_H
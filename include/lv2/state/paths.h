@@ -0,0 +1,484 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_PATHS_H
+#define LV2_STATE_PATHS_H
+
+/**
+   @file paths.h A cached implementation of state:mapPath.
+
+   This is a host-side implementation of the state:mapPath,
+   state:borrowedMapPath, and state:freePath features, which maps paths
+   within a state directory to paths relative to it, and any other path to
+   itself.
+
+   Every mapped path is interned in a table provided by the host, along with
+   the path it maps to, so mapping the same path again only costs a hash
+   table lookup.  Each entry stores one string, since the abstract path of a
+   file in the state directory is the end of its absolute path.  Paths mapped
+   with state:borrowedMapPath are returned from the table directly, so a
+   plugin with thousands of file references can save and restore without
+   allocating any memory for paths.  Paths mapped with state:mapPath are
+   still copied, since the plugin frees them.
+
+   Interned paths remain valid until the table is reset, which a host
+   typically does when the state directory changes.  If the table is full,
+   state:mapPath falls back to mapping without the cache, and
+   state:borrowedMapPath returns NULL.
+
+   This implementation is not thread-safe, the host must not save or restore
+   several instances with the same LV2_State_Paths concurrently.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_paths Paths
+   @ingroup state
+
+   A cached implementation of state:mapPath.
+
+   @{
+*/
+
+#include <lv2/state/state.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   An interned pair of paths.
+*/
+typedef struct {
+  uint32_t absolute_hash; ///< Hash of the absolute path
+  uint32_t abstract_hash; ///< Hash of the abstract path
+  uint32_t absolute;      ///< Offset of the absolute path in the strings
+  uint32_t abstract;      ///< Offset of the abstract path in the strings
+} LV2_State_Paths_Entry;
+
+/**
+   A table of interned paths, and the features that use it.
+
+   The table has two hash indices, one for each direction, with entry
+   indices plus one in `2 * n_slots` slots.
+*/
+typedef struct {
+  const char*                 dir;               ///< State directory
+  size_t                      dir_len;           ///< Length of `dir`
+  LV2_State_Paths_Entry*      entries;           ///< Array of entries
+  uint32_t                    n_entries;         ///< Number of entries
+  uint32_t                    max_entries;       ///< Capacity of `entries`
+  uint32_t*                   slots;             ///< Hash indices
+  uint32_t                    n_slots;           ///< Size of one index
+  char*                       strings;           ///< String storage
+  uint32_t                    strings_size;      ///< Size of `strings`
+  uint32_t                    strings_used;      ///< Bytes used in `strings`
+  uint32_t                    n_hits;            ///< Paths found in the table
+  uint32_t                    n_misses;          ///< Paths not found
+  LV2_State_Map_Path          map_path;          ///< Data for state:mapPath
+  LV2_State_Borrowed_Map_Path borrowed_map_path; ///< state:borrowedMapPath
+  LV2_State_Free_Path         free_path;         ///< Data for state:freePath
+} LV2_State_Paths;
+
+/**
+   @name Utilities
+   @{
+*/
+
+/** Return the 32-bit FNV-1a hash of a string. */
+static inline uint32_t
+lv2_state_paths_hash(const char* const str)
+{
+  uint32_t hash = 2166136261U;
+  for (const char* s = str; *s; ++s) {
+    hash = (hash ^ (uint8_t)*s) * 16777619U;
+  }
+
+  return hash;
+}
+
+/** Return true if `c` is a path separator, on any platform. */
+static inline bool
+lv2_state_paths_is_separator(const char c)
+{
+  return c == '/' || c == '\\';
+}
+
+/** Return true if `path` is absolute, on any platform. */
+static inline bool
+lv2_state_paths_is_absolute(const char* const path)
+{
+  return lv2_state_paths_is_separator(path[0]) || (path[0] && path[1] == ':');
+}
+
+/**
+   Return the length of the prefix of `path` that is the state directory
+   followed by a separator, or zero if it is not within it.
+*/
+static inline size_t
+lv2_state_paths_prefix(const LV2_State_Paths* const paths,
+                       const char* const            path)
+{
+  const size_t len = paths->dir_len;
+  return (!strncmp(path, paths->dir, len) &&
+          lv2_state_paths_is_separator(path[len]) && path[len + 1U] &&
+          !lv2_state_paths_is_separator(path[len + 1U]))
+           ? len + 1U
+           : 0U;
+}
+
+/**
+   @}
+   @name Table
+   @{
+*/
+
+/**
+   Forget all interned paths, and set the state directory.
+
+   Every path previously returned by the table becomes invalid.
+*/
+static inline void
+lv2_state_paths_reset(LV2_State_Paths* const paths, const char* const dir)
+{
+  size_t len = strlen(dir);
+  while (len > 1U && lv2_state_paths_is_separator(dir[len - 1U])) {
+    --len;
+  }
+
+  paths->dir          = dir;
+  paths->dir_len      = len;
+  paths->n_entries    = 0U;
+  paths->strings_used = 0U;
+  paths->n_hits       = 0U;
+  paths->n_misses     = 0U;
+  memset(paths->slots, 0, 2U * paths->n_slots * sizeof(uint32_t));
+}
+
+/**
+   Return the entry for a path in one direction, or NULL.
+
+   @param paths Path table.
+   @param index Zero to search absolute paths, or one for abstract paths.
+   @param path Path to search for.
+   @param hash Hash of `path`.
+*/
+static inline const LV2_State_Paths_Entry*
+lv2_state_paths_find(const LV2_State_Paths* const paths,
+                     const uint32_t               index,
+                     const char* const            path,
+                     const uint32_t               hash)
+{
+  const uint32_t* const slots = paths->slots + (index * paths->n_slots);
+  const uint32_t        mask  = paths->n_slots - 1U;
+
+  for (uint32_t i = hash & mask; slots[i]; i = (i + 1U) & mask) {
+    const LV2_State_Paths_Entry* const entry = &paths->entries[slots[i] - 1U];
+
+    const uint32_t entry_hash =
+      index ? entry->abstract_hash : entry->absolute_hash;
+    const uint32_t offset = index ? entry->abstract : entry->absolute;
+    if (entry_hash == hash && !strcmp(paths->strings + offset, path)) {
+      return entry;
+    }
+  }
+
+  return NULL;
+}
+
+/** Add an entry to the hash index for one direction. */
+static inline void
+lv2_state_paths_index(LV2_State_Paths* const paths,
+                      const uint32_t         index,
+                      const uint32_t         hash,
+                      const uint32_t         entry)
+{
+  uint32_t* const slots = paths->slots + (index * paths->n_slots);
+  const uint32_t  mask  = paths->n_slots - 1U;
+
+  uint32_t i = hash & mask;
+  while (slots[i]) {
+    i = (i + 1U) & mask;
+  }
+
+  slots[i] = entry + 1U;
+}
+
+/**
+   Intern a path and the path it maps to.
+
+   @param paths Path table.
+   @param path Absolute path, or abstract path relative to the directory.
+   @param relative True if `path` is relative to the state directory.
+   @return The new entry, or NULL if the table is full.
+*/
+static inline const LV2_State_Paths_Entry*
+lv2_state_paths_insert(LV2_State_Paths* const paths,
+                       const char* const      path,
+                       const bool             relative)
+{
+  const size_t head_len = relative ? paths->dir_len + 1U : 0U;
+  const size_t path_len = strlen(path);
+  const size_t size     = head_len + path_len + 1U;
+  if (paths->n_entries >= paths->max_entries ||
+      size > paths->strings_size - paths->strings_used) {
+    return NULL;
+  }
+
+  // Store the absolute path, which ends with the abstract path
+  char* const str = paths->strings + paths->strings_used;
+  if (relative) {
+    memcpy(str, paths->dir, paths->dir_len);
+    str[paths->dir_len] = '/';
+  }
+
+  memcpy(str + head_len, path, path_len + 1U);
+
+  const size_t prefix_len =
+    relative ? head_len : lv2_state_paths_prefix(paths, str);
+
+  LV2_State_Paths_Entry* const entry = &paths->entries[paths->n_entries];
+  entry->absolute_hash = lv2_state_paths_hash(str);
+  entry->abstract_hash = lv2_state_paths_hash(str + prefix_len);
+  entry->absolute      = paths->strings_used;
+  entry->abstract      = paths->strings_used + (uint32_t)prefix_len;
+
+  lv2_state_paths_index(paths, 0U, entry->absolute_hash, paths->n_entries);
+  lv2_state_paths_index(paths, 1U, entry->abstract_hash, paths->n_entries);
+  paths->strings_used += (uint32_t)size;
+  ++paths->n_entries;
+  return entry;
+}
+
+/**
+   Return the entry for a path, interning it if necessary.
+
+   @param paths Path table.
+   @param path Path to look up.
+   @param index Zero if `path` is absolute, or one if it is abstract.
+   @return The entry for `path`, or NULL if the table is full.
+*/
+static inline const LV2_State_Paths_Entry*
+lv2_state_paths_lookup(LV2_State_Paths* const paths,
+                       const char* const      path,
+                       const uint32_t         index)
+{
+  // Abstract paths of files outside the directory are absolute
+  const uint32_t relative = index && !lv2_state_paths_is_absolute(path);
+  const uint32_t hash     = lv2_state_paths_hash(path);
+
+  const LV2_State_Paths_Entry* const entry =
+    lv2_state_paths_find(paths, relative, path, hash);
+
+  if (entry) {
+    ++paths->n_hits;
+    return entry;
+  }
+
+  ++paths->n_misses;
+  return lv2_state_paths_insert(paths, path, relative);
+}
+
+/**
+   Return the interned abstract path of an absolute path.
+
+   @return A path owned by the table, or NULL if the table is full.
+*/
+static inline const char*
+lv2_state_paths_abstract(LV2_State_Paths* const paths,
+                         const char* const      absolute_path)
+{
+  const LV2_State_Paths_Entry* const entry =
+    lv2_state_paths_lookup(paths, absolute_path, 0U);
+
+  return entry ? paths->strings + entry->abstract : NULL;
+}
+
+/**
+   Return the interned absolute path of an abstract path.
+
+   @return A path owned by the table, or NULL if the table is full.
+*/
+static inline const char*
+lv2_state_paths_absolute(LV2_State_Paths* const paths,
+                         const char* const      abstract_path)
+{
+  const LV2_State_Paths_Entry* const entry =
+    lv2_state_paths_lookup(paths, abstract_path, 1U);
+
+  return entry ? paths->strings + entry->absolute : NULL;
+}
+
+/**
+   @}
+   @name Features
+   @{
+*/
+
+/**
+   Return a newly allocated path of `path` within the state directory, or a
+   copy of `path` if `prefix` is false.
+*/
+static inline char*
+lv2_state_paths_copy(const LV2_State_Paths* const paths,
+                     const bool                   prefix,
+                     const char* const            path)
+{
+  const size_t head_len = prefix ? paths->dir_len + 1U : 0U;
+  const size_t path_len = strlen(path);
+  char* const  copy     = (char*)malloc(head_len + path_len + 1U);
+  if (copy) {
+    if (prefix) {
+      memcpy(copy, paths->dir, paths->dir_len);
+      copy[paths->dir_len] = '/';
+    }
+
+    memcpy(copy + head_len, path, path_len + 1U);
+  }
+
+  return copy;
+}
+
+/**
+   Map an absolute path to an abstract path.
+
+   This is the LV2_State_Map_Path::abstract_path() implementation, with an
+   LV2_State_Paths as the handle.  If the table is full, the path is mapped
+   without it.
+*/
+static inline char*
+lv2_state_paths_abstract_path(LV2_State_Map_Path_Handle handle,
+                              const char* const         absolute_path)
+{
+  LV2_State_Paths* const paths = (LV2_State_Paths*)handle;
+
+  const char* const abstract = lv2_state_paths_abstract(paths, absolute_path);
+  if (abstract) {
+    return lv2_state_paths_copy(paths, false, abstract);
+  }
+
+  const size_t prefix = lv2_state_paths_prefix(paths, absolute_path);
+  return lv2_state_paths_copy(paths, false, absolute_path + prefix);
+}
+
+/**
+   Map an abstract path to an absolute path.
+
+   This is the LV2_State_Map_Path::absolute_path() implementation, with an
+   LV2_State_Paths as the handle.  If the table is full, the path is mapped
+   without it.
+*/
+static inline char*
+lv2_state_paths_absolute_path(LV2_State_Map_Path_Handle handle,
+                              const char* const         abstract_path)
+{
+  LV2_State_Paths* const paths = (LV2_State_Paths*)handle;
+
+  const char* const absolute = lv2_state_paths_absolute(paths, abstract_path);
+  if (absolute) {
+    return lv2_state_paths_copy(paths, false, absolute);
+  }
+
+  return lv2_state_paths_copy(
+    paths, !lv2_state_paths_is_absolute(abstract_path), abstract_path);
+}
+
+/**
+   Map an absolute path to a borrowed abstract path.
+
+   This is the LV2_State_Borrowed_Map_Path::abstract_path() implementation,
+   with an LV2_State_Paths as the handle.
+*/
+static inline const char*
+lv2_state_paths_borrow_abstract_path(LV2_State_Map_Path_Handle handle,
+                                     const char* const         absolute_path)
+{
+  return lv2_state_paths_abstract((LV2_State_Paths*)handle, absolute_path);
+}
+
+/**
+   Map an abstract path to a borrowed absolute path.
+
+   This is the LV2_State_Borrowed_Map_Path::absolute_path() implementation,
+   with an LV2_State_Paths as the handle.
+*/
+static inline const char*
+lv2_state_paths_borrow_absolute_path(LV2_State_Map_Path_Handle handle,
+                                     const char* const         abstract_path)
+{
+  return lv2_state_paths_absolute((LV2_State_Paths*)handle, abstract_path);
+}
+
+/**
+   Free a path returned by state:mapPath.
+
+   This is the LV2_State_Free_Path::free_path() implementation.
+*/
+static inline void
+lv2_state_paths_free_path(LV2_State_Free_Path_Handle handle, char* const path)
+{
+  (void)handle;
+  free(path);
+}
+
+/**
+   Initialise a path table and its features.
+
+   @param paths Path table to initialise.
+   @param dir State directory, which may have a trailing separator.
+   @param entries Array for interned paths.
+   @param max_entries Capacity of `entries`.
+   @param slots Array of `2 * n_slots` hash index slots.
+   @param n_slots Number of slots in each index, a power of two which must be
+   greater than `max_entries`, and ideally at least twice as large.
+   @param strings Storage for interned strings.
+   @param strings_size Size of `strings` in bytes.
+*/
+static inline void
+lv2_state_paths_init(LV2_State_Paths* const       paths,
+                     const char* const            dir,
+                     LV2_State_Paths_Entry* const entries,
+                     const uint32_t               max_entries,
+                     uint32_t* const              slots,
+                     const uint32_t               n_slots,
+                     char* const                  strings,
+                     const uint32_t               strings_size)
+{
+  paths->entries      = entries;
+  paths->max_entries  = max_entries;
+  paths->slots        = slots;
+  paths->n_slots      = n_slots;
+  paths->strings      = strings;
+  paths->strings_size = strings_size;
+  lv2_state_paths_reset(paths, dir);
+
+  paths->map_path.handle         = paths;
+  paths->map_path.abstract_path  = lv2_state_paths_abstract_path;
+  paths->map_path.absolute_path  = lv2_state_paths_absolute_path;
+  paths->free_path.handle        = paths;
+  paths->free_path.free_path     = lv2_state_paths_free_path;
+  paths->borrowed_map_path.handle = paths;
+  paths->borrowed_map_path.abstract_path =
+    lv2_state_paths_borrow_abstract_path;
+  paths->borrowed_map_path.absolute_path =
+    lv2_state_paths_borrow_absolute_path;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_PATHS_H
@@ -0,0 +1,335 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_RESTORE_H
+#define LV2_STATE_RESTORE_H
+
+/**
+   @file restore.h A scheduler for restoring the state of many instances.
+
+   When a session is loaded, restoring every instance one after another with
+   audio processing suspended can take a long time, since restore() often
+   loads samples or other large files.  Instances of plugins that support
+   state:threadSafeRestore may be restored concurrently with audio
+   processing, and complete their restore in work(), so this scheduler
+   restores them in threads of an LV2_Worker_Pool while audio keeps running,
+   and only the remaining instances need audio to be suspended.
+
+   The threading classes of lv2core apply per instance, so restore() may be
+   called for different instances at once, like run().  Every job is claimed
+   by a single thread, so restore() is never called twice at once for the
+   same instance.  Thread-safe instances are restored in parallel by any
+   number of pool threads.  The scheduler only holds a token while restoring
+   instances that are not thread-safe, so that they are restored one at a
+   time, in order, while their audio processing is suspended.
+
+   The host owns all threads and memory.  To restore a session, a typical
+   host:
+
+     - Fills an array of LV2_State_Restore_Job, one per instance, and calls
+       lv2_state_restore_init().  For instances that support
+       state:threadSafeRestore, the features of the job include the
+       work:schedule feature of the instance's worker pool slot.
+
+     - Calls lv2_state_restore_start(), which notifies the pool.  Each pool
+       thread calls lv2_state_restore_run_one() until it returns false, as
+       well as lv2_worker_pool_run_one(), since thread-safe instances
+       complete their restore in their worker.
+
+     - Calls lv2_state_restore_run_serial() in the thread that usually calls
+       restore(), with audio processing of the affected instances suspended,
+       then helps with lv2_state_restore_run_one(), and finally waits until
+       lv2_state_restore_is_done() returns true.
+
+   If the pool has a clock, every job records when it was queued, started,
+   and finished, and lv2_state_restore_summarize() can be used to see where
+   the time to restore a session was spent.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_restore Restore
+   @ingroup state
+
+   A scheduler for restoring the state of many instances.
+
+   @{
+*/
+
+#include <lv2/core/atomic.h>
+#include <lv2/core/lv2.h>
+#include <lv2/state/state.h>
+#include <lv2/worker/pool.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The restoration of a single instance.
+
+   The host sets the fields up to `thread_safe`, and the scheduler sets the
+   rest when the job is executed.
+*/
+typedef struct {
+  LV2_Handle                  instance;    ///< Plugin instance
+  const LV2_State_Interface*  iface;       ///< State interface of `instance`
+  LV2_State_Retrieve_Function retrieve;    ///< Retrieve function
+  LV2_State_Handle            handle;      ///< Handle for `retrieve`
+  uint32_t                    flags;       ///< LV2_State_Flags for restore()
+  const LV2_Feature* const*   features;    ///< Features for restore()
+  bool                        thread_safe; ///< Supports threadSafeRestore
+  LV2_State_Status            status;      ///< Status returned by restore()
+  uint32_t                    thread;      ///< Index of the executing thread
+  uint64_t                    queued;      ///< Time the job was started
+  uint64_t                    started;     ///< Time restore() was called
+  uint64_t                    finished;    ///< Time restore() returned
+} LV2_State_Restore_Job;
+
+/**
+   A scheduler for a set of restore jobs.
+*/
+typedef struct {
+  LV2_State_Restore_Job* jobs;        ///< Array of jobs
+  uint32_t               n_jobs;      ///< Number of jobs
+  LV2_Worker_Pool*       pool;        ///< Pool for notification and clock
+  volatile uint32_t      cursor;      ///< Next job to claim for background
+  volatile uint32_t      n_done;      ///< Number of finished jobs
+  volatile uint32_t      token;       ///< Non-zero while restoring serially
+  uint32_t               next_serial; ///< Next job to consider for serial
+} LV2_State_Restore_Scheduler;
+
+/**
+   A summary of where the time to restore a set of instances was spent.
+
+   All times are in the unit of the pool's clock.
+*/
+typedef struct {
+  uint32_t n_background;    ///< Instances restored while audio runs
+  uint32_t n_serial;        ///< Instances restored with audio suspended
+  uint32_t n_failed;        ///< Instances that failed to restore
+  uint32_t slowest;         ///< Index of the job with the longest restore()
+  uint64_t background_time; ///< Total time in restore() of background jobs
+  uint64_t serial_time;     ///< Total time in restore() of serial jobs
+  uint64_t max_wait;        ///< Longest time from start until restore()
+  uint64_t elapsed;         ///< Time from start until the last job finished
+} LV2_State_Restore_Summary;
+
+/**
+   Initialise a scheduler.
+
+   @param sched Scheduler to initialise.
+   @param jobs Array of jobs, with the host fields set.
+   @param n_jobs Number of jobs.
+   @param pool Pool whose threads execute background jobs, or NULL.
+*/
+static inline void
+lv2_state_restore_init(LV2_State_Restore_Scheduler* const sched,
+                       LV2_State_Restore_Job* const       jobs,
+                       const uint32_t                     n_jobs,
+                       LV2_Worker_Pool* const             pool)
+{
+  sched->jobs        = jobs;
+  sched->n_jobs      = n_jobs;
+  sched->pool        = pool;
+  sched->cursor      = n_jobs;
+  sched->n_done      = 0U;
+  sched->token       = 0U;
+  sched->next_serial = 0U;
+}
+
+/**
+   Start restoring, and notify the pool if there are background jobs.
+
+   This must be called once, before any other thread uses the scheduler.
+   The pool is notified once for every background job, so that as many
+   threads as there are jobs can restore at once.
+*/
+static inline void
+lv2_state_restore_start(LV2_State_Restore_Scheduler* const sched)
+{
+  const uint64_t now = lv2_worker_pool_now(sched->pool);
+
+  uint32_t n_background = 0U;
+  for (uint32_t i = 0U; i < sched->n_jobs; ++i) {
+    LV2_State_Restore_Job* const job = &sched->jobs[i];
+
+    job->status   = LV2_STATE_SUCCESS;
+    job->thread   = 0U;
+    job->queued   = now;
+    job->started  = 0U;
+    job->finished = 0U;
+    n_background += job->thread_safe ? 1U : 0U;
+  }
+
+  lv2_atomic_store(&sched->cursor, 0U);
+
+  if (sched->pool && sched->pool->notify) {
+    for (uint32_t i = 0U; i < n_background; ++i) {
+      sched->pool->notify(sched->pool->notify_handle);
+    }
+  }
+}
+
+/**
+   Call restore() for a job in the calling thread.
+
+   The calling thread must have claimed the job, and hold the token of the
+   scheduler if the instance is not thread-safe.
+*/
+static inline void
+lv2_state_restore_execute(LV2_State_Restore_Scheduler* const sched,
+                          LV2_State_Restore_Job* const       job,
+                          const uint32_t                     thread)
+{
+  job->thread  = thread;
+  job->started = lv2_worker_pool_now(sched->pool);
+  job->status  = job->iface->restore(
+    job->instance, job->retrieve, job->handle, job->flags, job->features);
+
+  job->finished = lv2_worker_pool_now(sched->pool);
+  lv2_atomic_add(&sched->n_done, 1U);
+}
+
+/**
+   Restore at most one instance that supports thread-safe restore.
+
+   This may be called concurrently from any number of threads, which each
+   claim a different job, so instances are restored in parallel.
+
+   @param sched Scheduler to execute a job from.
+   @param thread Index of the calling thread, recorded in the job.
+   @return True if a job was executed, false if none were available.
+*/
+static inline bool
+lv2_state_restore_run_one(LV2_State_Restore_Scheduler* const sched,
+                          const uint32_t                     thread)
+{
+  if (lv2_atomic_load(&sched->cursor) >= sched->n_jobs) {
+    return false;
+  }
+
+  uint32_t index = 0U;
+  while ((index = lv2_atomic_add(&sched->cursor, 1U)) < sched->n_jobs) {
+    LV2_State_Restore_Job* const job = &sched->jobs[index];
+    if (job->thread_safe) {
+      lv2_state_restore_execute(sched, job, thread);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+   Restore every instance that does not support thread-safe restore.
+
+   The audio processing of these instances must be suspended meanwhile.
+   Instances are restored one at a time, in the order of the jobs, by the
+   thread that holds the token of the scheduler.  This may be called from
+   several threads, which then take turns, so it spins and is not realtime
+   safe.  Thread-safe instances are restored in parallel meanwhile.
+
+   @param sched Scheduler to execute jobs from.
+   @param thread Index of the calling thread, recorded in the jobs.
+   @return The number of jobs executed.
+*/
+static inline uint32_t
+lv2_state_restore_run_serial(LV2_State_Restore_Scheduler* const sched,
+                             const uint32_t                     thread)
+{
+  uint32_t n = 0U;
+  for (;;) {
+    while (!lv2_atomic_cas(&sched->token, 0U, 1U)) {
+      lv2_atomic_pause();
+    }
+
+    // Claim the next serial job while holding the token
+    LV2_State_Restore_Job* job = NULL;
+    for (; !job && sched->next_serial < sched->n_jobs; ++sched->next_serial) {
+      if (!sched->jobs[sched->next_serial].thread_safe) {
+        job = &sched->jobs[sched->next_serial];
+      }
+    }
+
+    if (!job) {
+      lv2_atomic_store(&sched->token, 0U);
+      return n;
+    }
+
+    lv2_state_restore_execute(sched, job, thread);
+    lv2_atomic_store(&sched->token, 0U);
+    ++n;
+  }
+}
+
+/**
+   Return true if every job has finished.
+
+   After this returns true, the results of all jobs may be read.
+*/
+static inline bool
+lv2_state_restore_is_done(const LV2_State_Restore_Scheduler* const sched)
+{
+  return lv2_atomic_load(&sched->n_done) == sched->n_jobs;
+}
+
+/**
+   Summarize the time spent restoring once every job has finished.
+*/
+static inline void
+lv2_state_restore_summarize(const LV2_State_Restore_Scheduler* const sched,
+                            LV2_State_Restore_Summary* const         summary)
+{
+  LV2_State_Restore_Summary s = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
+  uint64_t                  slowest = 0U;
+
+  for (uint32_t i = 0U; i < sched->n_jobs; ++i) {
+    const LV2_State_Restore_Job* const job = &sched->jobs[i];
+
+    const uint64_t wait = job->started - job->queued;
+    const uint64_t time = job->finished - job->started;
+    if (job->thread_safe) {
+      ++s.n_background;
+      s.background_time += time;
+    } else {
+      ++s.n_serial;
+      s.serial_time += time;
+    }
+
+    if (job->status) {
+      ++s.n_failed;
+    }
+
+    if (time > slowest) {
+      slowest   = time;
+      s.slowest = i;
+    }
+
+    if (wait > s.max_wait) {
+      s.max_wait = wait;
+    }
+
+    if (job->finished - job->queued > s.elapsed) {
+      s.elapsed = job->finished - job->queued;
+    }
+  }
+
+  *summary = s;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_RESTORE_H
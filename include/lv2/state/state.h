@@ -1,4 +1,4 @@
-// Copyright 2010-2016 David Robillard <d@drobilla.net>
+// Copyright 2010-2026 David Robillard <d@drobilla.net>
 // Copyright 2010 Leonard Ritter <paniq@paniq.org>
 // SPDX-License-Identifier: ISC
 
@@ -27,6 +27,7 @@
 #define LV2_STATE_PREFIX LV2_STATE_URI "#"                 ///< http://lv2plug.in/ns/ext/state#
 
 #define LV2_STATE__State             LV2_STATE_PREFIX "State"              ///< http://lv2plug.in/ns/ext/state#State
+#define LV2_STATE__borrowedMapPath   LV2_STATE_PREFIX "borrowedMapPath"    ///< http://lv2plug.in/ns/ext/state#borrowedMapPath
 #define LV2_STATE__interface         LV2_STATE_PREFIX "interface"          ///< http://lv2plug.in/ns/ext/state#interface
 #define LV2_STATE__loadDefaultState  LV2_STATE_PREFIX "loadDefaultState"   ///< http://lv2plug.in/ns/ext/state#loadDefaultState
 #define LV2_STATE__freePath          LV2_STATE_PREFIX "freePath"           ///< http://lv2plug.in/ns/ext/state#freePath
@@ -310,6 +311,51 @@ typedef struct {
                          const char*               abstract_path);
 } LV2_State_Map_Path;
 
+/**
+   Feature data for state:borrowedMapPath (@ref LV2_STATE__borrowedMapPath).
+
+   This is like LV2_State_Map_Path, except the returned paths are owned by
+   the host, so mapping a path does not allocate memory for the plugin to
+   free.  A host that provides this feature MUST also provide state:mapPath.
+*/
+typedef struct {
+  /**
+     Opaque host data.
+  */
+  LV2_State_Map_Path_Handle handle;
+
+  /**
+     Map an absolute path to an abstract path for use in plugin state.
+     @param handle MUST be the `handle` member of this struct.
+     @param absolute_path The absolute path of a file.
+     @return An abstract path suitable for use in plugin state, or NULL if
+     the host can not map the path without allocating, in which case the
+     plugin may use LV2_State_Map_Path.abstract_path() instead.
+
+     This is equivalent to LV2_State_Map_Path.abstract_path(), except the
+     returned string is owned by the host and MUST NOT be freed or modified
+     by the plugin.  It remains valid until the function that this feature
+     was passed to returns, or if it was passed to
+     LV2_Descriptor.instantiate(), until the instance is cleaned up.
+  */
+  const char* (*abstract_path)(LV2_State_Map_Path_Handle handle,
+                               const char*               absolute_path);
+
+  /**
+     Map an abstract path from plugin state to an absolute path.
+     @param handle MUST be the `handle` member of this struct.
+     @param abstract_path An abstract path (typically from plugin state).
+     @return An absolute file system path, or NULL if the host can not map
+     the path without allocating, in which case the plugin may use
+     LV2_State_Map_Path.absolute_path() instead.
+
+     This is equivalent to LV2_State_Map_Path.absolute_path(), and the
+     returned string is owned by the host as described for abstract_path().
+  */
+  const char* (*absolute_path)(LV2_State_Map_Path_Handle handle,
+                               const char*               abstract_path);
+} LV2_State_Borrowed_Map_Path;
+
 /**
    Feature data for state:makePath (@ref LV2_STATE__makePath).
 */
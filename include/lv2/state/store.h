@@ -0,0 +1,1594 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_STORE_H
+#define LV2_STATE_STORE_H
+
+/**
+   @file store.h A reference binary store for plugin state.
+
+   This is a host-side implementation of LV2_State_Store_Function and
+   LV2_State_Retrieve_Function that saves state in a compact binary container.
+   Writing a container appends each value once to a host-provided buffer, and
+   reading one does not copy or parse any values, so a container in a file can
+   be mapped into memory and values passed to restore() by pointer.
+
+   A container is laid out as a header, the values, a URI table, the URI
+   strings, and an entry table.  Every value is aligned to 64 bits, so values
+   are suitably aligned if the container is.  Keys and types are stored as
+   indices into the URI table, which are mapped to URIDs when the container is
+   opened, so containers remain valid across runs.  Numbers are stored in
+   native byte order, so a container is only read on machines with the same
+   byte order, and lv2_state_store_write_turtle() can be used to export state
+   portably.
+
+   Only values with LV2_STATE_IS_POD are stored, since the store can not
+   understand the meaning of any type.  A typical host saves an instance with:
+
+       uint32_t* slots = calloc(lv2_state_store_n_slots(max_entries, max_uris),
+                                sizeof(uint32_t));
+
+       LV2_State_Store_Writer writer;
+       lv2_state_store_writer_init(&writer, buf, buf_size,
+                                   entries, max_entries,
+                                   uris, max_uris, slots, unmap);
+
+       iface->save(instance, lv2_state_store_store, &writer, flags, features);
+
+       const uint64_t size = lv2_state_store_writer_finish(&writer);
+
+   Then later restores it, for example from a memory-mapped file, with:
+
+       const LV2_State_Store_Header* header = lv2_state_store_check(data, size);
+
+       LV2_URID*              urids = calloc(header->n_uris, ...);
+       LV2_State_Store_Index* index = calloc(header->n_entries, ...);
+
+       LV2_State_Store_Reader reader;
+       lv2_state_store_reader_init(&reader, header, map, urids, index);
+
+       iface->restore(instance, lv2_state_store_retrieve, &reader, 0, features);
+
+   Large values can optionally be compressed, by setting a threshold with
+   lv2_state_store_writer_set_compression().  Values at least that large are
+   compressed with a simple LZ77 codec if that makes them smaller, which is
+   fast and works well for tables and other repetitive data.  Compressed
+   values are only decompressed the first time they are retrieved, into
+   scratch memory set with lv2_state_store_reader_set_scratch(), so plugins
+   see no difference.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_store Store
+   @ingroup state
+
+   A reference binary store for plugin state.
+
+   @{
+*/
+
+#include <lv2/atom/atom.h>
+#include <lv2/state/state.h>
+#include <lv2/urid/urid.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The magic bytes at the start of every container. */
+#define LV2_STATE_STORE_MAGIC "LV2State"
+
+/**
+   The version of the container format.
+
+   Version 2 added compressed values, so it can read version 1 containers.
+*/
+#define LV2_STATE_STORE_VERSION 2U
+
+/** The byte order mark, which is written in native byte order. */
+#define LV2_STATE_STORE_BYTE_ORDER 0x01020304U
+
+/**
+   Entry flag for a property that has been removed.
+
+   This is used in containers that only store changes to an earlier one, see
+   lv2_state_store_remove().
+*/
+#define LV2_STATE_STORE_REMOVED (1U << 31U)
+
+/**
+   Entry flag for a compressed value.
+
+   A compressed value starts with its 64-bit uncompressed size, followed by
+   the compressed data as described for lv2_state_store_compress().
+*/
+#define LV2_STATE_STORE_COMPRESSED (1U << 30U)
+
+/**
+   The maximum distance of a match in compressed data.
+*/
+#define LV2_STATE_STORE_MAX_OFFSET 65535U
+
+/**
+   The size of the window used to decompress values while writing Turtle.
+
+   This is larger than LV2_STATE_STORE_MAX_OFFSET, and a multiple of 3 so that
+   each full window can be written as base64 separately.
+*/
+#define LV2_STATE_STORE_WINDOW_SIZE 65538U
+
+/**
+   The number of bits of the hash table used for compression.
+*/
+#define LV2_STATE_STORE_HASH_BITS 12U
+
+/**
+   The number of elements in the hash table used for compression.
+*/
+#define LV2_STATE_STORE_HASH_SIZE (1U << LV2_STATE_STORE_HASH_BITS)
+
+/**
+   The header at the start of a container.
+*/
+typedef struct {
+  char     magic[8];   ///< LV2_STATE_STORE_MAGIC without a terminator
+  uint32_t version;    ///< LV2_STATE_STORE_VERSION
+  uint32_t byte_order; ///< LV2_STATE_STORE_BYTE_ORDER
+  uint32_t n_entries;  ///< Number of entries in the entry table
+  uint32_t n_uris;     ///< Number of URIs in the URI table
+  uint64_t entries;    ///< Offset of the entry table
+  uint64_t uris;       ///< Offset of the URI table of string offsets
+  uint64_t size;       ///< Total size of the container
+} LV2_State_Store_Header;
+
+/**
+   An entry in a container for a stored property.
+*/
+typedef struct {
+  uint32_t key;      ///< Index of the key in the URI table
+  uint32_t type;     ///< Index of the type in the URI table
+  uint32_t flags;    ///< LV2_State_Flags of the value
+  uint32_t reserved; ///< Reserved, zero
+  uint64_t offset;   ///< Offset of the value
+  uint64_t size;     ///< Size of the value in bytes
+} LV2_State_Store_Entry;
+
+/**
+   A writer that builds a container in a host-provided buffer.
+
+   The LV2_State_Store_Writer is the handle for lv2_state_store_store().
+*/
+typedef struct {
+  uint8_t*               buf;         ///< Container buffer
+  uint64_t               capacity;    ///< Size of `buf` in bytes
+  uint64_t               size;        ///< Number of bytes written to `buf`
+  LV2_State_Store_Entry* entries;     ///< Array of entries
+  uint32_t               max_entries; ///< Capacity of `entries`
+  uint32_t               n_entries;   ///< Number of entries
+  LV2_URID*              uris;        ///< URID of every URI table index
+  uint32_t               max_uris;    ///< Capacity of `uris`
+  uint32_t               n_uris;      ///< Number of URIs
+  uint32_t*              entry_slots; ///< Hash table of entry indices
+  uint32_t               entry_mask;  ///< Number of entry slots minus one
+  uint32_t*              uri_slots;   ///< Hash table of URI table indices
+  uint32_t               uri_mask;    ///< Number of URI slots minus one
+  LV2_URID_Unmap*        unmap;       ///< URID unmap feature
+  uint64_t               threshold;   ///< Compression threshold, or zero
+  uint32_t*              table;       ///< Hash table for compression
+} LV2_State_Store_Writer;
+
+/**
+   An index of the entries of a container by key URID.
+*/
+typedef struct {
+  LV2_URID key;   ///< Key URID
+  uint32_t entry; ///< Index of the entry in the entry table
+  uint64_t value; ///< Offset of the decompressed value in scratch plus one
+} LV2_State_Store_Index;
+
+/**
+   A reader that serves values from a container.
+
+   The LV2_State_Store_Reader is the handle for lv2_state_store_retrieve().
+*/
+typedef struct {
+  const uint8_t*                data;         ///< Container data
+  const LV2_State_Store_Header* header;       ///< Container header
+  const LV2_State_Store_Entry*  entries;      ///< Entry table in the container
+  const LV2_URID*               urids;        ///< URID of every URI index
+  LV2_State_Store_Index*        index;        ///< Entries sorted by key URID
+  uint8_t*                      scratch;      ///< Decompressed values
+  uint64_t                      scratch_size; ///< Size of `scratch` in bytes
+  uint64_t                      scratch_used; ///< Bytes used in `scratch`
+} LV2_State_Store_Reader;
+
+/**
+   A sink function for writing Turtle text.
+
+   This has the same semantics as fwrite(), and returns the number of bytes
+   written.
+*/
+typedef size_t (*LV2_State_Store_Sink)(const void* buf,
+                                       size_t      len,
+                                       void*       stream);
+
+/**
+   A function called with decompressed data when a window is full.
+
+   @return True on success, or false to stop decompressing.
+*/
+typedef bool (*LV2_State_Store_Flush)(const uint8_t* data,
+                                      size_t         size,
+                                      void*          handle);
+
+/** Return `size` rounded up to a multiple of 64 bits. */
+static inline uint64_t
+lv2_state_store_pad(const uint64_t size)
+{
+  return (size + 7U) & ~(uint64_t)7U;
+}
+
+/**
+   @name Compression
+   @{
+*/
+
+/** Write a byte to a buffer, and return true on success. */
+static inline bool
+lv2_state_store_put(uint8_t* const  dst,
+                    const uint64_t  capacity,
+                    uint64_t* const size,
+                    const uint8_t   byte)
+{
+  if (*size >= capacity) {
+    return false;
+  }
+
+  dst[(*size)++] = byte;
+  return true;
+}
+
+/** Write the extension of a length in a compressed sequence. */
+static inline bool
+lv2_state_store_put_length(uint8_t* const  dst,
+                           const uint64_t  capacity,
+                           uint64_t* const size,
+                           uint64_t        length)
+{
+  for (; length >= 255U; length -= 255U) {
+    if (!lv2_state_store_put(dst, capacity, size, 255U)) {
+      return false;
+    }
+  }
+
+  return lv2_state_store_put(dst, capacity, size, (uint8_t)length);
+}
+
+/** Write a sequence of literals and a match to compressed data. */
+static inline bool
+lv2_state_store_put_sequence(uint8_t* const       dst,
+                             const uint64_t       capacity,
+                             uint64_t* const      size,
+                             const uint8_t* const literals,
+                             const uint64_t       n_literals,
+                             const uint32_t       offset,
+                             const uint64_t       match)
+{
+  const uint64_t lit_code   = n_literals < 15U ? n_literals : 15U;
+  const uint64_t match_code =
+    match ? (match - 4U < 15U ? match - 4U : 15U) : 0U;
+
+  if (!lv2_state_store_put(
+        dst, capacity, size, (uint8_t)((lit_code << 4U) | match_code)) ||
+      (lit_code == 15U &&
+       !lv2_state_store_put_length(dst, capacity, size, n_literals - 15U)) ||
+      n_literals > capacity - *size) {
+    return false;
+  }
+
+  memcpy(dst + *size, literals, (size_t)n_literals);
+  *size += n_literals;
+
+  return !match ||
+         (lv2_state_store_put(dst, capacity, size, (uint8_t)(offset & 0xFFU)) &&
+          lv2_state_store_put(dst, capacity, size, (uint8_t)(offset >> 8U)) &&
+          (match_code < 15U ||
+           lv2_state_store_put_length(dst, capacity, size, match - 19U)));
+}
+
+/**
+   Compress data.
+
+   The compressed data is a series of sequences, each of which is a token
+   byte, literal bytes to copy, and a match to copy from earlier output.  The
+   high 4 bits of the token are the number of literals, and the low 4 bits are
+   the length of the match minus 4.  If either is 15, it is extended by the
+   sum of following bytes up to and including the first byte that is not 255.
+   The literals follow, and then the match, as a 16-bit little-endian offset
+   backwards from the end of the output, and the extension of its length.
+   The last sequence ends after its literals, and has no match.
+
+   @param src Data to compress, less than 4 GiB.
+   @param size Size of `src` in bytes.
+   @param dst Buffer for compressed data.
+   @param capacity Size of `dst` in bytes.
+   @param table Hash table of LV2_STATE_STORE_HASH_SIZE elements.
+   @return The size of the compressed data, or zero if it does not fit.
+*/
+static inline uint64_t
+lv2_state_store_compress(const uint8_t* const src,
+                         const uint64_t       size,
+                         uint8_t* const       dst,
+                         const uint64_t       capacity,
+                         uint32_t* const      table)
+{
+  uint64_t pos    = 0U;
+  uint64_t anchor = 0U;
+  uint64_t out    = 0U;
+
+  if (size >= UINT32_MAX) {
+    return 0U;
+  }
+
+  memset(table, 0, LV2_STATE_STORE_HASH_SIZE * sizeof(uint32_t));
+  while (size >= 4U && pos <= size - 4U) {
+    uint32_t word = 0U;
+    memcpy(&word, src + pos, 4U);
+
+    // Look up and replace the last position with the same first 4 bytes
+    const uint32_t hash =
+      (word * 2654435761U) >> (32U - LV2_STATE_STORE_HASH_BITS);
+    const uint32_t candidate = table[hash];
+    table[hash]              = (uint32_t)pos + 1U;
+
+    uint32_t match_word = 0U;
+    if (candidate) {
+      memcpy(&match_word, src + candidate - 1U, 4U);
+    }
+
+    if (!candidate || pos - (candidate - 1U) > LV2_STATE_STORE_MAX_OFFSET ||
+        match_word != word) {
+      pos += 1U + ((pos - anchor) >> 6U); // Skip faster in incompressible data
+      continue;
+    }
+
+    // Extend the match as far as possible
+    const uint64_t from   = candidate - 1U;
+    uint64_t       length = 4U;
+    while (pos + length < size && src[from + length] == src[pos + length]) {
+      ++length;
+    }
+
+    if (!lv2_state_store_put_sequence(dst,
+                                      capacity,
+                                      &out,
+                                      src + anchor,
+                                      pos - anchor,
+                                      (uint32_t)(pos - from),
+                                      length)) {
+      return 0U;
+    }
+
+    pos += length;
+    anchor = pos;
+  }
+
+  return lv2_state_store_put_sequence(
+           dst, capacity, &out, src + anchor, size - anchor, 0U, 0U)
+           ? out
+           : 0U;
+}
+
+/** Read the extension of a length in a compressed sequence. */
+static inline bool
+lv2_state_store_get_length(const uint8_t* const src,
+                           const uint64_t       size,
+                           uint64_t* const      pos,
+                           uint64_t* const      length)
+{
+  if (*length == 15U) {
+    uint8_t byte = 255U;
+    while (byte == 255U) {
+      if (*pos >= size) {
+        return false;
+      }
+
+      byte = src[(*pos)++];
+      *length += byte;
+    }
+  }
+
+  return true;
+}
+
+/**
+   Decompress data into a window.
+
+   If `flush` is NULL, the window must be large enough for all the output.
+   Otherwise, it must be larger than LV2_STATE_STORE_MAX_OFFSET, and is
+   passed to `flush` and reused whenever it is full, and when finished.  The
+   compressed data is fully checked, so corrupt data can not cause reading or
+   writing out of bounds.
+
+   @param src Compressed data.
+   @param src_size Size of `src` in bytes.
+   @param window Buffer for decompressed data.
+   @param window_size Size of `window` in bytes.
+   @param size Expected size of the decompressed data.
+   @param flush Function called with full windows, or NULL.
+   @param handle Handle passed to `flush`.
+   @return True on success, or false if the data is corrupt or flush failed.
+*/
+static inline bool
+lv2_state_store_decompress(const uint8_t* const        src,
+                           const uint64_t              src_size,
+                           uint8_t* const              window,
+                           const uint64_t              window_size,
+                           const uint64_t              size,
+                           const LV2_State_Store_Flush flush,
+                           void* const                 handle)
+{
+  uint64_t in    = 0U;
+  uint64_t pos   = 0U;
+  uint64_t total = 0U;
+
+  if (flush ? window_size <= LV2_STATE_STORE_MAX_OFFSET : window_size < size) {
+    return false;
+  }
+
+  while (in < src_size) {
+    const uint8_t token = src[in++];
+
+    // Copy literals
+    uint64_t n = token >> 4U;
+    if (!lv2_state_store_get_length(src, src_size, &in, &n) ||
+        n > src_size - in || n > size - total) {
+      return false;
+    }
+
+    total += n;
+    while (n) {
+      const uint64_t chunk = n < window_size - pos ? n : window_size - pos;
+      memcpy(window + pos, src + in, (size_t)chunk);
+      in += chunk;
+      pos += chunk;
+      n -= chunk;
+      if (pos == window_size) {
+        if (flush && !flush(window, (size_t)pos, handle)) {
+          return false;
+        }
+
+        pos = 0U;
+      }
+    }
+
+    if (in == src_size) {
+      break; // Last sequence
+    }
+
+    // Copy match
+    if (src_size - in < 2U) {
+      return false;
+    }
+
+    const uint64_t offset = src[in] | ((uint64_t)src[in + 1U] << 8U);
+    uint64_t       length = token & 0x0FU;
+    in += 2U;
+    if (!lv2_state_store_get_length(src, src_size, &in, &length) || !offset ||
+        offset > total || (length += 4U) > size - total) {
+      return false;
+    }
+
+    uint64_t from = pos >= offset ? pos - offset : pos + window_size - offset;
+    total += length;
+    if (from + length <= window_size && pos + length < window_size) {
+      for (uint64_t i = 0U; i < length; ++i) {
+        window[pos + i] = window[from + i]; // May overlap, so copy forwards
+      }
+
+      pos += length;
+      length = 0U;
+    }
+
+    for (; length; --length) {
+      window[pos++] = window[from++];
+      from          = (from == window_size) ? 0U : from;
+      if (pos == window_size) {
+        if (flush && !flush(window, (size_t)pos, handle)) {
+          return false;
+        }
+
+        pos = 0U;
+      }
+    }
+  }
+
+  return total == size &&
+         (!flush || !pos || flush(window, (size_t)pos, handle));
+}
+
+/**
+   @}
+   @name Writing
+   @{
+*/
+
+/**
+   Return the number of hash slots for a table of up to `n` items.
+
+   This is a power of two at least twice `n`, so probes stay short.
+*/
+static inline uint32_t
+lv2_state_store_table_size(const uint32_t n)
+{
+  uint32_t size = 2U;
+  while (size / 2U < n && size < 0x80000000U) {
+    size <<= 1U;
+  }
+
+  return size;
+}
+
+/**
+   Return the number of hash slots a writer needs.
+
+   @param max_entries Capacity of the writer's entries.
+   @param max_uris Capacity of the writer's URIs.
+*/
+static inline uint64_t
+lv2_state_store_n_slots(const uint32_t max_entries, const uint32_t max_uris)
+{
+  return (uint64_t)lv2_state_store_table_size(max_entries) +
+         lv2_state_store_table_size(max_uris);
+}
+
+/**
+   Initialise a writer to build a container in a host-provided buffer.
+
+   @param writer Writer to initialise.
+   @param buf Buffer for the container, which should be 64-bit aligned.
+   @param capacity Size of `buf` in bytes.
+   @param entries Array for at least as many entries as properties.
+   @param max_entries Capacity of `entries`.
+   @param uris Array for at least as many URIDs as distinct keys and types.
+   @param max_uris Capacity of `uris`.
+   @param slots Array of lv2_state_store_n_slots() hash slots, used to find
+   entries and URIs in constant time.
+   @param unmap URID unmap feature, used to write URIs when finished.
+*/
+static inline void
+lv2_state_store_writer_init(LV2_State_Store_Writer* const writer,
+                            void* const                   buf,
+                            const uint64_t                capacity,
+                            LV2_State_Store_Entry* const  entries,
+                            const uint32_t                max_entries,
+                            LV2_URID* const               uris,
+                            const uint32_t                max_uris,
+                            uint32_t* const               slots,
+                            LV2_URID_Unmap* const         unmap)
+{
+  const uint32_t n_entry_slots = lv2_state_store_table_size(max_entries);
+  const uint32_t n_uri_slots   = lv2_state_store_table_size(max_uris);
+
+  writer->buf         = (uint8_t*)buf;
+  writer->capacity    = capacity;
+  writer->size        = sizeof(LV2_State_Store_Header);
+  writer->entries     = entries;
+  writer->max_entries = max_entries;
+  writer->n_entries   = 0U;
+  writer->uris        = uris;
+  writer->max_uris    = max_uris;
+  writer->n_uris      = 0U;
+  writer->entry_slots = slots;
+  writer->entry_mask  = n_entry_slots - 1U;
+  writer->uri_slots   = slots + n_entry_slots;
+  writer->uri_mask    = n_uri_slots - 1U;
+  writer->unmap       = unmap;
+  writer->threshold   = 0U;
+  writer->table       = NULL;
+
+  memset(slots, 0, ((size_t)n_entry_slots + n_uri_slots) * sizeof(uint32_t));
+}
+
+/**
+   Enable compression of large values.
+
+   @param writer Writer to configure.
+   @param threshold The minimum size of a value to compress, or zero to
+   disable compression, which is the default.
+   @param table Hash table of LV2_STATE_STORE_HASH_SIZE elements, which must
+   remain valid while the writer is used, or NULL to disable compression.
+*/
+static inline void
+lv2_state_store_writer_set_compression(LV2_State_Store_Writer* const writer,
+                                       const uint64_t threshold,
+                                       uint32_t* const table)
+{
+  writer->threshold = table ? threshold : 0U;
+  writer->table     = table;
+}
+
+/**
+   Append bytes to a container.
+
+   @return The offset of the appended bytes, or zero if there is no space.
+*/
+static inline uint64_t
+lv2_state_store_append(LV2_State_Store_Writer* const writer,
+                       const void* const             data,
+                       const uint64_t                size)
+{
+  const uint64_t offset = lv2_state_store_pad(writer->size);
+  if (offset > writer->capacity || size > writer->capacity - offset) {
+    return 0U;
+  }
+
+  memset(writer->buf + writer->size, 0, (size_t)(offset - writer->size));
+  memcpy(writer->buf + offset, data, (size_t)size);
+  writer->size = offset + size;
+  return offset;
+}
+
+/**
+   Append a compressed value to a container.
+
+   @return The offset of the compressed value, or zero if it does not fit or
+   compression would not make it smaller.
+*/
+static inline uint64_t
+lv2_state_store_append_compressed(LV2_State_Store_Writer* const writer,
+                                  const void* const             data,
+                                  const uint64_t                size,
+                                  uint64_t* const               stored_size)
+{
+  const uint64_t offset = lv2_state_store_pad(writer->size);
+  const uint64_t header = sizeof(uint64_t);
+  if (offset > writer->capacity || header >= writer->capacity - offset ||
+      size <= header) {
+    return 0U;
+  }
+
+  // Only keep the compressed data if it is smaller
+  const uint64_t space    = writer->capacity - offset - header;
+  const uint64_t capacity = (space < size - header) ? space : size - header;
+  const uint64_t n        = lv2_state_store_compress((const uint8_t*)data,
+                                                 size,
+                                                 writer->buf + offset + header,
+                                                 capacity,
+                                                 writer->table);
+  if (!n) {
+    return 0U;
+  }
+
+  memset(writer->buf + writer->size, 0, (size_t)(offset - writer->size));
+  memcpy(writer->buf + offset, &size, sizeof(size));
+  writer->size = offset + header + n;
+  *stored_size = header + n;
+  return offset;
+}
+
+/**
+   Return the hash slot for a URID in one of a writer's tables.
+
+   A slot holds an entry or URI table index plus one.  The returned slot
+   either has the URID, or is the empty slot where it would be added.
+
+   @param writer Writer to search.
+   @param entries True to search the entries by key, false to search URIs.
+   @param urid URID to find.
+*/
+static inline uint32_t*
+lv2_state_store_slot(const LV2_State_Store_Writer* const writer,
+                     const bool                          entries,
+                     const LV2_URID                      urid)
+{
+  uint32_t* const slots = entries ? writer->entry_slots : writer->uri_slots;
+  const uint32_t  mask  = entries ? writer->entry_mask : writer->uri_mask;
+  const uint32_t  hash  = urid * 2654435761U;
+
+  // Tables are never more than half full, so there is always an empty slot
+  for (uint32_t i = hash ^ (hash >> 16U);; ++i) {
+    uint32_t* const slot = &slots[i & mask];
+    if (!*slot) {
+      return slot;
+    }
+
+    const uint32_t index = *slot - 1U;
+    if (writer->uris[entries ? writer->entries[index].key : index] == urid) {
+      return slot;
+    }
+  }
+}
+
+/**
+   Return the URI table index for a URID, adding it if necessary.
+
+   @return The index, or UINT32_MAX if the URI table is full.
+*/
+static inline uint32_t
+lv2_state_store_intern(LV2_State_Store_Writer* const writer,
+                       const LV2_URID                urid)
+{
+  uint32_t* const slot = lv2_state_store_slot(writer, false, urid);
+  if (*slot) {
+    return *slot - 1U;
+  }
+
+  if (writer->n_uris == writer->max_uris) {
+    return UINT32_MAX;
+  }
+
+  writer->uris[writer->n_uris] = urid;
+  *slot                        = ++writer->n_uris;
+  return writer->n_uris - 1U;
+}
+
+/**
+   Return the entry for a key in a writer, adding it if necessary.
+
+   A new entry is added last with only its key set, so that it can be
+   discarded with lv2_state_store_discard().
+
+   @return The entry, or NULL if the writer's entries or URIs are full.
+*/
+static inline LV2_State_Store_Entry*
+lv2_state_store_entry(LV2_State_Store_Writer* const writer,
+                      const LV2_URID                key)
+{
+  uint32_t* const slot = lv2_state_store_slot(writer, true, key);
+  if (*slot) {
+    return &writer->entries[*slot - 1U];
+  }
+
+  const uint32_t index = (writer->n_entries < writer->max_entries)
+                           ? lv2_state_store_intern(writer, key)
+                           : UINT32_MAX;
+  if (index == UINT32_MAX) {
+    return NULL;
+  }
+
+  LV2_State_Store_Entry* const entry = &writer->entries[writer->n_entries];
+  memset(entry, 0, sizeof(LV2_State_Store_Entry));
+  entry->key = index;
+  *slot      = ++writer->n_entries;
+  return entry;
+}
+
+/**
+   Discard the entries and URIs added to a writer since it had a given size.
+
+   Items are removed newest first, so every slot that is cleared was the
+   last one filled on its probe sequence, and the tables remain valid.
+*/
+static inline void
+lv2_state_store_discard(LV2_State_Store_Writer* const writer,
+                        const uint32_t                n_entries,
+                        const uint32_t                n_uris)
+{
+  while (writer->n_entries > n_entries) {
+    const LV2_State_Store_Entry* const entry =
+      &writer->entries[writer->n_entries - 1U];
+
+    *lv2_state_store_slot(writer, true, writer->uris[entry->key]) = 0U;
+    --writer->n_entries;
+  }
+
+  while (writer->n_uris > n_uris) {
+    *lv2_state_store_slot(writer, false, writer->uris[writer->n_uris - 1U]) =
+      0U;
+    --writer->n_uris;
+  }
+}
+
+/**
+   Store a property in a container.
+
+   This is the LV2_State_Store_Function implementation, with an
+   LV2_State_Store_Writer as the handle.  Storing a key again replaces its
+   value, though the space used by the previous value is not reclaimed.  If
+   compression is enabled and the value is large enough, it is compressed if
+   that makes it smaller.  A property that can not be stored leaves the
+   container unchanged.
+
+   @return LV2_STATE_SUCCESS, LV2_STATE_ERR_BAD_FLAGS if the value is not
+   LV2_STATE_IS_POD, or LV2_STATE_ERR_NO_SPACE if the container or one of the
+   writer's arrays is full.
+*/
+static inline LV2_State_Status
+lv2_state_store_store(LV2_State_Handle  handle,
+                      const uint32_t    key,
+                      const void* const value,
+                      const size_t      size,
+                      const uint32_t    type,
+                      const uint32_t    flags)
+{
+  LV2_State_Store_Writer* const writer = (LV2_State_Store_Writer*)handle;
+  if (!(flags & LV2_STATE_IS_POD)) {
+    return LV2_STATE_ERR_BAD_FLAGS;
+  }
+
+  if (!key || !type || !value || !size ||
+      (flags & (LV2_STATE_STORE_REMOVED | LV2_STATE_STORE_COMPRESSED))) {
+    return LV2_STATE_ERR_UNKNOWN;
+  }
+
+  // Add the key and type before the value, so nothing is appended on failure
+  const uint32_t               n_entries = writer->n_entries;
+  const uint32_t               n_uris    = writer->n_uris;
+  LV2_State_Store_Entry* const entry     = lv2_state_store_entry(writer, key);
+  const uint32_t               type_index =
+    entry ? lv2_state_store_intern(writer, type) : UINT32_MAX;
+  if (type_index == UINT32_MAX) {
+    lv2_state_store_discard(writer, n_entries, n_uris);
+    return LV2_STATE_ERR_NO_SPACE;
+  }
+
+  uint64_t stored = size;
+  uint64_t offset = 0U;
+  if (writer->threshold && size >= writer->threshold) {
+    offset = lv2_state_store_append_compressed(writer, value, size, &stored);
+  }
+
+  if (!offset) {
+    stored = size;
+    offset = lv2_state_store_append(writer, value, size);
+  }
+
+  if (!offset) {
+    lv2_state_store_discard(writer, n_entries, n_uris);
+    return LV2_STATE_ERR_NO_SPACE;
+  }
+
+  entry->type   = type_index;
+  entry->flags  = flags | (stored < size ? LV2_STATE_STORE_COMPRESSED : 0U);
+  entry->offset = offset;
+  entry->size   = stored;
+  return LV2_STATE_SUCCESS;
+}
+
+/**
+   Record that a property has been removed.
+
+   This adds an entry with the LV2_STATE_STORE_REMOVED flag and no value, or
+   replaces the value if the key has already been stored.  It is only useful
+   in containers which are layered over an earlier one, see
+   LV2_State_Delta_Reader.
+
+   @return LV2_STATE_SUCCESS, or LV2_STATE_ERR_NO_SPACE if one of the writer's
+   arrays is full.
+*/
+static inline LV2_State_Status
+lv2_state_store_remove(LV2_State_Store_Writer* const writer,
+                       const LV2_URID                key)
+{
+  LV2_State_Store_Entry* const entry = lv2_state_store_entry(writer, key);
+  if (!entry) {
+    return LV2_STATE_ERR_NO_SPACE;
+  }
+
+  entry->type   = entry->key;
+  entry->flags  = LV2_STATE_STORE_REMOVED;
+  entry->offset = 0U;
+  entry->size   = 0U;
+  return LV2_STATE_SUCCESS;
+}
+
+/**
+   Finish a container by writing the URI strings, tables, and header.
+
+   @return The total size of the container, or zero if there was not enough
+   space, or a URI could not be unmapped.
+*/
+static inline uint64_t
+lv2_state_store_writer_finish(LV2_State_Store_Writer* const writer)
+{
+  if (writer->capacity < sizeof(LV2_State_Store_Header)) {
+    return 0U;
+  }
+
+  // Reserve the URI table
+  const uint64_t uris       = lv2_state_store_pad(writer->size);
+  const uint64_t table_size = (uint64_t)writer->n_uris * sizeof(uint64_t);
+  if (uris > writer->capacity || table_size > writer->capacity - uris) {
+    return 0U;
+  }
+
+  memset(writer->buf + writer->size, 0, (size_t)(uris - writer->size));
+  writer->size = uris + table_size;
+
+  // Write every URI string and its offset in the table
+  for (uint32_t i = 0U; i < writer->n_uris; ++i) {
+    const char* const uri =
+      writer->unmap->unmap(writer->unmap->handle, writer->uris[i]);
+    const uint64_t offset =
+      uri ? lv2_state_store_append(writer, uri, strlen(uri) + 1U) : 0U;
+    if (!offset) {
+      return 0U;
+    }
+
+    memcpy(writer->buf + uris + (i * sizeof(uint64_t)), &offset, 8U);
+  }
+
+  // Write the entry table
+  const uint64_t entries = lv2_state_store_append(
+    writer,
+    writer->entries,
+    (uint64_t)writer->n_entries * sizeof(LV2_State_Store_Entry));
+  if (!entries) {
+    return 0U;
+  }
+
+  const LV2_State_Store_Header header = {
+    {'L', 'V', '2', 'S', 't', 'a', 't', 'e'},
+    LV2_STATE_STORE_VERSION,
+    LV2_STATE_STORE_BYTE_ORDER,
+    writer->n_entries,
+    writer->n_uris,
+    entries,
+    uris,
+    writer->size,
+  };
+
+  memcpy(writer->buf, &header, sizeof(header));
+  return writer->size;
+}
+
+/**
+   @}
+   @name Reading
+   @{
+*/
+
+/**
+   Return the URI at a URI table index in a checked container.
+*/
+static inline const char*
+lv2_state_store_uri(const LV2_State_Store_Header* const header,
+                    const uint32_t                      index)
+{
+  const uint8_t* const data   = (const uint8_t*)header;
+  uint64_t             offset = 0U;
+
+  memcpy(&offset, data + header->uris + (index * sizeof(uint64_t)), 8U);
+  return (const char*)data + offset;
+}
+
+/**
+   Check that a buffer contains a valid container.
+
+   This checks that all offsets and sizes are in bounds, and that all URI
+   strings are terminated, so that a corrupt file can not cause reading
+   outside the buffer.
+
+   @param data Container data, which must be 64-bit aligned.
+   @param size Size of `data` in bytes.
+   @return The header of the container, or NULL if it is invalid.
+*/
+static inline const LV2_State_Store_Header*
+lv2_state_store_check(const void* const data, const uint64_t size)
+{
+  const LV2_State_Store_Header* const header =
+    (const LV2_State_Store_Header*)data;
+
+  if (size < sizeof(LV2_State_Store_Header) ||
+      memcmp(header->magic, LV2_STATE_STORE_MAGIC, 8U) ||
+      !header->version || header->version > LV2_STATE_STORE_VERSION ||
+      header->byte_order != LV2_STATE_STORE_BYTE_ORDER ||
+      header->size > size || header->entries > header->size ||
+      header->uris > header->size || (header->entries & 7U) ||
+      (header->uris & 7U) ||
+      (uint64_t)header->n_entries * sizeof(LV2_State_Store_Entry) >
+        header->size - header->entries ||
+      (uint64_t)header->n_uris * sizeof(uint64_t) >
+        header->size - header->uris) {
+    return NULL;
+  }
+
+  const uint8_t* const bytes = (const uint8_t*)data;
+  for (uint32_t i = 0U; i < header->n_uris; ++i) {
+    uint64_t offset = 0U;
+    memcpy(&offset, bytes + header->uris + (i * sizeof(uint64_t)), 8U);
+    if (offset >= header->size ||
+        !memchr(bytes + offset, 0, (size_t)(header->size - offset))) {
+      return NULL;
+    }
+  }
+
+  const LV2_State_Store_Entry* const entries =
+    (const LV2_State_Store_Entry*)(bytes + header->entries);
+  for (uint32_t i = 0U; i < header->n_entries; ++i) {
+    const LV2_State_Store_Entry* const entry = &entries[i];
+    if (entry->key >= header->n_uris || entry->type >= header->n_uris ||
+        entry->offset > header->size ||
+        entry->size > header->size - entry->offset || (entry->offset & 7U) ||
+        ((entry->flags & LV2_STATE_STORE_COMPRESSED) &&
+         entry->size < sizeof(uint64_t))) {
+      return NULL;
+    }
+  }
+
+  return header;
+}
+
+/**
+   Move an index item down a heap until it is not less than its children.
+*/
+static inline void
+lv2_state_store_sift(LV2_State_Store_Index* const index,
+                     uint32_t                     root,
+                     const uint32_t               n_items)
+{
+  const LV2_State_Store_Index item = index[root];
+
+  for (uint64_t child = (2U * (uint64_t)root) + 1U; child < n_items;
+       child          = (2U * (uint64_t)root) + 1U) {
+    if (child + 1U < n_items && index[child + 1U].key > index[child].key) {
+      ++child;
+    }
+
+    if (index[child].key <= item.key) {
+      break;
+    }
+
+    index[root] = index[child];
+    root        = (uint32_t)child;
+  }
+
+  index[root] = item;
+}
+
+/**
+   Index entries by the URID of their key.
+
+   @param entries Entry table.
+   @param n_entries Number of entries.
+   @param urids URID of every URI table index.
+   @param index Array of `n_entries` index entries to sort.
+*/
+static inline void
+lv2_state_store_sort(const LV2_State_Store_Entry* const entries,
+                     const uint32_t                     n_entries,
+                     const LV2_URID* const              urids,
+                     LV2_State_Store_Index* const       index)
+{
+  bool sorted = true;
+  for (uint32_t i = 0U; i < n_entries; ++i) {
+    const LV2_State_Store_Index item = {urids[entries[i].key], i, 0U};
+
+    index[i] = item;
+    sorted   = sorted && (!i || index[i - 1U].key <= item.key);
+  }
+
+  if (sorted) {
+    return; // Entries are often already sorted
+  }
+
+  // Heapsort in place, which is O(n log n) even for large states
+  for (uint32_t i = n_entries / 2U; i > 0U; --i) {
+    lv2_state_store_sift(index, i - 1U, n_entries);
+  }
+
+  for (uint32_t end = n_entries - 1U; end > 0U; --end) {
+    const LV2_State_Store_Index max = index[0];
+
+    index[0]   = index[end];
+    index[end] = max;
+    lv2_state_store_sift(index, 0U, end);
+  }
+}
+
+/**
+   Return the index item for a key in a sorted index, or NULL.
+*/
+static inline const LV2_State_Store_Index*
+lv2_state_store_search(const LV2_State_Store_Index* const index,
+                       const uint32_t                     n_entries,
+                       const LV2_URID                     key)
+{
+  uint32_t lower = 0U;
+  uint32_t upper = n_entries;
+  while (lower < upper) {
+    const uint32_t               mid  = lower + ((upper - lower) / 2U);
+    const LV2_State_Store_Index* item = &index[mid];
+    if (item->key == key) {
+      return item;
+    }
+
+    if (item->key < key) {
+      lower = mid + 1U;
+    } else {
+      upper = mid;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   Initialise a reader for a checked container.
+
+   Every URI in the container is mapped, and the entries are indexed by key.
+   The container data must remain valid and unchanged while the reader is
+   used.
+
+   @param reader Reader to initialise.
+   @param header Container header returned by lv2_state_store_check().
+   @param map URID map feature.
+   @param urids Array of `header->n_uris` URIDs.
+   @param index Array of `header->n_entries` index entries.
+   @return LV2_STATE_SUCCESS, or LV2_STATE_ERR_UNKNOWN if mapping failed.
+*/
+static inline LV2_State_Status
+lv2_state_store_reader_init(LV2_State_Store_Reader* const       reader,
+                            const LV2_State_Store_Header* const header,
+                            LV2_URID_Map* const                 map,
+                            LV2_URID* const                     urids,
+                            LV2_State_Store_Index* const        index)
+{
+  const uint8_t* const data = (const uint8_t*)header;
+
+  reader->data         = data;
+  reader->header       = header;
+  reader->entries      = (const LV2_State_Store_Entry*)(data + header->entries);
+  reader->urids        = urids;
+  reader->index        = index;
+  reader->scratch      = NULL;
+  reader->scratch_size = 0U;
+  reader->scratch_used = 0U;
+
+  for (uint32_t i = 0U; i < header->n_uris; ++i) {
+    if (!(urids[i] = map->map(map->handle, lv2_state_store_uri(header, i)))) {
+      return LV2_STATE_ERR_UNKNOWN;
+    }
+  }
+
+  lv2_state_store_sort(reader->entries, header->n_entries, urids, index);
+  return LV2_STATE_SUCCESS;
+}
+
+/**
+   Return the scratch space needed to retrieve every value in a container.
+
+   This is the total size of all compressed values when decompressed.
+*/
+static inline uint64_t
+lv2_state_store_scratch_size(const LV2_State_Store_Header* const header)
+{
+  const uint8_t* const               data = (const uint8_t*)header;
+  const LV2_State_Store_Entry* const entries =
+    (const LV2_State_Store_Entry*)(data + header->entries);
+
+  uint64_t total = 0U;
+  for (uint32_t i = 0U; i < header->n_entries; ++i) {
+    if (entries[i].flags & LV2_STATE_STORE_COMPRESSED) {
+      uint64_t size = 0U;
+      memcpy(&size, data + entries[i].offset, sizeof(size));
+      total += lv2_state_store_pad(size);
+    }
+  }
+
+  return total;
+}
+
+/**
+   Set the scratch space used to decompress values.
+
+   Compressed values are decompressed into the scratch space the first time
+   they are retrieved, and remain valid until this is called again.  Without
+   enough space, compressed values can not be retrieved.
+
+   @param reader Reader to set the scratch space of.
+   @param scratch Buffer which should be 64-bit aligned, or NULL.
+   @param size Size of `scratch` in bytes, ideally at least
+   lv2_state_store_scratch_size().
+*/
+static inline void
+lv2_state_store_reader_set_scratch(LV2_State_Store_Reader* const reader,
+                                   void* const                   scratch,
+                                   const uint64_t                size)
+{
+  reader->scratch      = (uint8_t*)scratch;
+  reader->scratch_size = size;
+  reader->scratch_used = 0U;
+
+  // Forget values decompressed into the previous scratch space
+  for (uint32_t i = 0U; i < reader->header->n_entries; ++i) {
+    reader->index[i].value = 0U;
+  }
+}
+
+/**
+   Return the entry for a key, or NULL.
+*/
+static inline const LV2_State_Store_Entry*
+lv2_state_store_find(const LV2_State_Store_Reader* const reader,
+                     const LV2_URID                      key)
+{
+  const LV2_State_Store_Index* const item =
+    lv2_state_store_search(reader->index, reader->header->n_entries, key);
+
+  return item ? &reader->entries[item->entry] : NULL;
+}
+
+/**
+   Retrieve a property from a container.
+
+   This is the LV2_State_Retrieve_Function implementation, with an
+   LV2_State_Store_Reader as the handle.  The returned value points directly
+   into the container data, and is not copied, unless it is compressed.
+   Compressed values are decompressed into the reader's scratch space the
+   first time they are retrieved, and later retrievals return the same data.
+*/
+static inline const void*
+lv2_state_store_retrieve(LV2_State_Handle handle,
+                         const uint32_t   key,
+                         size_t* const    size,
+                         uint32_t* const  type,
+                         uint32_t* const  flags)
+{
+  LV2_State_Store_Reader* const reader = (LV2_State_Store_Reader*)handle;
+
+  const LV2_State_Store_Index* const found =
+    lv2_state_store_search(reader->index, reader->header->n_entries, key);
+  LV2_State_Store_Index* const item =
+    found ? &reader->index[found - reader->index] : NULL;
+  const LV2_State_Store_Entry* const entry =
+    item ? &reader->entries[item->entry] : NULL;
+  if (!entry || (entry->flags & LV2_STATE_STORE_REMOVED)) {
+    return NULL;
+  }
+
+  const uint8_t* value      = reader->data + entry->offset;
+  uint64_t       value_size = entry->size;
+  if (entry->flags & LV2_STATE_STORE_COMPRESSED) {
+    memcpy(&value_size, value, sizeof(value_size));
+
+    // Decompress the value into scratch space the first time only
+    if (!item->value) {
+      const uint64_t offset = reader->scratch_used;
+      const uint64_t space  = reader->scratch_size - offset;
+      if (value_size > space ||
+          !lv2_state_store_decompress(value + sizeof(uint64_t),
+                                      entry->size - sizeof(uint64_t),
+                                      reader->scratch + offset,
+                                      value_size,
+                                      value_size,
+                                      NULL,
+                                      NULL)) {
+        return NULL;
+      }
+
+      const uint64_t padded = lv2_state_store_pad(value_size);
+      reader->scratch_used += (padded < space) ? padded : space;
+      item->value           = offset + 1U;
+    }
+
+    value = reader->scratch + (item->value - 1U);
+  }
+
+  if (size) {
+    *size = (size_t)value_size;
+  }
+
+  if (type) {
+    *type = reader->urids[entry->type];
+  }
+
+  if (flags) {
+    *flags = entry->flags & ~LV2_STATE_STORE_COMPRESSED;
+  }
+
+  return value;
+}
+
+/**
+   @}
+   @name Turtle
+   @{
+*/
+
+/** Write a string to a sink, and return true on success. */
+static inline bool
+lv2_state_store_puts(const LV2_State_Store_Sink sink,
+                     void* const                stream,
+                     const char* const          str,
+                     const size_t               len)
+{
+  return sink(str, len, stream) == len;
+}
+
+/** Write a string as the contents of a Turtle string literal. */
+static inline bool
+lv2_state_store_write_escaped(const LV2_State_Store_Sink sink,
+                              void* const                stream,
+                              const char* const          str,
+                              const size_t               len)
+{
+  size_t start = 0U;
+  for (size_t i = 0U; i < len; ++i) {
+    const char* escape = NULL;
+    switch (str[i]) {
+    case '"':
+      escape = "\\\"";
+      break;
+    case '\\':
+      escape = "\\\\";
+      break;
+    case '\n':
+      escape = "\\n";
+      break;
+    case '\r':
+      escape = "\\r";
+      break;
+    case '\t':
+      escape = "\\t";
+      break;
+    default:
+      continue;
+    }
+
+    if (!lv2_state_store_puts(sink, stream, str + start, i - start) ||
+        !lv2_state_store_puts(sink, stream, escape, 2U)) {
+      return false;
+    }
+
+    start = i + 1U;
+  }
+
+  return lv2_state_store_puts(sink, stream, str + start, len - start);
+}
+
+/** Write binary data as base64. */
+static inline bool
+lv2_state_store_write_base64(const LV2_State_Store_Sink sink,
+                             void* const                stream,
+                             const uint8_t* const       data,
+                             const size_t               size)
+{
+  static const char alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+  for (size_t i = 0U; i < size; i += 3U) {
+    const size_t   n    = (size - i < 3U) ? (size - i) : 3U;
+    const uint32_t bits = ((uint32_t)data[i] << 16U) |
+                          (n > 1U ? (uint32_t)data[i + 1U] << 8U : 0U) |
+                          (n > 2U ? (uint32_t)data[i + 2U] : 0U);
+
+    const char quad[4] = {
+      alphabet[(bits >> 18U) & 0x3FU],
+      alphabet[(bits >> 12U) & 0x3FU],
+      n > 1U ? alphabet[(bits >> 6U) & 0x3FU] : '=',
+      n > 2U ? alphabet[bits & 0x3FU] : '=',
+    };
+
+    if (!lv2_state_store_puts(sink, stream, quad, 4U)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/** Write a value as a Turtle literal. */
+static inline bool
+lv2_state_store_write_value(const LV2_State_Store_Sink sink,
+                            void* const                stream,
+                            const char* const          type,
+                            const uint8_t* const       value,
+                            const size_t               size)
+{
+  char text[32] = {0};
+  int  len      = -1;
+
+  if (!strcmp(type, LV2_ATOM__Int) && size == sizeof(int32_t)) {
+    int32_t num = 0;
+    memcpy(&num, value, sizeof(num));
+    len = snprintf(text, sizeof(text), "\"%ld\"^^xsd:int", (long)num);
+  } else if (!strcmp(type, LV2_ATOM__Long) && size == sizeof(int64_t)) {
+    int64_t num = 0;
+    memcpy(&num, value, sizeof(num));
+    len = snprintf(text, sizeof(text), "\"%lld\"^^xsd:long", (long long)num);
+  } else if (!strcmp(type, LV2_ATOM__Float) && size == sizeof(float)) {
+    float num = 0.0f;
+    memcpy(&num, value, sizeof(num));
+    len = snprintf(text, sizeof(text), "\"%.9g\"^^xsd:float", (double)num);
+  } else if (!strcmp(type, LV2_ATOM__Double) && size == sizeof(double)) {
+    double num = 0.0;
+    memcpy(&num, value, sizeof(num));
+    len = snprintf(text, sizeof(text), "\"%.17g\"^^xsd:double", num);
+  } else if (!strcmp(type, LV2_ATOM__Bool) && size == sizeof(int32_t)) {
+    int32_t num = 0;
+    memcpy(&num, value, sizeof(num));
+    len = snprintf(text, sizeof(text), "%s", num ? "true" : "false");
+  }
+
+  if (len > 0 && (size_t)len < sizeof(text)) {
+    return lv2_state_store_puts(sink, stream, text, (size_t)len);
+  }
+
+  const char* const str = (const char*)value;
+  const char* const end = (const char*)memchr(str, 0, size);
+  const size_t      n   = end ? (size_t)(end - str) : size;
+  if (!strcmp(type, LV2_ATOM__String) && n + 1U == size) {
+    return lv2_state_store_puts(sink, stream, "\"", 1U) &&
+           lv2_state_store_write_escaped(sink, stream, str, n) &&
+           lv2_state_store_puts(sink, stream, "\"", 1U);
+  }
+
+  if (!strcmp(type, LV2_ATOM__URI) && n + 1U == size &&
+      !strpbrk(str, "<>\"{}|^`\\ ")) {
+    return lv2_state_store_puts(sink, stream, "<", 1U) &&
+           lv2_state_store_puts(sink, stream, str, n) &&
+           lv2_state_store_puts(sink, stream, ">", 1U);
+  }
+
+  const bool is_path = !strcmp(type, LV2_ATOM__Path) && n + 1U == size;
+
+  return lv2_state_store_puts(sink, stream, "\"", 1U) &&
+         (is_path ? lv2_state_store_write_escaped(sink, stream, str, n)
+                  : lv2_state_store_write_base64(sink, stream, value, size)) &&
+         lv2_state_store_puts(sink, stream, "\"^^<", 4U) &&
+         lv2_state_store_puts(sink, stream, type, strlen(type)) &&
+         lv2_state_store_puts(sink, stream, ">", 1U);
+}
+
+/** Context for writing decompressed data as base64. */
+typedef struct {
+  LV2_State_Store_Sink sink;   ///< Sink function
+  void*                stream; ///< Stream passed to `sink`
+} LV2_State_Store_Base64_Flush;
+
+/** Write a window of decompressed data as base64. */
+static inline bool
+lv2_state_store_flush_base64(const uint8_t* const data,
+                             const size_t         size,
+                             void* const          handle)
+{
+  const LV2_State_Store_Base64_Flush* const context =
+    (const LV2_State_Store_Base64_Flush*)handle;
+
+  return lv2_state_store_write_base64(
+    context->sink, context->stream, data, size);
+}
+
+/**
+   Write a compressed value as a Turtle literal.
+
+   Values that fit in a window are decompressed and written as usual.  Larger
+   values are decompressed one window at a time, and written in base64.
+
+   @param sink Sink function to write text to.
+   @param stream Stream passed to `sink`.
+   @param type Type URI of the value.
+   @param value Compressed value, starting with its uncompressed size.
+   @param size Size of `value` in bytes.
+   @param window Buffer of LV2_STATE_STORE_WINDOW_SIZE bytes.
+*/
+static inline bool
+lv2_state_store_write_compressed(const LV2_State_Store_Sink sink,
+                                 void* const                stream,
+                                 const char* const          type,
+                                 const uint8_t* const       value,
+                                 const size_t               size,
+                                 uint8_t* const             window)
+{
+  uint64_t length = 0U;
+
+  memcpy(&length, value, sizeof(length));
+  if (length <= LV2_STATE_STORE_WINDOW_SIZE) {
+    return lv2_state_store_decompress(value + sizeof(uint64_t),
+                                      size - sizeof(uint64_t),
+                                      window,
+                                      length,
+                                      length,
+                                      NULL,
+                                      NULL) &&
+           lv2_state_store_write_value(
+             sink, stream, type, window, (size_t)length);
+  }
+
+  LV2_State_Store_Base64_Flush context = {sink, stream};
+
+  return lv2_state_store_puts(sink, stream, "\"", 1U) &&
+         lv2_state_store_decompress(value + sizeof(uint64_t),
+                                    size - sizeof(uint64_t),
+                                    window,
+                                    LV2_STATE_STORE_WINDOW_SIZE,
+                                    length,
+                                    lv2_state_store_flush_base64,
+                                    &context) &&
+         lv2_state_store_puts(sink, stream, "\"^^<", 4U) &&
+         lv2_state_store_puts(sink, stream, type, strlen(type)) &&
+         lv2_state_store_puts(sink, stream, ">", 1U);
+}
+
+/**
+   Write the properties of a checked container as a Turtle blank node.
+
+   The output is an anonymous node like `[ <key> "value" ; ... ]`, which can
+   be used as the object of a state:state statement.  Numbers and booleans are
+   written as literals with an `xsd:` prefixed datatype, so the document must
+   define the xsd prefix.  Strings, URIs, and paths are written as text, and
+   values of other types are written in base64 with their type as the
+   datatype.  Compressed values larger than LV2_STATE_STORE_WINDOW_SIZE are
+   always written in base64.  Removed properties are not written.
+
+   @param header Container header returned by lv2_state_store_check().
+   @param sink Sink function to write text to.
+   @param stream Stream passed to `sink`.
+   @param window Buffer of LV2_STATE_STORE_WINDOW_SIZE bytes used to
+   decompress values, or NULL if the container has no compressed values.
+   @return True on success, or false if writing failed.
+*/
+static inline bool
+lv2_state_store_write_turtle(const LV2_State_Store_Header* const header,
+                             const LV2_State_Store_Sink          sink,
+                             void* const                         stream,
+                             void* const                         window)
+{
+  const uint8_t* const               data = (const uint8_t*)header;
+  const LV2_State_Store_Entry* const entries =
+    (const LV2_State_Store_Entry*)(data + header->entries);
+
+  if (!lv2_state_store_puts(sink, stream, "[", 1U)) {
+    return false;
+  }
+
+  const char* sep = "\n\t<";
+  for (uint32_t i = 0U; i < header->n_entries; ++i) {
+    const LV2_State_Store_Entry* const entry = &entries[i];
+    const char* const key  = lv2_state_store_uri(header, entry->key);
+    const char* const type = lv2_state_store_uri(header, entry->type);
+    if (entry->flags & LV2_STATE_STORE_REMOVED) {
+      continue;
+    }
+
+    const bool compressed = (entry->flags & LV2_STATE_STORE_COMPRESSED);
+    if ((compressed && !window) ||
+        !lv2_state_store_puts(sink, stream, sep, strlen(sep)) ||
+        !lv2_state_store_puts(sink, stream, key, strlen(key)) ||
+        !lv2_state_store_puts(sink, stream, "> ", 2U) ||
+        !(compressed
+            ? lv2_state_store_write_compressed(sink,
+                                               stream,
+                                               type,
+                                               data + entry->offset,
+                                               (size_t)entry->size,
+                                               (uint8_t*)window)
+            : lv2_state_store_write_value(sink,
+                                          stream,
+                                          type,
+                                          data + entry->offset,
+                                          (size_t)entry->size))) {
+      return false;
+    }
+
+    sep = " ;\n\t<";
+  }
+
+  return lv2_state_store_puts(sink, stream, "\n]", 2U);
+}
+
+/**
+   @}
+*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_STORE_H
@@ -0,0 +1,244 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_STATE_SWAP_H
+#define LV2_STATE_SWAP_H
+
+/**
+   @file swap.h Restoring state without interrupting run().
+
+   Without state:threadSafeRestore, restore() may not be called while run()
+   is executing, so a host must stop processing an instance to load a preset
+   into it.  A plugin can avoid this by supporting state:threadSafeRestore,
+   and never touching the state used by run() in restore().  Instead,
+   restore() builds a complete new state object, and run() swaps it in
+   between blocks.  The old object is then freed by the worker, so run() never
+   allocates or frees memory.  A plugin typically:
+
+     - Calls lv2_state_swap_init() in instantiate() with its initial state
+       object, the work:schedule feature, and a function to free objects.
+
+     - In restore(), builds a new object from the retrieved properties, and
+       passes it to lv2_state_swap_submit().  Alternatively, restore() can
+       schedule work to build the object, and work() submits it.
+
+     - At the start of run(), calls lv2_state_swap_update(), then uses the
+       object returned by lv2_state_swap_current() for the whole block.
+
+     - In work(), first calls lv2_state_swap_work(), which frees old objects
+       and returns true if the request was one of its messages.
+
+     - In cleanup(), calls lv2_state_swap_cleanup().
+
+   If several objects are submitted before run() swaps one in, only the
+   latest is used, and the others are freed by lv2_state_swap_submit().
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup state_swap Swap
+   @ingroup state
+
+   Restoring state without interrupting run().
+
+   @{
+*/
+
+#include <lv2/atom/atom.h>
+#include <lv2/core/atomic.h>
+#include <lv2/urid/urid.h>
+#include <lv2/worker/worker.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   A function that frees a state object.
+*/
+typedef void (*LV2_State_Swap_Free_Function)(void* handle, void* object);
+
+/**
+   A worker request to free a state object.
+*/
+typedef struct {
+  LV2_Atom atom;   ///< Atom header with the type given to lv2_state_swap_init()
+  void*    object; ///< Object to free
+} LV2_State_Swap_Message;
+
+/**
+   A state object which is replaced between calls to run().
+*/
+typedef struct {
+  void* volatile               pending;     ///< Latest submitted object
+  void*                        current;     ///< Object used by run()
+  void*                        retired;     ///< Old object to send to worker
+  LV2_URID                     type;        ///< Atom type of messages
+  LV2_Worker_Schedule*         schedule;    ///< Worker schedule feature
+  LV2_State_Swap_Free_Function free_object; ///< Function to free objects
+  void*                        handle;      ///< Handle for `free_object`
+} LV2_State_Swap;
+
+/**
+   Initialise a swap.
+
+   @param swap Swap to initialise.
+   @param initial The initial state object.
+   @param type Atom type of messages, which must not be used for other
+   worker requests of the plugin, for example a URID of a plugin-specific
+   URI.
+   @param schedule Worker schedule feature passed to instantiate().
+   @param free_object Function to free objects.
+   @param handle Handle passed to `free_object`.
+*/
+static inline void
+lv2_state_swap_init(LV2_State_Swap* const              swap,
+                    void* const                        initial,
+                    const LV2_URID                     type,
+                    LV2_Worker_Schedule* const         schedule,
+                    const LV2_State_Swap_Free_Function free_object,
+                    void* const                        handle)
+{
+  swap->pending     = NULL;
+  swap->current     = initial;
+  swap->retired     = NULL;
+  swap->type        = type;
+  swap->schedule    = schedule;
+  swap->free_object = free_object;
+  swap->handle      = handle;
+}
+
+/**
+   Submit a new state object to be used by run().
+
+   This may be called from restore() or work(), concurrently with run(), but
+   not concurrently with itself.  If a previously submitted object has not
+   been swapped in yet, it is freed.
+*/
+static inline void
+lv2_state_swap_submit(LV2_State_Swap* const swap, void* const object)
+{
+  void* const superseded =
+    lv2_atomic_exchange_ptr((void* volatile*)&swap->pending, object);
+
+  if (superseded) {
+    swap->free_object(swap->handle, superseded);
+  }
+}
+
+/**
+   Swap in the latest submitted state object if there is one.
+
+   This must be called at the start of run(), before using the current
+   object.  It is realtime safe, and sends the replaced object to the worker
+   to be freed.  If the worker can not accept it, the swap is delayed until a
+   later call succeeds.
+
+   @return True if the current object was replaced.
+*/
+static inline bool
+lv2_state_swap_update(LV2_State_Swap* const swap)
+{
+  if (swap->retired) {
+    const LV2_State_Swap_Message msg = {
+      {(uint32_t)sizeof(void*), swap->type}, swap->retired};
+
+    if (swap->schedule->schedule_work(
+          swap->schedule->handle, (uint32_t)sizeof(msg), &msg)) {
+      return false;
+    }
+
+    swap->retired = NULL;
+  }
+
+  if (!lv2_atomic_load_ptr((void* const volatile*)&swap->pending)) {
+    return false;
+  }
+
+  swap->retired = swap->current;
+  swap->current =
+    lv2_atomic_exchange_ptr((void* volatile*)&swap->pending, NULL);
+
+  // Send the old object to the worker now if possible, or next time
+  const LV2_State_Swap_Message msg = {
+    {(uint32_t)sizeof(void*), swap->type}, swap->retired};
+  if (!swap->schedule->schedule_work(
+        swap->schedule->handle, (uint32_t)sizeof(msg), &msg)) {
+    swap->retired = NULL;
+  }
+
+  return true;
+}
+
+/**
+   Return the current state object for use in run().
+*/
+static inline void*
+lv2_state_swap_current(const LV2_State_Swap* const swap)
+{
+  return swap->current;
+}
+
+/**
+   Handle a worker request if it is a message from the swap.
+
+   This must be called in work() before handling other requests.
+
+   @return True if the request was handled.
+*/
+static inline bool
+lv2_state_swap_work(LV2_State_Swap* const swap,
+                    const uint32_t        size,
+                    const void* const     data)
+{
+  LV2_State_Swap_Message msg;
+  if (size != sizeof(msg)) {
+    return false;
+  }
+
+  memcpy(&msg, data, sizeof(msg));
+  if (msg.atom.type != swap->type || msg.atom.size != sizeof(void*)) {
+    return false;
+  }
+
+  swap->free_object(swap->handle, msg.object);
+  return true;
+}
+
+/**
+   Free every state object still held by a swap.
+
+   This must be called in cleanup(), after any pending worker requests.
+*/
+static inline void
+lv2_state_swap_cleanup(LV2_State_Swap* const swap)
+{
+  void* const objects[] = {swap->pending, swap->current, swap->retired};
+  for (size_t i = 0U; i < sizeof(objects) / sizeof(void*); ++i) {
+    if (objects[i]) {
+      swap->free_object(swap->handle, objects[i]);
+    }
+  }
+
+  swap->pending = NULL;
+  swap->current = NULL;
+  swap->retired = NULL;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_STATE_SWAP_H
@@ -0,0 +1,1364 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_WORKER_POOL_H
+#define LV2_WORKER_POOL_H
+
+/**
+   @file pool.h A reference worker scheduler shared by many plugin instances.
+
+   This is a host-side implementation of LV2_Worker_Schedule where a fixed
+   number of host threads serve the workers of any number of plugin instances.
+   Each instance has a slot with a wait-free single-producer single-consumer
+   request ring (written by run()), and a response ring (read by run()).  The
+   number of threads needed therefore scales with the number of cores, not
+   with the number of instances.
+
+   The host owns all threads and memory.  A typical host:
+
+     - Calls lv2_worker_pool_init() with an array of slot pointers.
+
+     - Starts one thread per core, each of which waits on a semaphore posted by
+       the pool's notify callback, then calls lv2_worker_pool_run_one() until
+       it returns false.
+
+     - For each instance, calls lv2_worker_pool_slot_init(), passes the slot's
+       `schedule` field as the data of the work:schedule feature (and
+       similarly for work:keyedSchedule and work:prioritySchedule), and adds
+       the slot with
+       lv2_worker_pool_add() before the instance is first run.
+
+     - Calls lv2_worker_pool_set_time() at the start of every cycle, and
+       lv2_worker_pool_deliver() after every call to run().
+
+   Calls to the work() method of any one instance are never concurrent,
+   unless the plugin supports the work:reentrant feature and the host calls
+   lv2_worker_pool_slot_set_reentrant().  Then, up to LV2_WORKER_POOL_N_LANES
+   requests of the instance may be executed at once, and their responses are
+   delivered in request order.  Instances with more urgent pending requests,
+   as scheduled with the work:prioritySchedule feature, are served first.
+
+   For offline rendering, the host can make a slot synchronous with
+   lv2_worker_pool_slot_set_synchronous().  Then work() is called immediately
+   in the thread that schedules it, usually in run(), without involving pool
+   threads.  Responses are still delivered by lv2_worker_pool_deliver().
+
+   For instrumentation, a host can set a clock with
+   lv2_worker_pool_set_clock(), and give each thread its own LV2_Worker_Stats
+   by calling lv2_worker_pool_run_one_measured() and
+   lv2_worker_pool_deliver_measured() instead.  Every request is then
+   timestamped when it is scheduled, started, responded to, and delivered, and
+   the latency of each stage is recorded in the histograms of the thread that
+   completes it.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup worker_pool Pool
+   @ingroup worker
+
+   A reference worker scheduler shared by many plugin instances.
+
+   @{
+*/
+
+#include <lv2/core/atomic.h>
+#include <lv2/core/lv2.h>
+#include <lv2/worker/stats.h>
+#include <lv2/worker/worker.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   Return the amount of memory needed for a slot with the given ring size.
+
+   This is enough for a request ring, a response ring, and a buffer for
+   delivering a single response.
+*/
+#define LV2_WORKER_POOL_SLOT_MEMORY(ring_size) (3U * (uint32_t)(ring_size))
+
+/**
+   The number of distinct keys a slot can track for keyed requests.
+
+   If a plugin uses more keys than this at once, additional keyed requests
+   are treated like unkeyed ones, and are never skipped.
+*/
+#define LV2_WORKER_POOL_N_KEYS 16U
+
+/**
+   The maximum number of concurrent work() calls for a re-entrant instance.
+*/
+#define LV2_WORKER_POOL_N_LANES 4U
+
+/**
+   A wait-free single-producer single-consumer ring of worker messages.
+
+   Each message is written as a 32-bit size followed by the message body.
+   The heads are free-running counters, so the used space is always their
+   difference.
+*/
+typedef struct {
+  uint8_t*          buf;        ///< Buffer of `size` bytes
+  uint32_t          size;       ///< Size of `buf` in bytes, a power of two
+  volatile uint32_t write_head; ///< Write counter, only set by the producer
+  volatile uint32_t read_head;  ///< Read counter, only set by the consumer
+} LV2_Worker_Ring;
+
+/**
+   The header of a request in a slot's request ring.
+*/
+typedef struct {
+  uint32_t key;      ///< Index of the key entry plus one, or zero if unkeyed
+  uint32_t seq;      ///< Sequence number of the request
+  uint64_t enqueued; ///< Time the request was scheduled
+} LV2_Worker_Pool_Request;
+
+/**
+   The header of a response in a slot's response ring.
+*/
+typedef struct {
+  uint64_t enqueued;  ///< Time the request was scheduled
+  uint64_t responded; ///< Time the response was sent
+} LV2_Worker_Pool_Response;
+
+/**
+   The state of a key used for keyed requests.
+
+   A request is stale if a request with a later sequence number has been
+   scheduled for the same key.  An entry can be reused for another key once
+   its latest request is done, since no requests for it are queued then.
+*/
+typedef struct {
+  uint32_t          key;    ///< Key, or zero if unused (set by run())
+  volatile uint32_t latest; ///< Latest scheduled sequence number
+  volatile uint32_t done;   ///< Latest finished sequence number
+} LV2_Worker_Pool_Key;
+
+/**
+   A response ring used by one job of a re-entrant instance at a time.
+
+   The response ring of a re-entrant slot is split into lanes, which jobs use
+   in turn, so the lane of a job follows from its position in request order.
+   Each job ends with an empty message, after which the audio thread moves on
+   to the lane of the next job.
+*/
+typedef struct {
+  LV2_Worker_Ring   ring;   ///< Responses of the jobs using this lane
+  volatile uint32_t active; ///< Non-zero while a job is using the lane
+} LV2_Worker_Pool_Lane;
+
+/**
+   A job being executed, which is the respond handle passed to work().
+*/
+typedef struct {
+  struct LV2_Worker_Pool_Slot* slot;     ///< Slot the job is for
+  LV2_Worker_Pool_Lane*        lane;     ///< Lane for responses, or NULL
+  uint32_t                     key;      ///< Index of key entry plus one, or 0
+  uint32_t                     seq;      ///< Sequence number of the request
+  uint64_t                     enqueued; ///< Time the request was scheduled
+  uint64_t                     started;  ///< Time work() was called
+  LV2_Worker_Stats*            stats;    ///< Stats of the thread, or NULL
+} LV2_Worker_Pool_Job;
+
+/**
+   A plugin instance's entry in a worker pool.
+*/
+typedef struct LV2_Worker_Pool_Slot {
+  LV2_Worker_Schedule          schedule;          ///< work:schedule
+  LV2_Worker_Keyed_Schedule    keyed_schedule;    ///< work:keyedSchedule
+  LV2_Worker_Priority_Schedule priority_schedule; ///< work:prioritySchedule
+  struct LV2_Worker_Pool*      pool;              ///< Pool slot is added to
+  LV2_Handle                   instance;          ///< Plugin instance
+  const LV2_Worker_Interface*  iface;             ///< Plugin worker interface
+  LV2_Worker_Ring              requests;          ///< Requests to work()
+  LV2_Worker_Ring              responses;         ///< Responses to run()
+  uint8_t*                     message;           ///< Buffer for delivery
+  volatile uint32_t            busy;              ///< Non-zero while claimed
+  volatile uint32_t            priority;          ///< Highest pending priority
+  volatile uint32_t            deadline;          ///< Earliest pending deadline
+  uint32_t                     next_seq;          ///< Next sequence number
+  volatile uint32_t            next_job;          ///< Next job to start
+  uint32_t                     next_delivery;     ///< Next job to deliver
+  bool                         synchronous;       ///< Run work() immediately
+  bool                         reentrant;         ///< Run work() concurrently
+
+  /// State of keys used for keyed requests
+  LV2_Worker_Pool_Key keys[LV2_WORKER_POOL_N_KEYS];
+
+  /// Response lanes for concurrent jobs of a re-entrant instance
+  LV2_Worker_Pool_Lane lanes[LV2_WORKER_POOL_N_LANES];
+} LV2_Worker_Pool_Slot;
+
+/**
+   Notification function called when a request has been scheduled.
+
+   This is called in the audio thread, so it must be realtime safe, for
+   example posting a semaphore.
+*/
+typedef void (*LV2_Worker_Pool_Notify_Function)(void* handle);
+
+/**
+   Clock function used to timestamp requests for instrumentation.
+
+   This is called in the audio thread and pool threads, so it must be realtime
+   safe and thread safe, and return a monotonic time, for example in
+   nanoseconds.  Latencies are recorded in the same unit.
+*/
+typedef uint64_t (*LV2_Worker_Pool_Clock_Function)(void* handle);
+
+/**
+   A pool of worker slots which are served by host threads.
+*/
+typedef struct LV2_Worker_Pool {
+  LV2_Worker_Pool_Slot**          slots;         ///< Array of slot pointers
+  uint32_t                        n_slots;       ///< Capacity of `slots`
+  volatile uint32_t               n_pending;     ///< Requests not yet started
+  volatile uint32_t               cursor;        ///< Next slot search start
+  volatile uint32_t               time;          ///< Current time in frames
+  LV2_Worker_Pool_Notify_Function notify;        ///< Request notification
+  void*                           notify_handle; ///< Handle for `notify`
+  LV2_Worker_Pool_Clock_Function  clock;         ///< Clock, or NULL
+  void*                           clock_handle;  ///< Handle for `clock`
+  volatile uint32_t               epoch;         ///< Incremented by remove
+  volatile uint32_t               n_claims[2];   ///< Claims by epoch parity
+} LV2_Worker_Pool;
+
+/**
+   @name Ring
+   @{
+*/
+
+/**
+   Initialise a ring to use a user-provided buffer.
+
+   @param ring Ring to initialise.
+   @param buf Buffer of `size` bytes.
+   @param size Size of `buf`, which must be a power of two of at least 8.
+   @return True on success, or false if `size` is invalid.
+*/
+static inline bool
+lv2_worker_ring_init(LV2_Worker_Ring* const ring,
+                     void* const            buf,
+                     const uint32_t         size)
+{
+  if (size < 8U || (size & (size - 1U))) {
+    return false;
+  }
+
+  ring->buf        = (uint8_t*)buf;
+  ring->size       = size;
+  ring->write_head = 0U;
+  ring->read_head  = 0U;
+  return true;
+}
+
+/** Return the number of bytes available to read from a ring. */
+static inline uint32_t
+lv2_worker_ring_read_space(const LV2_Worker_Ring* const ring)
+{
+  return lv2_atomic_load(&ring->write_head) - lv2_atomic_load(&ring->read_head);
+}
+
+/** Return the number of bytes available to write to a ring. */
+static inline uint32_t
+lv2_worker_ring_write_space(const LV2_Worker_Ring* const ring)
+{
+  return ring->size - lv2_worker_ring_read_space(ring);
+}
+
+/** Copy `size` bytes into a ring starting at counter `head`. */
+static inline void
+lv2_worker_ring_copy_in(LV2_Worker_Ring* const ring,
+                        const uint32_t         head,
+                        const uint32_t         size,
+                        const void* const      data)
+{
+  const uint32_t offset = head & (ring->size - 1U);
+  const uint32_t first  = ring->size - offset;
+  if (size <= first) {
+    memcpy(ring->buf + offset, data, size);
+  } else {
+    memcpy(ring->buf + offset, data, first);
+    memcpy(ring->buf, (const uint8_t*)data + first, size - first);
+  }
+}
+
+/** Copy `size` bytes out of a ring starting at counter `head`. */
+static inline void
+lv2_worker_ring_copy_out(const LV2_Worker_Ring* const ring,
+                         const uint32_t               head,
+                         const uint32_t               size,
+                         void* const                  data)
+{
+  const uint32_t offset = head & (ring->size - 1U);
+  const uint32_t first  = ring->size - offset;
+  if (size <= first) {
+    memcpy(data, ring->buf + offset, size);
+  } else {
+    memcpy(data, ring->buf + offset, first);
+    memcpy((uint8_t*)data + first, ring->buf, size - first);
+  }
+}
+
+/**
+   Write a message made of a header and a body to a ring.
+
+   This is wait-free and realtime safe, but must only be called by the single
+   producer of the ring.  The message is written entirely, or not at all, and
+   is read as a single message of `head_size` + `body_size` bytes.
+
+   @return LV2_WORKER_SUCCESS, or LV2_WORKER_ERR_NO_SPACE if the ring is full.
+*/
+static inline LV2_Worker_Status
+lv2_worker_ring_write_parts(LV2_Worker_Ring* const ring,
+                            const uint32_t         head_size,
+                            const void* const      head_data,
+                            const uint32_t         body_size,
+                            const void* const      body_data)
+{
+  const uint32_t head  = ring->write_head;
+  const uint32_t used  = head - lv2_atomic_load(&ring->read_head);
+  const uint32_t space = ring->size - used;
+  const uint32_t size  = head_size + body_size;
+  if (space < sizeof(uint32_t) || size > space - sizeof(uint32_t) ||
+      size < body_size) {
+    return LV2_WORKER_ERR_NO_SPACE;
+  }
+
+  lv2_worker_ring_copy_in(ring, head, sizeof(uint32_t), &size);
+  if (head_size) {
+    lv2_worker_ring_copy_in(
+      ring, head + (uint32_t)sizeof(uint32_t), head_size, head_data);
+  }
+
+  if (body_size) {
+    lv2_worker_ring_copy_in(ring,
+                            head + (uint32_t)sizeof(uint32_t) + head_size,
+                            body_size,
+                            body_data);
+  }
+
+  lv2_atomic_store(&ring->write_head, head + (uint32_t)sizeof(uint32_t) + size);
+  return LV2_WORKER_SUCCESS;
+}
+
+/**
+   Write a message to a ring.
+
+   This is wait-free and realtime safe, but must only be called by the single
+   producer of the ring.  The message is written entirely, or not at all.
+
+   @return LV2_WORKER_SUCCESS, or LV2_WORKER_ERR_NO_SPACE if the ring is full.
+*/
+static inline LV2_Worker_Status
+lv2_worker_ring_write(LV2_Worker_Ring* const ring,
+                      const uint32_t         size,
+                      const void* const      data)
+{
+  return lv2_worker_ring_write_parts(ring, 0U, NULL, size, data);
+}
+
+/**
+   Read a message from a ring.
+
+   This is wait-free and realtime safe, but must only be called by the single
+   consumer of the ring.  A message larger than `capacity` is discarded, which
+   can not happen if `capacity` is at least the size of the ring.
+
+   @param ring Ring to read from.
+   @param capacity Size of `buf` in bytes.
+   @param buf Buffer to copy the message body into.
+   @param size Set to the size of the message body.
+   @return True if a message was read.
+*/
+static inline bool
+lv2_worker_ring_read(LV2_Worker_Ring* const ring,
+                     const uint32_t         capacity,
+                     void* const            buf,
+                     uint32_t* const        size)
+{
+  const uint32_t head  = ring->read_head;
+  const uint32_t avail = lv2_atomic_load(&ring->write_head) - head;
+  if (avail < sizeof(uint32_t)) {
+    return false;
+  }
+
+  uint32_t body_size = 0U;
+  lv2_worker_ring_copy_out(ring, head, sizeof(uint32_t), &body_size);
+  *size = body_size <= capacity ? body_size : 0U;
+  if (*size) {
+    lv2_worker_ring_copy_out(ring, head + sizeof(uint32_t), *size, buf);
+  }
+
+  lv2_atomic_store(&ring->read_head,
+                   head + (uint32_t)sizeof(uint32_t) + body_size);
+  return true;
+}
+
+/**
+   Discard a message from a ring.
+
+   This is wait-free and realtime safe, but must only be called by the single
+   consumer of the ring.
+
+   @return True if a message was discarded.
+*/
+static inline bool
+lv2_worker_ring_skip(LV2_Worker_Ring* const ring)
+{
+  const uint32_t head  = ring->read_head;
+  const uint32_t avail = lv2_atomic_load(&ring->write_head) - head;
+  if (avail < sizeof(uint32_t)) {
+    return false;
+  }
+
+  uint32_t body_size = 0U;
+  lv2_worker_ring_copy_out(ring, head, sizeof(uint32_t), &body_size);
+  lv2_atomic_store(&ring->read_head,
+                   head + (uint32_t)sizeof(uint32_t) + body_size);
+  return true;
+}
+
+/**
+   @}
+   @name Slots
+   @{
+*/
+
+/**
+   Return the current time of a pool's clock.
+
+   @return The time, or zero if `pool` is NULL or has no clock.
+*/
+static inline uint64_t
+lv2_worker_pool_now(const struct LV2_Worker_Pool* const pool)
+{
+  return (pool && pool->clock) ? pool->clock(pool->clock_handle) : 0U;
+}
+
+/**
+   Send a response from work() to run().
+
+   This is the respond function passed to LV2_Worker_Interface::work(), with
+   an LV2_Worker_Pool_Job as the handle.
+*/
+static inline LV2_Worker_Status
+lv2_worker_pool_respond(LV2_Worker_Respond_Handle handle,
+                        const uint32_t            size,
+                        const void* const         data)
+{
+  const LV2_Worker_Pool_Job* const job = (const LV2_Worker_Pool_Job*)handle;
+  const uint64_t                   now = lv2_worker_pool_now(job->slot->pool);
+
+  LV2_Worker_Ring* ring = &job->slot->responses;
+  if (job->lane) {
+    // Leave space for the empty message that ends the job
+    const uint32_t needed =
+      (uint32_t)(2U * sizeof(uint32_t) + sizeof(LV2_Worker_Pool_Response));
+
+    ring                 = &job->lane->ring;
+    const uint32_t space = lv2_worker_ring_write_space(ring);
+    if (space < needed || size > space - needed) {
+      return LV2_WORKER_ERR_NO_SPACE;
+    }
+  }
+
+  const LV2_Worker_Pool_Response response = {job->enqueued, now};
+  const LV2_Worker_Status        st       = lv2_worker_ring_write_parts(
+    ring, sizeof(response), &response, size, data);
+
+  if (!st && now) {
+    lv2_worker_stats_record(
+      job->stats, LV2_WORKER_STAGE_WORKING, job->started, now);
+  }
+
+  return st;
+}
+
+/** Return true if a request has been superseded by a later one. */
+static inline bool
+lv2_worker_pool_key_is_stale(const LV2_Worker_Pool_Key* const entry,
+                             const uint32_t                   seq)
+{
+  return (int32_t)(lv2_atomic_load(&entry->latest) - seq) > 0;
+}
+
+/**
+   Record that a keyed request has finished.
+
+   Requests of re-entrant instances may finish out of order, so this only
+   advances the latest finished sequence number.
+*/
+static inline void
+lv2_worker_pool_key_finish(LV2_Worker_Pool_Key* const entry,
+                           const uint32_t             seq)
+{
+  uint32_t done = lv2_atomic_load(&entry->done);
+  while ((int32_t)(seq - done) > 0 &&
+         !lv2_atomic_cas(&entry->done, done, seq)) {
+    done = lv2_atomic_load(&entry->done);
+  }
+}
+
+/**
+   Return true if a slot can start another job.
+
+   This is always true unless the slot is re-entrant and the lane of the next
+   job is still in use, or still holds messages of an earlier job which have
+   not been delivered.  A job therefore always starts with an empty lane, so
+   the message that ends it always fits.
+*/
+static inline bool
+lv2_worker_pool_lane_free(const struct LV2_Worker_Pool_Slot* const slot)
+{
+  if (!slot->reentrant) {
+    return true;
+  }
+
+  const uint32_t                    next = lv2_atomic_load(&slot->next_job);
+  const LV2_Worker_Pool_Lane* const lane =
+    &slot->lanes[next % LV2_WORKER_POOL_N_LANES];
+
+  return !lv2_atomic_load(&lane->active) &&
+         !lv2_worker_ring_read_space(&lane->ring);
+}
+
+/**
+   Acquire the lane of the next job of a re-entrant slot.
+
+   This must only be called by the thread that has claimed the slot (or the
+   audio thread, for synchronous slots), after checking that the lane is free
+   with lv2_worker_pool_lane_free().
+*/
+static inline LV2_Worker_Pool_Lane*
+lv2_worker_pool_lane_acquire(struct LV2_Worker_Pool_Slot* const slot)
+{
+  const uint32_t              next = lv2_atomic_load(&slot->next_job);
+  LV2_Worker_Pool_Lane* const lane =
+    &slot->lanes[next % LV2_WORKER_POOL_N_LANES];
+
+  lv2_atomic_store(&lane->active, 1U);
+  lv2_atomic_store(&slot->next_job, next + 1U);
+  return lane;
+}
+
+/**
+   Release a lane after a job has finished.
+
+   This writes the empty message that ends the job, which fits because the
+   lane was empty when the job started, and responses leave space for it.
+
+   @return LV2_WORKER_SUCCESS, or LV2_WORKER_ERR_NO_SPACE if the end of the
+   job could not be written, in which case the lane is still active.
+*/
+static inline LV2_Worker_Status
+lv2_worker_pool_lane_release(LV2_Worker_Pool_Lane* const lane)
+{
+  const LV2_Worker_Status st = lv2_worker_ring_write(&lane->ring, 0U, NULL);
+  if (!st) {
+    lv2_atomic_store(&lane->active, 0U);
+  }
+
+  return st;
+}
+
+/**
+   Return true if absolute deadline `a` is before deadline `b`.
+
+   Deadlines are compared relative to the current time `now`, so that the
+   frame counter can wrap around.  No deadline is after every deadline.
+*/
+static inline bool
+lv2_worker_pool_deadline_before(const uint32_t a,
+                                const uint32_t b,
+                                const uint32_t now)
+{
+  if (a == LV2_WORKER_NO_DEADLINE) {
+    return false;
+  }
+
+  if (b == LV2_WORKER_NO_DEADLINE) {
+    return true;
+  }
+
+  return (int32_t)(a - now) < (int32_t)(b - now);
+}
+
+/**
+   Raise the urgency of a slot for a new request.
+
+   The priority and deadline of a slot are hints for choosing which slot to
+   serve next.  They are raised by run() for every request, and reset by pool
+   threads when the request ring becomes empty.
+*/
+static inline void
+lv2_worker_pool_raise(LV2_Worker_Pool_Slot* const slot,
+                      const uint32_t              priority,
+                      const uint32_t              deadline,
+                      const uint32_t              now)
+{
+  uint32_t current = lv2_atomic_load(&slot->priority);
+  while (priority > current &&
+         !lv2_atomic_cas(&slot->priority, current, priority)) {
+    current = lv2_atomic_load(&slot->priority);
+  }
+
+  current = lv2_atomic_load(&slot->deadline);
+  while (lv2_worker_pool_deadline_before(deadline, current, now) &&
+         !lv2_atomic_cas(&slot->deadline, current, deadline)) {
+    current = lv2_atomic_load(&slot->deadline);
+  }
+}
+
+/**
+   Reset the urgency of a slot if it has no pending requests.
+
+   This is called by the thread that has claimed the slot after reading a
+   request.  If run() schedules a request concurrently, then the reset either
+   fails, or leaves the slot less urgent than it should be until it is empty
+   again, which only affects the order that slots are served in.
+*/
+static inline void
+lv2_worker_pool_settle(LV2_Worker_Pool_Slot* const slot)
+{
+  const uint32_t priority = lv2_atomic_load(&slot->priority);
+  const uint32_t deadline = lv2_atomic_load(&slot->deadline);
+  if (!lv2_worker_ring_read_space(&slot->requests)) {
+    lv2_atomic_cas(&slot->priority, priority, LV2_WORKER_PRIORITY_BACKGROUND);
+    lv2_atomic_cas(&slot->deadline, deadline, LV2_WORKER_NO_DEADLINE);
+  }
+}
+
+/**
+   Execute a request immediately in the calling thread.
+
+   This is used instead of scheduling requests for synchronous slots.
+*/
+static inline LV2_Worker_Status
+lv2_worker_pool_execute(LV2_Worker_Pool_Slot* const slot,
+                        const uint32_t              size,
+                        const void* const           data)
+{
+  if (!lv2_worker_pool_lane_free(slot)) {
+    return LV2_WORKER_ERR_NO_SPACE;
+  }
+
+  LV2_Worker_Pool_Lane* const lane =
+    slot->reentrant ? lv2_worker_pool_lane_acquire(slot) : NULL;
+
+  const uint64_t      now = lv2_worker_pool_now(slot->pool);
+  LV2_Worker_Pool_Job job = {slot, lane, 0U, 0U, now, now, NULL};
+
+  const LV2_Worker_Status st = slot->iface->work(
+    slot->instance, lv2_worker_pool_respond, &job, size, data);
+
+  const LV2_Worker_Status end =
+    lane ? lv2_worker_pool_lane_release(lane) : LV2_WORKER_SUCCESS;
+
+  return st ? st : end;
+}
+
+/**
+   Add a request to a slot's request ring and notify the pool.
+
+   @param slot Slot to schedule the request for.
+   @param key Index of the key entry plus one, or zero if unkeyed.
+   @param seq Sequence number of the request.
+   @param priority Priority class of the request.
+   @param deadline Deadline in frames relative to the pool time.
+   @param size Size of `data` in bytes.
+   @param data Request body.
+*/
+static inline LV2_Worker_Status
+lv2_worker_pool_enqueue(LV2_Worker_Pool_Slot* const slot,
+                        const uint32_t              key,
+                        const uint32_t              seq,
+                        const uint32_t              priority,
+                        const uint32_t              deadline,
+                        const uint32_t              size,
+                        const void* const           data)
+{
+  LV2_Worker_Pool* const pool = slot->pool;
+  if (!pool) {
+    return LV2_WORKER_ERR_UNKNOWN;
+  }
+
+  // Make the urgency visible before the request, which is only a hint
+  const uint32_t now      = lv2_atomic_load(&pool->time);
+  uint32_t       absolute = LV2_WORKER_NO_DEADLINE;
+  if (deadline != LV2_WORKER_NO_DEADLINE) {
+    absolute = now + deadline;
+    absolute -= (absolute == LV2_WORKER_NO_DEADLINE) ? 1U : 0U;
+  }
+
+  lv2_worker_pool_raise(slot, priority, absolute, now);
+
+  // Count the request first so that the pending count is never too low
+  lv2_atomic_add(&pool->n_pending, 1U);
+
+  const LV2_Worker_Pool_Request request = {key, seq, lv2_worker_pool_now(pool)};
+  const LV2_Worker_Status       st      = lv2_worker_ring_write_parts(
+    &slot->requests, sizeof(request), &request, size, data);
+
+  if (st) {
+    lv2_atomic_sub(&pool->n_pending, 1U);
+  } else if (pool->notify) {
+    pool->notify(pool->notify_handle);
+  }
+
+  return st;
+}
+
+/**
+   Schedule work for a slot.
+
+   This is the LV2_Worker_Schedule::schedule_work() implementation used by
+   slots.  It is realtime safe if the pool's notify function is.  If the slot
+   is synchronous, then work() is called immediately in the calling thread.
+*/
+static inline LV2_Worker_Status
+lv2_worker_pool_schedule(LV2_Worker_Schedule_Handle handle,
+                         const uint32_t             size,
+                         const void* const          data)
+{
+  LV2_Worker_Pool_Slot* const slot = (LV2_Worker_Pool_Slot*)handle;
+  if (slot->synchronous) {
+    return lv2_worker_pool_execute(slot, size, data);
+  }
+
+  return lv2_worker_pool_enqueue(slot,
+                                 0U,
+                                 slot->next_seq++,
+                                 LV2_WORKER_PRIORITY_NORMAL,
+                                 LV2_WORKER_NO_DEADLINE,
+                                 size,
+                                 data);
+}
+
+/**
+   Schedule keyed work for a slot.
+
+   This is the LV2_Worker_Keyed_Schedule::schedule_keyed_work()
+   implementation used by slots.  The request is enqueued like any other, and
+   then marked as the latest for its key, so that any earlier requests with
+   the same key are skipped by pool threads.
+*/
+static inline LV2_Worker_Status
+lv2_worker_pool_schedule_keyed(LV2_Worker_Schedule_Handle handle,
+                               const uint32_t             key,
+                               const uint32_t             size,
+                               const void* const          data)
+{
+  LV2_Worker_Pool_Slot* const slot = (LV2_Worker_Pool_Slot*)handle;
+  if (slot->synchronous) {
+    return lv2_worker_pool_execute(slot, size, data);
+  }
+
+  // Find the entry for this key, or an unused one
+  uint32_t index = 0U;
+  uint32_t free  = 0U;
+  for (uint32_t i = 0U; key && i < LV2_WORKER_POOL_N_KEYS; ++i) {
+    const LV2_Worker_Pool_Key* const entry = &slot->keys[i];
+    if (entry->key == key) {
+      index = i + 1U;
+      break;
+    }
+
+    if (!free &&
+        (!entry->key || lv2_atomic_load(&entry->done) == entry->latest)) {
+      free = i + 1U;
+    }
+  }
+
+  if (!index && free) {
+    index                     = free;
+    slot->keys[free - 1U].key = key;
+  }
+
+  // Enqueue first, so stale requests are only skipped if this succeeds
+  const uint32_t          seq    = slot->next_seq++;
+  const uint32_t          normal = LV2_WORKER_PRIORITY_NORMAL;
+  const LV2_Worker_Status st     = lv2_worker_pool_enqueue(
+    slot, index, seq, normal, LV2_WORKER_NO_DEADLINE, size, data);
+
+  if (!st && index) {
+    lv2_atomic_store(&slot->keys[index - 1U].latest, seq);
+  }
+
+  return st;
+}
+
+/**
+   Schedule prioritized work for a slot.
+
+   This is the LV2_Worker_Priority_Schedule::schedule_prioritized_work()
+   implementation used by slots.
+*/
+static inline LV2_Worker_Status
+lv2_worker_pool_schedule_prioritized(LV2_Worker_Schedule_Handle handle,
+                                     const LV2_Worker_Priority  priority,
+                                     const uint32_t             deadline,
+                                     const uint32_t             size,
+                                     const void* const          data)
+{
+  LV2_Worker_Pool_Slot* const slot = (LV2_Worker_Pool_Slot*)handle;
+  if (slot->synchronous) {
+    return lv2_worker_pool_execute(slot, size, data);
+  }
+
+  const uint32_t clamped = (priority > LV2_WORKER_PRIORITY_URGENT)
+                             ? (uint32_t)LV2_WORKER_PRIORITY_URGENT
+                             : (uint32_t)priority;
+
+  return lv2_worker_pool_enqueue(
+    slot, 0U, slot->next_seq++, clamped, deadline, size, data);
+}
+
+/**
+   Return true if the request being worked on has been superseded.
+
+   This is the LV2_Worker_Keyed_Schedule::superseded() implementation used by
+   slots.
+*/
+static inline bool
+lv2_worker_pool_superseded(LV2_Worker_Schedule_Handle handle,
+                           LV2_Worker_Respond_Handle  respond_handle)
+{
+  const LV2_Worker_Pool_Slot* const slot = (const LV2_Worker_Pool_Slot*)handle;
+  const LV2_Worker_Pool_Job* const  job =
+    (const LV2_Worker_Pool_Job*)respond_handle;
+
+  return job->key &&
+         lv2_worker_pool_key_is_stale(&slot->keys[job->key - 1U], job->seq);
+}
+
+/**
+   Initialise a slot for a plugin instance.
+
+   The slot is not used by any pool until it is added with
+   lv2_worker_pool_add(), but the `schedule` field can be passed to the
+   plugin as the work:schedule feature before then, since plugins may not
+   schedule work until run() is called.
+
+   @param slot Slot to initialise.
+   @param instance Plugin instance, which may be set later.
+   @param iface Plugin worker interface, which may be set later.
+   @param memory Buffer of LV2_WORKER_POOL_SLOT_MEMORY(`ring_size`) bytes.
+   @param ring_size Size of each ring, a power of two of at least 8.
+   @return True on success, or false if `ring_size` is invalid.
+*/
+static inline bool
+lv2_worker_pool_slot_init(LV2_Worker_Pool_Slot* const       slot,
+                          const LV2_Handle                  instance,
+                          const LV2_Worker_Interface* const iface,
+                          void* const                       memory,
+                          const uint32_t                    ring_size)
+{
+  uint8_t* const mem = (uint8_t*)memory;
+
+  memset(slot, 0, sizeof(LV2_Worker_Pool_Slot));
+  slot->schedule.handle                    = slot;
+  slot->schedule.schedule_work             = lv2_worker_pool_schedule;
+  slot->keyed_schedule.handle              = slot;
+  slot->keyed_schedule.schedule_keyed_work = lv2_worker_pool_schedule_keyed;
+  slot->keyed_schedule.superseded          = lv2_worker_pool_superseded;
+  slot->priority_schedule.handle           = slot;
+  slot->priority_schedule.schedule_prioritized_work =
+    lv2_worker_pool_schedule_prioritized;
+  slot->instance = instance;
+  slot->iface    = iface;
+  slot->message  = mem + (2U * (size_t)ring_size);
+  slot->priority = LV2_WORKER_PRIORITY_BACKGROUND;
+  slot->deadline = LV2_WORKER_NO_DEADLINE;
+  slot->next_seq = 1U;
+
+  return lv2_worker_ring_init(&slot->requests, mem, ring_size) &&
+         lv2_worker_ring_init(&slot->responses, mem + ring_size, ring_size);
+}
+
+/**
+   Allow concurrent work() calls for a slot's instance.
+
+   This should only be called if the plugin supports the work:reentrant
+   feature, after lv2_worker_pool_slot_init() and before the slot is added to
+   a pool.  The response ring is split into LV2_WORKER_POOL_N_LANES lanes, so
+   the largest possible response is smaller than for other slots.
+
+   @return True on success, or false if the lanes would be too small to hold
+   an empty response and the end of a job, that is, if the ring size is less
+   than 32 * LV2_WORKER_POOL_N_LANES.
+*/
+static inline bool
+lv2_worker_pool_slot_set_reentrant(LV2_Worker_Pool_Slot* const slot)
+{
+  const uint32_t size = slot->responses.size / LV2_WORKER_POOL_N_LANES;
+  if (size < 2U * sizeof(uint32_t) + sizeof(LV2_Worker_Pool_Response)) {
+    return false;
+  }
+
+  for (uint32_t i = 0U; i < LV2_WORKER_POOL_N_LANES; ++i) {
+    if (!lv2_worker_ring_init(
+          &slot->lanes[i].ring, slot->responses.buf + (i * size), size)) {
+      return false;
+    }
+  }
+
+  slot->reentrant = true;
+  return true;
+}
+
+/**
+   Set whether work() is called immediately when work is scheduled for a slot.
+
+   This is intended for offline rendering, where it is fine for run() to
+   block.  It must only be called in the audio thread, between calls to run(),
+   while no requests of the slot are pending or being executed, since a
+   request already in the ring would otherwise run concurrently with
+   synchronous work.
+*/
+static inline void
+lv2_worker_pool_slot_set_synchronous(LV2_Worker_Pool_Slot* const slot,
+                                     const bool                  synchronous)
+{
+  slot->synchronous = synchronous;
+}
+
+/**
+   Pass a response in a slot's message buffer to the plugin.
+
+   @param slot Slot with a response of `size` bytes in its message buffer.
+   @param size Size of the response, including the header.
+   @param stats Stats to record latencies in, or NULL.
+   @param now Current time, which is set by the first call that needs it.
+*/
+static inline void
+lv2_worker_pool_dispatch(LV2_Worker_Pool_Slot* const slot,
+                         const uint32_t              size,
+                         LV2_Worker_Stats* const     stats,
+                         uint64_t* const             now)
+{
+  LV2_Worker_Pool_Response response = {0U, 0U};
+  const uint32_t           header   = (uint32_t)sizeof(response);
+  if (size < header) {
+    return;
+  }
+
+  memcpy(&response, slot->message, header);
+  slot->iface->work_response(
+    slot->instance, size - header, slot->message + header);
+
+  if (stats && response.responded) {
+    *now = *now ? *now : lv2_worker_pool_now(slot->pool);
+    lv2_worker_stats_record(
+      stats, LV2_WORKER_STAGE_RESPONDING, response.responded, *now);
+    lv2_worker_stats_record(
+      stats, LV2_WORKER_STAGE_ROUND_TRIP, response.enqueued, *now);
+  }
+}
+
+/**
+   Deliver all pending responses to a slot's instance and record latencies.
+
+   This is like lv2_worker_pool_deliver(), but if the pool has a clock, the
+   latencies of delivered responses are recorded in `stats`, which must only
+   be written by the calling thread.
+*/
+static inline void
+lv2_worker_pool_deliver_measured(LV2_Worker_Pool_Slot* const slot,
+                                 LV2_Worker_Stats* const     stats)
+{
+  uint64_t now  = 0U;
+  uint32_t size = 0U;
+
+  if (slot->reentrant) {
+    // Deliver the responses of each job in turn, until one is unfinished
+    uint32_t ends[LV2_WORKER_POOL_N_LANES];
+    for (uint32_t i = 0U; i < LV2_WORKER_POOL_N_LANES; ++i) {
+      ends[i] = lv2_atomic_load(&slot->lanes[i].ring.write_head);
+    }
+
+    for (;;) {
+      const uint32_t   index = slot->next_delivery % LV2_WORKER_POOL_N_LANES;
+      LV2_Worker_Ring* ring  = &slot->lanes[index].ring;
+      if (ring->read_head == ends[index] ||
+          !lv2_worker_ring_read(ring, ring->size, slot->message, &size)) {
+        break;
+      }
+
+      if (size) {
+        lv2_worker_pool_dispatch(slot, size, stats, &now);
+      } else {
+        ++slot->next_delivery;
+      }
+    }
+  } else {
+    LV2_Worker_Ring* const ring = &slot->responses;
+    const uint32_t         end  = lv2_atomic_load(&ring->write_head);
+
+    while (ring->read_head != end &&
+           lv2_worker_ring_read(ring, ring->size, slot->message, &size)) {
+      lv2_worker_pool_dispatch(slot, size, stats, &now);
+    }
+  }
+
+  if (slot->iface->end_run) {
+    slot->iface->end_run(slot->instance);
+  }
+}
+
+/**
+   Deliver all pending responses to a slot's instance.
+
+   This must be called in the audio thread after every call to run().  It
+   calls the plugin's work_response() for every response that was available
+   when it was called, then end_run() if the plugin provides it.
+*/
+static inline void
+lv2_worker_pool_deliver(LV2_Worker_Pool_Slot* const slot)
+{
+  lv2_worker_pool_deliver_measured(slot, NULL);
+}
+
+/**
+   @}
+   @name Pool
+   @{
+*/
+
+/**
+   Initialise a worker pool.
+
+   @param pool Pool to initialise.
+   @param slots Array of `n_slots` slot pointers, which will be cleared.
+   @param n_slots Maximum number of slots in the pool.
+   @param notify Function called whenever work is scheduled, or NULL.
+   @param notify_handle Handle passed to `notify`.
+*/
+static inline void
+lv2_worker_pool_init(LV2_Worker_Pool* const                pool,
+                     LV2_Worker_Pool_Slot** const          slots,
+                     const uint32_t                        n_slots,
+                     const LV2_Worker_Pool_Notify_Function notify,
+                     void* const                           notify_handle)
+{
+  memset(slots, 0, n_slots * sizeof(LV2_Worker_Pool_Slot*));
+  pool->slots         = slots;
+  pool->n_slots       = n_slots;
+  pool->n_pending     = 0U;
+  pool->cursor        = 0U;
+  pool->time          = 0U;
+  pool->notify        = notify;
+  pool->notify_handle = notify_handle;
+  pool->clock         = NULL;
+  pool->clock_handle  = NULL;
+  pool->epoch         = 0U;
+  pool->n_claims[0]   = 0U;
+  pool->n_claims[1]   = 0U;
+}
+
+/**
+   Set the clock used to timestamp requests for instrumentation.
+
+   This must be called before any slots are added.  Without a clock, which is
+   the default, requests are not timestamped and no latencies are recorded.
+*/
+static inline void
+lv2_worker_pool_set_clock(LV2_Worker_Pool* const               pool,
+                          const LV2_Worker_Pool_Clock_Function clock,
+                          void* const                          clock_handle)
+{
+  pool->clock        = clock;
+  pool->clock_handle = clock_handle;
+}
+
+/**
+   Add a slot to a pool.
+
+   This may be called while pool threads are running, but not concurrently
+   with lv2_worker_pool_remove().
+
+   @return True on success, or false if the pool is full.
+*/
+static inline bool
+lv2_worker_pool_add(LV2_Worker_Pool* const      pool,
+                    LV2_Worker_Pool_Slot* const slot)
+{
+  for (uint32_t i = 0U; i < pool->n_slots; ++i) {
+    if (!lv2_atomic_load_ptr((void* const volatile*)&pool->slots[i])) {
+      slot->pool = pool;
+      lv2_atomic_store_ptr((void* volatile*)&pool->slots[i], slot);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+   Remove a slot from a pool.
+
+   Any requests which have not been started are discarded.  This is not
+   realtime safe, and spins until any pool threads that may still refer to the
+   slot are finished with it, including any work() calls, so the slot may be
+   freed as soon as this returns.  This may be called while pool threads are
+   running, but not concurrently with lv2_worker_pool_add() or another call
+   to lv2_worker_pool_remove(), or with run() for the slot's instance.
+*/
+static inline void
+lv2_worker_pool_remove(LV2_Worker_Pool* const      pool,
+                       LV2_Worker_Pool_Slot* const slot)
+{
+  for (uint32_t i = 0U; i < pool->n_slots; ++i) {
+    if (lv2_atomic_load_ptr((void* const volatile*)&pool->slots[i]) == slot) {
+      lv2_atomic_store_ptr((void* volatile*)&pool->slots[i], NULL);
+    }
+  }
+
+  // Start a new epoch, and wait for claims that may have seen the slot
+  const uint32_t epoch = lv2_atomic_add(&pool->epoch, 1U);
+  while (lv2_atomic_load(&pool->n_claims[epoch & 1U])) {
+    lv2_atomic_pause();
+  }
+
+  // Wait for the thread that claimed the slot, if any, to release it
+  while (!lv2_atomic_cas(&slot->busy, 0U, 1U)) {
+    lv2_atomic_pause();
+  }
+
+  for (uint32_t i = 0U; slot->reentrant && i < LV2_WORKER_POOL_N_LANES; ++i) {
+    while (lv2_atomic_load(&slot->lanes[i].active)) {
+      lv2_atomic_pause();
+    }
+  }
+
+  while (lv2_worker_ring_skip(&slot->requests)) {
+    lv2_atomic_sub(&pool->n_pending, 1U);
+  }
+
+  slot->pool = NULL;
+  lv2_atomic_store(&slot->busy, 0U);
+}
+
+/**
+   Set the current time of a pool.
+
+   This should be called in the audio thread at the start of every cycle,
+   before run() is called for any instance, with a running frame counter.
+   Request deadlines are relative to this time.
+*/
+static inline void
+lv2_worker_pool_set_time(LV2_Worker_Pool* const pool, const uint32_t frames)
+{
+  lv2_atomic_store(&pool->time, frames);
+}
+
+/**
+   Find and claim the most urgent slot with pending requests.
+
+   This must only be called by lv2_worker_pool_claim(), since the slots it
+   sees may be removed concurrently.
+*/
+static inline LV2_Worker_Pool_Slot*
+lv2_worker_pool_find(LV2_Worker_Pool* const pool)
+{
+  const uint32_t start = lv2_atomic_add(&pool->cursor, 1U);
+  const uint32_t now   = lv2_atomic_load(&pool->time);
+
+  for (uint32_t attempt = 0U; attempt < pool->n_slots; ++attempt) {
+    LV2_Worker_Pool_Slot* best          = NULL;
+    uint32_t              best_priority = 0U;
+    uint32_t              best_deadline = LV2_WORKER_NO_DEADLINE;
+
+    for (uint32_t i = 0U; i < pool->n_slots; ++i) {
+      const uint32_t              index = (start + i) % pool->n_slots;
+      LV2_Worker_Pool_Slot* const slot  = (LV2_Worker_Pool_Slot*)
+        lv2_atomic_load_ptr((void* const volatile*)&pool->slots[index]);
+
+      if (!slot || lv2_atomic_load(&slot->busy) ||
+          !lv2_worker_ring_read_space(&slot->requests) ||
+          !lv2_worker_pool_lane_free(slot)) {
+        continue;
+      }
+
+      const uint32_t priority = lv2_atomic_load(&slot->priority);
+      const uint32_t deadline = lv2_atomic_load(&slot->deadline);
+      if (!best || priority > best_priority ||
+          (priority == best_priority &&
+           lv2_worker_pool_deadline_before(deadline, best_deadline, now))) {
+        best          = slot;
+        best_priority = priority;
+        best_deadline = deadline;
+      }
+    }
+
+    if (!best) {
+      return NULL;
+    }
+
+    if (lv2_atomic_cas(&best->busy, 0U, 1U)) {
+      return best;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+   Claim the most urgent slot with pending requests.
+
+   Slots with a higher priority are chosen first, then those with an earlier
+   deadline, then the first found starting at a different position for each
+   call, so that equally urgent instances are served fairly.
+
+   The search is counted in the current epoch, so lv2_worker_pool_remove() can
+   wait for every search that may have loaded a pointer to the removed slot.
+   Once a slot is claimed, it stays valid until it is released.
+
+   @return The claimed slot, or NULL if no slot could be claimed.
+*/
+static inline LV2_Worker_Pool_Slot*
+lv2_worker_pool_claim(LV2_Worker_Pool* const pool)
+{
+  uint32_t epoch = lv2_atomic_load(&pool->epoch);
+  for (;;) {
+    lv2_atomic_add(&pool->n_claims[epoch & 1U], 1U);
+    if (lv2_atomic_cas(&pool->epoch, epoch, epoch)) {
+      break; // Still current, and ordered before the next remove
+    }
+
+    // A slot was removed meanwhile, so join the new epoch instead
+    lv2_atomic_sub(&pool->n_claims[epoch & 1U], 1U);
+    epoch = lv2_atomic_load(&pool->epoch);
+  }
+
+  LV2_Worker_Pool_Slot* const slot = lv2_worker_pool_find(pool);
+
+  lv2_atomic_sub(&pool->n_claims[epoch & 1U], 1U);
+  return slot;
+}
+
+/**
+   Execute at most one pending request in the calling thread and record
+   latencies.
+
+   This is like lv2_worker_pool_run_one(), but if the pool has a clock, the
+   latencies of the request are recorded in `stats`, which must only be
+   written by the calling thread.
+*/
+static inline bool
+lv2_worker_pool_run_one_measured(LV2_Worker_Pool* const  pool,
+                                 void* const             buf,
+                                 const uint32_t          capacity,
+                                 LV2_Worker_Stats* const stats)
+{
+  if (!pool->n_slots || !lv2_atomic_load(&pool->n_pending)) {
+    return false;
+  }
+
+  LV2_Worker_Pool_Slot* slot = NULL;
+  while ((slot = lv2_worker_pool_claim(pool))) {
+    LV2_Worker_Pool_Request request = {0U, 0U, 0U};
+    uint32_t                size    = 0U;
+    while (lv2_worker_pool_lane_free(slot) &&
+           lv2_worker_ring_read(&slot->requests, capacity, buf, &size)) {
+      lv2_atomic_sub(&pool->n_pending, 1U);
+      lv2_worker_pool_settle(slot);
+      if (size < sizeof(request)) {
+        continue; // Discarded because it was too large for the buffer
+      }
+
+      // Skip requests that have been superseded by a later one
+      memcpy(&request, buf, sizeof(request));
+      LV2_Worker_Pool_Key* const entry =
+        request.key ? &slot->keys[request.key - 1U] : NULL;
+      if (entry && lv2_worker_pool_key_is_stale(entry, request.seq)) {
+        continue;
+      }
+
+      // Let other threads start later jobs of a re-entrant slot meanwhile
+      LV2_Worker_Pool_Lane* const lane =
+        slot->reentrant ? lv2_worker_pool_lane_acquire(slot) : NULL;
+      if (lane) {
+        lv2_atomic_store(&slot->busy, 0U);
+      }
+
+      const uint64_t      now = lv2_worker_pool_now(pool);
+      LV2_Worker_Pool_Job job = {
+        slot, lane, request.key, request.seq, request.enqueued, now, stats};
+
+      if (request.enqueued) {
+        lv2_worker_stats_record(
+          stats, LV2_WORKER_STAGE_QUEUED, request.enqueued, now);
+      }
+
+      slot->iface->work(slot->instance,
+                        lv2_worker_pool_respond,
+                        &job,
+                        size - (uint32_t)sizeof(request),
+                        (uint8_t*)buf + sizeof(request));
+
+      if (entry) {
+        lv2_worker_pool_key_finish(entry, request.seq);
+      }
+
+      if (lane) {
+        // The audio thread frees space by delivering earlier responses
+        while (lv2_worker_pool_lane_release(lane)) {
+          lv2_atomic_pause();
+        }
+      } else {
+        lv2_atomic_store(&slot->busy, 0U);
+      }
+
+      return true;
+    }
+
+    lv2_atomic_store(&slot->busy, 0U);
+  }
+
+  return false;
+}
+
+/**
+   Execute at most one pending request in the calling thread.
+
+   This is called by pool threads, and may be called concurrently from any
+   number of them.  The most urgent slot is served first, as described for
+   lv2_worker_pool_claim().
+
+   @param pool Pool to execute a request from.
+   @param buf Buffer for the request, at least the ring size of every slot.
+   @param capacity Size of `buf` in bytes.
+   @return True if a request was executed, false if none were available.
+*/
+static inline bool
+lv2_worker_pool_run_one(LV2_Worker_Pool* const pool,
+                        void* const            buf,
+                        const uint32_t         capacity)
+{
+  return lv2_worker_pool_run_one_measured(pool, buf, capacity, NULL);
+}
+
+/**
+   @}
+*/
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_WORKER_POOL_H
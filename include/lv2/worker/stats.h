@@ -0,0 +1,207 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_WORKER_STATS_H
+#define LV2_WORKER_STATS_H
+
+/**
+   @file stats.h Latency histograms for worker instrumentation.
+
+   Each thread that records latencies owns an LV2_Worker_Stats, which it
+   updates without locks or atomic read-modify-write operations.  Any other
+   thread may take a snapshot of the histograms at any time, merging those of
+   several threads, and reset them to start a new measurement period.  Since
+   only the owning thread ever writes the counts, a reset is recorded as a
+   baseline which later snapshots subtract.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup worker_stats Statistics
+   @ingroup worker
+
+   Latency histograms for worker instrumentation.
+
+   @{
+*/
+
+#include <lv2/core/atomic.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The number of buckets in a latency histogram.
+
+   Bucket `i` counts latencies in [2<sup>i</sup>, 2<sup>i+1</sup>) clock
+   units, except the first which also counts zero, and the last which counts
+   everything larger.
+*/
+#define LV2_WORKER_HISTOGRAM_N_BUCKETS 40U
+
+/**
+   A stage in the round trip of a worker request.
+*/
+typedef enum {
+  LV2_WORKER_STAGE_QUEUED     = 0, ///< From schedule_work() to work()
+  LV2_WORKER_STAGE_WORKING    = 1, ///< From work() to respond()
+  LV2_WORKER_STAGE_RESPONDING = 2, ///< From respond() to work_response()
+  LV2_WORKER_STAGE_ROUND_TRIP = 3  ///< From schedule_work() to work_response()
+} LV2_Worker_Stage;
+
+/**
+   The number of stages in LV2_Worker_Stage.
+*/
+#define LV2_WORKER_N_STAGES 4U
+
+/**
+   A histogram of latencies with logarithmic buckets.
+*/
+typedef struct {
+  volatile uint32_t counts[LV2_WORKER_HISTOGRAM_N_BUCKETS]; ///< Total counts
+  uint32_t baseline[LV2_WORKER_HISTOGRAM_N_BUCKETS];        ///< Reset counts
+} LV2_Worker_Histogram;
+
+/**
+   Latency histograms for every stage, recorded by a single thread.
+*/
+typedef struct {
+  LV2_Worker_Histogram stages[LV2_WORKER_N_STAGES]; ///< Histogram per stage
+} LV2_Worker_Stats;
+
+/** Return the bucket index for a latency. */
+static inline uint32_t
+lv2_worker_histogram_bucket(uint64_t latency)
+{
+  uint32_t index = 0U;
+  while (latency > 1U && index < LV2_WORKER_HISTOGRAM_N_BUCKETS - 1U) {
+    latency >>= 1U;
+    ++index;
+  }
+
+  return index;
+}
+
+/**
+   Record a latency in a histogram.
+
+   This is wait-free and realtime safe, but must only be called by the thread
+   that owns the histogram.
+*/
+static inline void
+lv2_worker_histogram_record(LV2_Worker_Histogram* const hist,
+                            const uint64_t              latency)
+{
+  const uint32_t index = lv2_worker_histogram_bucket(latency);
+
+  lv2_atomic_store(&hist->counts[index], hist->counts[index] + 1U);
+}
+
+/**
+   Add the counts since the last reset of a histogram to `counts`.
+
+   This may be called from any thread, but not concurrently with
+   lv2_worker_histogram_reset() for the same histogram.  Accumulating into
+   `counts` allows merging the histograms of several threads.
+
+   @param hist Histogram to read.
+   @param counts Array of LV2_WORKER_HISTOGRAM_N_BUCKETS counts to add to.
+*/
+static inline void
+lv2_worker_histogram_snapshot(const LV2_Worker_Histogram* const hist,
+                              uint32_t* const                   counts)
+{
+  for (uint32_t i = 0U; i < LV2_WORKER_HISTOGRAM_N_BUCKETS; ++i) {
+    counts[i] += lv2_atomic_load(&hist->counts[i]) - hist->baseline[i];
+  }
+}
+
+/**
+   Reset a histogram so that later snapshots only include new latencies.
+
+   This may be called from any thread, but not concurrently with
+   lv2_worker_histogram_snapshot() for the same histogram.  It does not
+   disturb the thread that records into the histogram.
+*/
+static inline void
+lv2_worker_histogram_reset(LV2_Worker_Histogram* const hist)
+{
+  for (uint32_t i = 0U; i < LV2_WORKER_HISTOGRAM_N_BUCKETS; ++i) {
+    hist->baseline[i] = lv2_atomic_load(&hist->counts[i]);
+  }
+}
+
+/**
+   Return an upper bound of a percentile of a histogram snapshot.
+
+   @param counts Array of LV2_WORKER_HISTOGRAM_N_BUCKETS counts.
+   @param percentile Percentile from 0 to 100.
+   @return The exclusive upper bound of the bucket containing the percentile,
+   UINT64_MAX if it is in the last bucket, or zero if there are no counts.
+*/
+static inline uint64_t
+lv2_worker_histogram_percentile(const uint32_t* const counts,
+                                const double          percentile)
+{
+  uint64_t total = 0U;
+  for (uint32_t i = 0U; i < LV2_WORKER_HISTOGRAM_N_BUCKETS; ++i) {
+    total += counts[i];
+  }
+
+  if (!total) {
+    return 0U;
+  }
+
+  const double threshold = (double)total * percentile / 100.0;
+  uint64_t     seen      = 0U;
+  for (uint32_t i = 0U; i < LV2_WORKER_HISTOGRAM_N_BUCKETS - 1U; ++i) {
+    seen += counts[i];
+    if ((double)seen >= threshold) {
+      return (uint64_t)1U << (i + 1U);
+    }
+  }
+
+  return UINT64_MAX;
+}
+
+/** Initialise the histograms of a thread. */
+static inline void
+lv2_worker_stats_init(LV2_Worker_Stats* const stats)
+{
+  memset(stats, 0, sizeof(LV2_Worker_Stats));
+}
+
+/**
+   Record the latency of a stage.
+
+   This is wait-free and realtime safe, but must only be called by the thread
+   that owns `stats`, which may be NULL to disable recording.
+*/
+static inline void
+lv2_worker_stats_record(LV2_Worker_Stats* const stats,
+                        const LV2_Worker_Stage  stage,
+                        const uint64_t          begin,
+                        const uint64_t          end)
+{
+  if (stats) {
+    lv2_worker_histogram_record(&stats->stages[stage],
+                                end > begin ? end - begin : 0U);
+  }
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_WORKER_STATS_H
@@ -0,0 +1,269 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#ifndef LV2_WORKER_TASKS_H
+#define LV2_WORKER_TASKS_H
+
+/**
+   @file tasks.h A reference task scheduler shared by many plugin instances.
+
+   This is a host-side implementation of LV2_Worker_Task_Scheduler, where the
+   host's processing threads help to run the tasks of any plugin whenever
+   they are idle.  All parallelism in the process then shares the host's
+   threads.
+
+   When a plugin calls run_tasks(), the job is published in one of a fixed
+   number of slots, and the calling thread starts running its tasks.  Other
+   threads join the job by calling lv2_worker_tasks_help(), and every thread
+   in a job repeatedly claims the next task index with an atomic increment,
+   so the tasks are balanced between threads automatically.  The call
+   returns when every task has finished.  If every slot is in use, the tasks
+   are simply run in the calling thread.
+
+   The host owns all threads and memory.  A typical host:
+
+     - Calls lv2_worker_tasks_init() with the number of processing threads,
+       and a notify callback which wakes idle threads.
+
+     - Passes the `scheduler` field as the data of the work:taskScheduler
+       feature to every instance.
+
+     - Calls lv2_worker_tasks_help() in its processing threads whenever they
+       are idle, or notified, until it returns false.
+
+   Nothing here allocates memory or blocks, but a thread in run_tasks() spins
+   while it waits for tasks being run by other threads, so they should have
+   the same realtime priority.
+
+   Note these functions are all static inline, do not take their address.
+
+   This header is non-normative, it is provided for convenience.
+*/
+
+/**
+   @defgroup worker_tasks Tasks
+   @ingroup worker
+
+   A reference task scheduler shared by many plugin instances.
+
+   @{
+*/
+
+#include <lv2/core/atomic.h>
+#include <lv2/worker/worker.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+   The number of jobs that can run in parallel at once.
+*/
+#define LV2_WORKER_TASKS_N_JOBS 16U
+
+/**
+   Flag set in LV2_Worker_Tasks_Job::state while threads may join the job.
+*/
+#define LV2_WORKER_TASKS_OPEN 0x80000000U
+
+/**
+   A slot for the tasks of one run_tasks() call.
+*/
+typedef struct {
+  volatile uint32_t        owner;   ///< Non-zero while used by a call
+  volatile uint32_t        state;   ///< Open flag, and number of helpers
+  volatile uint32_t        next;    ///< Index of the next task to start
+  volatile uint32_t        n_done;  ///< Number of finished tasks
+  LV2_Worker_Task_Function task;    ///< Task function
+  void*                    data;    ///< Data for `task`
+  uint32_t                 n_tasks; ///< Number of tasks
+} LV2_Worker_Tasks_Job;
+
+/**
+   A function that wakes up idle host threads to help with a job.
+
+   This is called in the audio thread, so it must be realtime safe, for
+   example by posting a semaphore.
+
+   @param handle The notify handle passed to lv2_worker_tasks_init().
+   @param n_tasks Number of tasks in the new job.
+*/
+typedef void (*LV2_Worker_Tasks_Notify_Function)(void*    handle,
+                                                 uint32_t n_tasks);
+
+/**
+   A task scheduler.
+*/
+typedef struct {
+  LV2_Worker_Task_Scheduler        scheduler; ///< Feature for plugins
+  uint32_t                         n_threads; ///< Number of host threads
+  LV2_Worker_Tasks_Notify_Function notify;    ///< Wake function, or NULL
+  void*                            handle;    ///< Handle for `notify`
+  volatile uint32_t                n_jobs;    ///< Jobs run in parallel
+  volatile uint32_t                n_inline;  ///< Jobs run in the caller
+
+  /** Slots for jobs that are running in parallel. */
+  LV2_Worker_Tasks_Job jobs[LV2_WORKER_TASKS_N_JOBS];
+} LV2_Worker_Tasks;
+
+/**
+   Run tasks of a job until none are left.
+
+   @return The number of tasks run.
+*/
+static inline uint32_t
+lv2_worker_tasks_work(LV2_Worker_Tasks_Job* const job)
+{
+  uint32_t n_run = 0U;
+  uint32_t index = 0U;
+  while ((index = lv2_atomic_add(&job->next, 1U)) < job->n_tasks) {
+    job->task(job->data, index);
+    lv2_atomic_add(&job->n_done, 1U);
+    ++n_run;
+  }
+
+  return n_run;
+}
+
+/**
+   Return the number of threads that may run tasks at once.
+
+   This is the LV2_Worker_Task_Scheduler::concurrency() implementation.
+*/
+static inline uint32_t
+lv2_worker_tasks_concurrency(LV2_Worker_Schedule_Handle handle)
+{
+  const LV2_Worker_Tasks* const tasks = (const LV2_Worker_Tasks*)handle;
+
+  return tasks->n_threads + 1U;
+}
+
+/**
+   Run tasks in parallel, and wait for all of them to finish.
+
+   This is the LV2_Worker_Task_Scheduler::run_tasks() implementation.
+*/
+static inline void
+lv2_worker_tasks_run(LV2_Worker_Schedule_Handle     handle,
+                     const LV2_Worker_Task_Function task,
+                     void* const                    data,
+                     const uint32_t                 n_tasks)
+{
+  LV2_Worker_Tasks* const tasks = (LV2_Worker_Tasks*)handle;
+
+  // Find a free slot if running in parallel is worthwhile
+  LV2_Worker_Tasks_Job* job = NULL;
+  if (n_tasks > 1U && tasks->n_threads) {
+    for (uint32_t i = 0U; i < LV2_WORKER_TASKS_N_JOBS; ++i) {
+      if (lv2_atomic_cas(&tasks->jobs[i].owner, 0U, 1U)) {
+        job = &tasks->jobs[i];
+        break;
+      }
+    }
+  }
+
+  if (!job) {
+    lv2_atomic_add(&tasks->n_inline, 1U);
+    for (uint32_t i = 0U; i < n_tasks; ++i) {
+      task(data, i);
+    }
+
+    return;
+  }
+
+  // Publish the job, and wake up other threads to help
+  job->task    = task;
+  job->data    = data;
+  job->n_tasks = n_tasks;
+  lv2_atomic_store(&job->next, 0U);
+  lv2_atomic_store(&job->n_done, 0U);
+  lv2_atomic_add(&job->state, LV2_WORKER_TASKS_OPEN);
+  lv2_atomic_add(&tasks->n_jobs, 1U);
+  if (tasks->notify) {
+    tasks->notify(tasks->handle, n_tasks);
+  }
+
+  // Run tasks in this thread as well, then wait for the others to finish
+  lv2_worker_tasks_work(job);
+  while (lv2_atomic_load(&job->n_done) < n_tasks) {
+    lv2_atomic_pause();
+  }
+
+  // Close the job, and wait for helpers to leave before freeing the slot
+  lv2_atomic_sub(&job->state, LV2_WORKER_TASKS_OPEN);
+  while (lv2_atomic_load(&job->state)) {
+    lv2_atomic_pause();
+  }
+
+  lv2_atomic_store(&job->owner, 0U);
+}
+
+/**
+   Help run the tasks of any open jobs.
+
+   This should be called by host processing threads when they are idle,
+   until it returns false.  It never blocks.
+
+   @return True if any tasks were run.
+*/
+static inline bool
+lv2_worker_tasks_help(LV2_Worker_Tasks* const tasks)
+{
+  uint32_t n_run = 0U;
+  for (uint32_t i = 0U; i < LV2_WORKER_TASKS_N_JOBS; ++i) {
+    LV2_Worker_Tasks_Job* const job = &tasks->jobs[i];
+
+    // Join the job if it is open, so it stays valid until we leave
+    uint32_t state = lv2_atomic_load(&job->state);
+    while ((state & LV2_WORKER_TASKS_OPEN) &&
+           !lv2_atomic_cas(&job->state, state, state + 1U)) {
+      state = lv2_atomic_load(&job->state);
+    }
+
+    if (state & LV2_WORKER_TASKS_OPEN) {
+      n_run += lv2_worker_tasks_work(job);
+      lv2_atomic_sub(&job->state, 1U);
+    }
+  }
+
+  return n_run > 0U;
+}
+
+/**
+   Initialise a task scheduler.
+
+   @param tasks Scheduler to initialise.
+   @param n_threads Number of host threads that call lv2_worker_tasks_help(),
+   not including those that call run().
+   @param notify Function to wake up idle threads when a job starts, or NULL.
+   @param handle Handle passed to `notify`.
+*/
+static inline void
+lv2_worker_tasks_init(LV2_Worker_Tasks* const                tasks,
+                      const uint32_t                         n_threads,
+                      const LV2_Worker_Tasks_Notify_Function notify,
+                      void* const                            handle)
+{
+  memset(tasks, 0, sizeof(LV2_Worker_Tasks));
+  tasks->scheduler.handle      = tasks;
+  tasks->scheduler.concurrency = lv2_worker_tasks_concurrency;
+  tasks->scheduler.run_tasks   = lv2_worker_tasks_run;
+  tasks->n_threads             = n_threads;
+  tasks->notify                = notify;
+  tasks->handle                = handle;
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+/**
+   @}
+*/
+
+#endif // LV2_WORKER_TASKS_H
@@ -1,4 +1,4 @@
-// Copyright 2012-2016 David Robillard <d@drobilla.net>
+// Copyright 2012-2026 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
 #ifndef LV2_WORKER_WORKER_H
@@ -17,6 +17,7 @@
 
 #include <lv2/core/lv2.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 
 // clang-format off
@@ -24,8 +25,12 @@
 #define LV2_WORKER_URI    "http://lv2plug.in/ns/ext/worker"  ///< http://lv2plug.in/ns/ext/worker
 #define LV2_WORKER_PREFIX LV2_WORKER_URI "#"                 ///< http://lv2plug.in/ns/ext/worker#
 
-#define LV2_WORKER__interface LV2_WORKER_PREFIX "interface"  ///< http://lv2plug.in/ns/ext/worker#interface
-#define LV2_WORKER__schedule  LV2_WORKER_PREFIX "schedule"   ///< http://lv2plug.in/ns/ext/worker#schedule
+#define LV2_WORKER__interface        LV2_WORKER_PREFIX "interface"         ///< http://lv2plug.in/ns/ext/worker#interface
+#define LV2_WORKER__keyedSchedule    LV2_WORKER_PREFIX "keyedSchedule"     ///< http://lv2plug.in/ns/ext/worker#keyedSchedule
+#define LV2_WORKER__prioritySchedule LV2_WORKER_PREFIX "prioritySchedule"  ///< http://lv2plug.in/ns/ext/worker#prioritySchedule
+#define LV2_WORKER__reentrant        LV2_WORKER_PREFIX "reentrant"         ///< http://lv2plug.in/ns/ext/worker#reentrant
+#define LV2_WORKER__schedule         LV2_WORKER_PREFIX "schedule"          ///< http://lv2plug.in/ns/ext/worker#schedule
+#define LV2_WORKER__taskScheduler    LV2_WORKER_PREFIX "taskScheduler"     ///< http://lv2plug.in/ns/ext/worker#taskScheduler
 
 // clang-format on
 
@@ -42,6 +47,20 @@ typedef enum {
   LV2_WORKER_ERR_NO_SPACE = 2  /**< Failed due to lack of space. */
 } LV2_Worker_Status;
 
+/**
+   Priority class of a worker request.
+*/
+typedef enum {
+  LV2_WORKER_PRIORITY_BACKGROUND = 0, /**< No particular urgency. */
+  LV2_WORKER_PRIORITY_NORMAL     = 1, /**< Same as schedule_work(). */
+  LV2_WORKER_PRIORITY_URGENT     = 2  /**< Needed as soon as possible. */
+} LV2_Worker_Priority;
+
+/**
+   Deadline value for requests without a deadline.
+*/
+#define LV2_WORKER_NO_DEADLINE UINT32_MAX
+
 /** Opaque handle for LV2_Worker_Interface::work(). */
 typedef void* LV2_Worker_Respond_Handle;
 
@@ -74,7 +93,7 @@ typedef struct {
      there are no real-time requirements and only one call may be executed at
      a time.  That is, the host MAY call this method from any non-real-time
      thread, but MUST NOT make concurrent calls to this method from several
-     threads.
+     threads, unless the plugin supports the work:reentrant feature.
 
      @param instance The LV2 instance this is a method on.
      @param respond  A function for sending a response to run().
@@ -159,6 +178,153 @@ typedef struct {
                                      const void*                data);
 } LV2_Worker_Schedule;
 
+/**
+   Keyed Schedule Worker Host Feature.
+
+   The host passes this feature to provide a schedule_keyed_work() function,
+   which the plugin can use to schedule a worker call that replaces any
+   earlier request with the same key.  This is useful for requests that are
+   made obsolete by newer ones, like loading a sample while the user scrubs
+   through a list of files.
+*/
+typedef struct {
+  /**
+     Opaque host data.
+  */
+  LV2_Worker_Schedule_Handle handle;
+
+  /**
+     Request from run() that the host call the worker for a key.
+
+     This is like LV2_Worker_Schedule::schedule_work(), except the request
+     supersedes any earlier request with the same key.  The host MAY skip
+     calling work() for a request if a newer request with the same key has
+     been scheduled before work() is called for it.  Otherwise, requests are
+     handled just like those scheduled with LV2_Worker_Schedule, and the
+     order of requests is preserved.
+
+     @param handle The handle field of this struct.
+     @param key A non-zero key for what the request is for, such as a URID.
+     @param size The size of `data`.
+     @param data Message to pass to work(), or NULL.
+  */
+  LV2_Worker_Status (*schedule_keyed_work)(LV2_Worker_Schedule_Handle handle,
+                                           uint32_t                   key,
+                                           uint32_t                   size,
+                                           const void*                data);
+
+  /**
+     Return true if the request being worked on has been superseded.
+
+     This function may only be called from work(), with the respond handle
+     passed to it.  It returns true if the request was scheduled with
+     schedule_keyed_work(), and a newer request with the same key has been
+     scheduled since.  A plugin can check this periodically during long
+     operations to cancel work whose result would be discarded anyway.
+
+     @param handle The handle field of this struct.
+     @param respond_handle The handle passed to the current work() call.
+  */
+  bool (*superseded)(LV2_Worker_Schedule_Handle handle,
+                     LV2_Worker_Respond_Handle  respond_handle);
+} LV2_Worker_Keyed_Schedule;
+
+/**
+   Priority Schedule Worker Host Feature.
+
+   The host passes this feature to provide a schedule_prioritized_work()
+   function, which the plugin can use to schedule a worker call with a
+   priority class and an optional deadline.  This allows hosts that share
+   workers between many instances to serve the most urgent work first.
+*/
+typedef struct {
+  /**
+     Opaque host data.
+  */
+  LV2_Worker_Schedule_Handle handle;
+
+  /**
+     Request from run() that the host call the worker with some urgency.
+
+     This is like LV2_Worker_Schedule::schedule_work(), except the host is
+     told how urgent the request is.  The host SHOULD handle requests with a
+     higher priority first, and requests of the same priority in order of
+     their deadline, but this is only a hint: requests are otherwise handled
+     just like those scheduled with LV2_Worker_Schedule, and the order of
+     requests from the same instance is preserved.
+
+     @param handle The handle field of this struct.
+     @param priority The priority class of the request.
+     @param deadline The number of frames from the start of the current run()
+     cycle before which the response is needed, or LV2_WORKER_NO_DEADLINE.
+     @param size The size of `data`.
+     @param data Message to pass to work(), or NULL.
+  */
+  LV2_Worker_Status (*schedule_prioritized_work)(
+    LV2_Worker_Schedule_Handle handle,
+    LV2_Worker_Priority        priority,
+    uint32_t                   deadline,
+    uint32_t                   size,
+    const void*                data);
+} LV2_Worker_Priority_Schedule;
+
+/**
+   A function that runs one task of a parallel job.
+
+   @param data The data passed to LV2_Worker_Task_Scheduler::run_tasks().
+   @param index The index of the task, from zero to the number of tasks.
+*/
+typedef void (*LV2_Worker_Task_Function)(void* data, uint32_t index);
+
+/**
+   Task Scheduler Worker Host Feature.
+
+   The host passes this feature to let the plugin split the work of run()
+   into tasks which are executed in parallel by the host's processing
+   threads.  This allows plugins to use several cores without starting
+   threads of their own that compete with those of the host.
+*/
+typedef struct {
+  /**
+     Opaque host data.
+  */
+  LV2_Worker_Schedule_Handle handle;
+
+  /**
+     Return the number of threads that may run tasks at once.
+
+     This includes the calling thread, so it is always at least 1.  Plugins
+     can use this to decide how to split their work, but SHOULD NOT assume
+     that tasks actually run in parallel.
+
+     @param handle The handle field of this struct.
+  */
+  uint32_t (*concurrency)(LV2_Worker_Schedule_Handle handle);
+
+  /**
+     Run tasks in parallel, and wait for all of them to finish.
+
+     This calls `task` once for every index from 0 to `n_tasks - 1`, in any
+     order, possibly concurrently from several threads including the calling
+     one, and returns once every call has returned.  The host MAY run every
+     task in the calling thread, for example when its threads are busy.
+
+     This function is in the audio threading class, and may only be called
+     from run().  Tasks are in the audio threading class as well, so they
+     MUST be realtime safe, and MUST NOT call this function or any other
+     host feature.
+
+     @param handle The handle field of this struct.
+     @param task Function to call for each task.
+     @param data Data passed to every call of `task`.
+     @param n_tasks Number of tasks to run.
+  */
+  void (*run_tasks)(LV2_Worker_Schedule_Handle handle,
+                    LV2_Worker_Task_Function   task,
+                    void*                      data,
+                    uint32_t                   n_tasks);
+} LV2_Worker_Task_Scheduler;
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,827 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Benchmark of state saving and restoring with the reference helpers.
+
+  Synthetic plugins with many small properties, a few large blobs, and many
+  files are saved and restored through LV2_State_Interface with each backend,
+  and the throughput of every combination is printed, along with the peak
+  resident memory of the process while it ran.  Where that is not available,
+  the largest total size of the containers and tables used at once is printed
+  instead.  Restored values are checked against the plugin's current state.
+  The number of iterations can be given as the only argument.
+*/
+
+#include <lv2/atom/atom.h>
+#include <lv2/core/lv2.h>
+#include <lv2/state/blobs.h>
+#include <lv2/state/delta.h>
+#include <lv2/state/state.h>
+#include <lv2/state/store.h>
+#include <lv2/urid/urid.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#  include <sys/resource.h>
+#endif
+
+#define URI_PREFIX "http://example.org/bench#"
+#define MAX_URIS 8192U
+#define MAX_FILES 1024U
+#define CONTAINER_SIZE (8U << 20U)
+#define LAYERS_SIZE (16U << 20U)
+
+/* URI map */
+
+typedef struct {
+  char*    uris[MAX_URIS];  // Strings by URID - 1
+  uint32_t slots[MAX_URIS]; // Hash table of URIDs
+  uint32_t n_uris;
+} URIMap;
+
+static uint32_t
+hash_string(const char* str)
+{
+  uint32_t hash = 2166136261U;
+  for (; *str; ++str) {
+    hash = (hash ^ (uint8_t)*str) * 16777619U;
+  }
+
+  return hash;
+}
+
+static LV2_URID
+map_uri(LV2_URID_Map_Handle handle, const char* uri)
+{
+  URIMap* const map = (URIMap*)handle;
+  for (uint32_t i = hash_string(uri);; ++i) {
+    uint32_t* const slot = &map->slots[i % MAX_URIS];
+    if (!*slot) {
+      if (map->n_uris == MAX_URIS / 2U) {
+        return 0U;
+      }
+
+      const size_t len = strlen(uri);
+      char* const  str = (char*)malloc(len + 1U);
+
+      memcpy(str, uri, len + 1U);
+      map->uris[map->n_uris] = str;
+      *slot                  = ++map->n_uris;
+      return *slot;
+    }
+
+    if (!strcmp(map->uris[*slot - 1U], uri)) {
+      return *slot;
+    }
+  }
+}
+
+static const char*
+unmap_uri(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+  const URIMap* const map = (const URIMap*)handle;
+  return (urid && urid <= map->n_uris) ? map->uris[urid - 1U] : NULL;
+}
+
+/* In-memory file system */
+
+typedef struct {
+  char*          path;
+  const uint8_t* data;
+  size_t         size;
+  uint64_t       mtime;
+} MemoryFile;
+
+typedef struct {
+  MemoryFile files[MAX_FILES];
+  uint32_t   n_files;
+} MemoryFilesystem;
+
+typedef struct {
+  const MemoryFile* file;
+  size_t            offset;
+} MemoryStream;
+
+static MemoryFile*
+mem_find(MemoryFilesystem* const fs, const char* const path)
+{
+  for (uint32_t i = 0U; i < fs->n_files; ++i) {
+    if (!strcmp(fs->files[i].path, path)) {
+      return &fs->files[i];
+    }
+  }
+
+  return NULL;
+}
+
+static int
+mem_write(MemoryFilesystem* const fs,
+          const char* const       path,
+          const uint8_t* const    data,
+          const size_t            size)
+{
+  MemoryFile* file = mem_find(fs, path);
+  if (!file) {
+    if (fs->n_files == MAX_FILES) {
+      return 1;
+    }
+
+    const size_t len = strlen(path);
+    file             = &fs->files[fs->n_files++];
+    file->path       = (char*)malloc(len + 1U);
+    file->mtime      = 0U;
+    memcpy(file->path, path, len + 1U);
+  }
+
+  if (file->data != data || file->size != size) {
+    file->data = data;
+    file->size = size;
+    ++file->mtime;
+  }
+
+  return 0;
+}
+
+static int
+mem_stat(void* handle, const char* path, uint64_t* size, uint64_t* mtime)
+{
+  const MemoryFile* const file = mem_find((MemoryFilesystem*)handle, path);
+  if (file) {
+    *size  = file->size;
+    *mtime = file->mtime;
+  }
+
+  return !file;
+}
+
+static void*
+mem_open(void* handle, const char* path)
+{
+  const MemoryFile* const file = mem_find((MemoryFilesystem*)handle, path);
+  if (!file) {
+    return NULL;
+  }
+
+  MemoryStream* const stream = (MemoryStream*)malloc(sizeof(MemoryStream));
+  stream->file               = file;
+  stream->offset             = 0U;
+  return stream;
+}
+
+static size_t
+mem_read(void* handle, void* file, void* buf, size_t size)
+{
+  MemoryStream* const stream = (MemoryStream*)file;
+  const size_t        left   = stream->file->size - stream->offset;
+  const size_t        n      = left < size ? left : size;
+
+  (void)handle;
+  memcpy(buf, stream->file->data + stream->offset, n);
+  stream->offset += n;
+  return n;
+}
+
+static void
+mem_close(void* handle, void* file)
+{
+  (void)handle;
+  free(file);
+}
+
+static int
+mem_copy(void* handle, const char* src, const char* dst)
+{
+  MemoryFilesystem* const fs   = (MemoryFilesystem*)handle;
+  const MemoryFile* const file = mem_find(fs, src);
+
+  return !file || mem_write(fs, dst, file->data, file->size);
+}
+
+static int
+mem_make_dirs(void* handle, const char* path)
+{
+  (void)handle;
+  (void)path;
+  return 0;
+}
+
+/* Synthetic plugins */
+
+typedef struct {
+  const char* name;
+  uint32_t    n_small;   // Number of float properties
+  uint32_t    n_blobs;   // Number of chunk properties
+  uint32_t    blob_size; // Size of each chunk
+  uint32_t    n_paths;   // Number of path properties
+} PluginSpec;
+
+typedef struct {
+  LV2_URID atom_Chunk;
+  LV2_URID atom_Float;
+  LV2_URID atom_Path;
+  LV2_URID keys[4096];
+} Vocabulary;
+
+typedef struct {
+  const PluginSpec* spec;
+  const Vocabulary* vocab;
+  MemoryFilesystem* fs;
+  float*            values;
+  float*            restored;
+  uint8_t*          blobs;
+  uint8_t*          loaded;
+  uint8_t*          samples;
+  char**            paths;
+  uint64_t          n_bytes;
+} Plugin;
+
+static const uint32_t sample_size = 16384U;
+
+// Half of the files share a sample, and the rest are unique
+static const uint8_t*
+sample_data(const Plugin* const plugin, const uint32_t index)
+{
+  return plugin->samples + ((index % 2U) ? (size_t)index * 64U : 0U);
+}
+
+static const void*
+find_feature(const LV2_Feature* const* features, const char* const uri)
+{
+  for (; *features; ++features) {
+    if (!strcmp((*features)->URI, uri)) {
+      return (*features)->data;
+    }
+  }
+
+  return NULL;
+}
+
+static LV2_State_Status
+plugin_save(LV2_Handle                instance,
+            LV2_State_Store_Function  store,
+            LV2_State_Handle          handle,
+            uint32_t                  flags,
+            const LV2_Feature* const* features)
+{
+  Plugin* const           plugin = (Plugin*)instance;
+  const PluginSpec* const spec   = plugin->spec;
+  const Vocabulary* const vocab  = plugin->vocab;
+  const uint32_t          pod    = LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE;
+  uint32_t                k      = 0U;
+  LV2_State_Status        st     = LV2_STATE_SUCCESS;
+
+  (void)flags;
+  for (uint32_t i = 0U; !st && i < spec->n_small; ++i) {
+    plugin->n_bytes += sizeof(float);
+    st = store(handle,
+               vocab->keys[k++],
+               &plugin->values[i],
+               sizeof(float),
+               vocab->atom_Float,
+               pod);
+  }
+
+  for (uint32_t i = 0U; !st && i < spec->n_blobs; ++i) {
+    plugin->n_bytes += spec->blob_size;
+    st = store(handle,
+               vocab->keys[k++],
+               plugin->blobs + ((size_t)i * spec->blob_size),
+               spec->blob_size,
+               vocab->atom_Chunk,
+               pod);
+  }
+
+  if (!spec->n_paths) {
+    return st;
+  }
+
+  const LV2_State_Make_Path* const make_path =
+    (const LV2_State_Make_Path*)find_feature(features, LV2_STATE__makePath);
+  const LV2_State_Map_Path* const map_path =
+    (const LV2_State_Map_Path*)find_feature(features, LV2_STATE__mapPath);
+
+  for (uint32_t i = 0U; !st && i < spec->n_paths; ++i) {
+    char name[32];
+    snprintf(name, sizeof(name), "samples/%u.wav", i);
+
+    char* const path = make_path->path(make_path->handle, name);
+    mem_write(plugin->fs, path, sample_data(plugin, i), sample_size);
+
+    char* const abstract = map_path->abstract_path(map_path->handle, path);
+    plugin->n_bytes += strlen(abstract) + 1U;
+    st = store(handle,
+               vocab->keys[k++],
+               abstract,
+               strlen(abstract) + 1U,
+               vocab->atom_Path,
+               pod);
+
+    free(abstract);
+    free(path);
+  }
+
+  return st;
+}
+
+static LV2_State_Status
+plugin_restore(LV2_Handle                  instance,
+               LV2_State_Retrieve_Function retrieve,
+               LV2_State_Handle            handle,
+               uint32_t                    flags,
+               const LV2_Feature* const*   features)
+{
+  Plugin* const           plugin   = (Plugin*)instance;
+  const PluginSpec* const spec     = plugin->spec;
+  const Vocabulary* const vocab    = plugin->vocab;
+  uint32_t                n_floats = 0U;
+  uint32_t                n_chunks = 0U;
+  uint32_t                n_paths  = 0U;
+
+  const uint32_t n_all = spec->n_small + spec->n_blobs + spec->n_paths;
+
+  const LV2_State_Map_Path* const map_path =
+    (const LV2_State_Map_Path*)find_feature(features, LV2_STATE__mapPath);
+
+  (void)flags;
+  for (uint32_t k = 0U; k < n_all; ++k) {
+    size_t      size  = 0U;
+    uint32_t    type  = 0U;
+    const void* value = retrieve(handle, vocab->keys[k], &size, &type, NULL);
+    if (!value) {
+      return LV2_STATE_ERR_UNKNOWN;
+    }
+
+    plugin->n_bytes += size;
+    if (type == vocab->atom_Float && size == sizeof(float) &&
+        n_floats < spec->n_small) {
+      memcpy(&plugin->restored[n_floats++], value, size);
+    } else if (type == vocab->atom_Chunk && size == spec->blob_size &&
+               n_chunks < spec->n_blobs) {
+      memcpy(plugin->loaded + ((size_t)n_chunks++ * size), value, size);
+    } else if (type == vocab->atom_Path && n_paths < spec->n_paths) {
+      free(plugin->paths[n_paths]);
+      plugin->paths[n_paths++] =
+        map_path->absolute_path(map_path->handle, (const char*)value);
+    } else {
+      return LV2_STATE_ERR_BAD_TYPE;
+    }
+  }
+
+  return LV2_STATE_SUCCESS;
+}
+
+// Check that the restored state is the state the plugin last saved
+static bool
+plugin_check(const Plugin* const plugin)
+{
+  const PluginSpec* const spec   = plugin->spec;
+  const size_t            n_blob = (size_t)spec->n_blobs * spec->blob_size;
+
+  if (memcmp(plugin->restored, plugin->values, spec->n_small * sizeof(float)) ||
+      memcmp(plugin->loaded, plugin->blobs, n_blob)) {
+    return false;
+  }
+
+  for (uint32_t i = 0U; i < spec->n_paths; ++i) {
+    const MemoryFile* const file =
+      plugin->paths[i] ? mem_find(plugin->fs, plugin->paths[i]) : NULL;
+    if (!file || file->size != sample_size ||
+        memcmp(file->data, sample_data(plugin, i), sample_size)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/* Backends */
+
+typedef enum { BACKEND_STORE, BACKEND_COMPRESSED, BACKEND_DELTA } Backend;
+
+static const char* const backend_names[] = {"store", "compressed", "delta"};
+
+typedef struct {
+  uint64_t*              data;  // Container, within Backends::containers
+  uint64_t               size;  // Size of the container
+  LV2_URID*              urids; // URID of every URI index
+  LV2_State_Store_Index* index; // Index of the entries
+} Layer;
+
+typedef struct {
+  LV2_URID_Map*             map;
+  LV2_URID_Unmap*           unmap;
+  const LV2_Feature* const* features;
+  LV2_State_Store_Entry     entries[4096];
+  LV2_URID                  uris[4096];
+  uint32_t                  slots[8192U + 8192U]; // Writer hash slots
+  uint32_t                  table[LV2_STATE_STORE_HASH_SIZE];
+  LV2_State_Delta_Entry     hashes[4096]; // Hashes for delta saves
+  Layer*                    layers;       // Base, then one per delta save
+  LV2_State_Store_Reader*   readers;      // Reader of each layer
+  uint64_t*                 containers;   // Every layer, one after another
+  uint64_t*                 scratch;      // Decompression scratch space
+} Backends;
+
+typedef struct {
+  double   save_time;
+  double   restore_time;
+  uint64_t save_bytes;
+  uint64_t restore_bytes;
+  uint64_t save_props;
+  uint64_t restore_props;
+  uint64_t buffer_bytes;
+  uint64_t peak_bytes;
+} Result;
+
+static double
+now(void)
+{
+  const clock_t t = clock();
+  return (double)t / (double)CLOCKS_PER_SEC;
+}
+
+// Reset the peak resident size of the process where possible
+static void
+reset_peak(void)
+{
+#ifdef __linux__
+  FILE* const file = fopen("/proc/self/clear_refs", "w");
+  if (file) {
+    fputs("5", file);
+    fclose(file);
+  }
+#endif
+}
+
+// Return the peak resident size of the process in bytes, or zero if unknown
+static uint64_t
+peak_bytes(void)
+{
+#ifdef __linux__
+  // Unlike ru_maxrss, this is reset by reset_peak()
+  FILE* const file = fopen("/proc/self/status", "r");
+  if (file) {
+    char               line[128];
+    unsigned long long kib = 0U;
+    while (fgets(line, sizeof(line), file)) {
+      if (sscanf(line, "VmHWM: %llu kB", &kib) == 1) {
+        break;
+      }
+    }
+
+    fclose(file);
+    if (kib) {
+      return (uint64_t)kib * 1024U;
+    }
+  }
+#endif
+
+#ifndef _WIN32
+  struct rusage usage;
+  if (!getrusage(RUSAGE_SELF, &usage)) {
+#  ifdef __APPLE__
+    return (uint64_t)usage.ru_maxrss;
+#  else
+    return (uint64_t)usage.ru_maxrss * 1024U;
+#  endif
+  }
+#endif
+
+  return 0U;
+}
+
+// Record the total size of the containers and tables in use
+static void
+update_buffers(Result* const result, const uint64_t size)
+{
+  if (size > result->buffer_bytes) {
+    result->buffer_bytes = size;
+  }
+}
+
+static bool
+bench_backend(Backends* const b,
+              Plugin* const   plugin,
+              const Backend   backend,
+              const unsigned  n_iterations,
+              Result* const   result)
+{
+  static const LV2_State_Interface iface = {plugin_save, plugin_restore};
+
+  const PluginSpec* const spec   = plugin->spec;
+  const bool              deltas = (backend == BACKEND_DELTA);
+  const uint64_t          tables =
+    sizeof(b->entries) + sizeof(b->uris) + sizeof(b->slots);
+  LV2_State_Store_Writer writer;
+  LV2_State_Delta        delta;
+  LV2_State_Delta_Writer delta_writer;
+  uint64_t               used = 0U; // Bytes used by earlier layers
+
+  const uint32_t n_props = spec->n_small + spec->n_blobs + spec->n_paths;
+
+  memset(result, 0, sizeof(Result));
+  lv2_state_delta_init(&delta, b->hashes, 4096U);
+  reset_peak();
+
+  for (unsigned i = 0U; i <= n_iterations; ++i) {
+    // Change 1% of the small properties, as between autosaves
+    for (uint32_t j = 0U; j < spec->n_small; j += 100U) {
+      plugin->values[(j + i) % spec->n_small] += 1.0f;
+    }
+
+    // Delta saves are layered over every earlier save
+    Layer* const layer = &b->layers[deltas ? i : 0U];
+    layer->data        = b->containers + (used / sizeof(uint64_t));
+    lv2_state_store_writer_init(&writer,
+                                layer->data,
+                                LAYERS_SIZE - used,
+                                b->entries,
+                                4096U,
+                                b->uris,
+                                4096U,
+                                b->slots,
+                                b->unmap);
+
+    if (backend == BACKEND_COMPRESSED) {
+      lv2_state_store_writer_set_compression(&writer, 4096U, b->table);
+    }
+
+    plugin->n_bytes    = 0U;
+    const double start = now();
+    if (deltas) {
+      lv2_state_delta_begin(&delta_writer, &delta, &writer);
+      if (iface.save(plugin,
+                     lv2_state_delta_store,
+                     &delta_writer,
+                     LV2_STATE_IS_POD,
+                     b->features) ||
+          !(layer->size = lv2_state_delta_finish(&delta_writer))) {
+        return false;
+      }
+    } else if (iface.save(plugin,
+                          lv2_state_store_store,
+                          &writer,
+                          LV2_STATE_IS_POD,
+                          b->features) ||
+               !(layer->size = lv2_state_store_writer_finish(&writer))) {
+      return false;
+    }
+
+    const double end = now();
+    if (i) {
+      result->save_time += end - start;
+      result->save_bytes += plugin->n_bytes;
+      result->save_props += n_props;
+    }
+
+    if (deltas) {
+      used += lv2_state_store_pad(layer->size);
+    }
+
+    update_buffers(result, (deltas ? used : layer->size) + tables);
+  }
+
+  // Restore the latest state, from every layer for the delta backend
+  const unsigned n_layers = deltas ? n_iterations + 1U : 1U;
+  for (unsigned i = 0U; i < n_iterations; ++i) {
+    uint64_t memory = deltas ? used : b->layers[0].size;
+
+    memset(plugin->restored, 0, spec->n_small * sizeof(float));
+    memset(plugin->loaded, 0, (size_t)spec->n_blobs * spec->blob_size);
+
+    const double start = now();
+    for (unsigned l = 0U; l < n_layers; ++l) {
+      const Layer* const                  layer = &b->layers[l];
+      const LV2_State_Store_Header* const header =
+        lv2_state_store_check(layer->data, layer->size);
+      if (!header || lv2_state_store_reader_init(&b->readers[l],
+                                                 header,
+                                                 b->map,
+                                                 layer->urids,
+                                                 layer->index)) {
+        return false;
+      }
+
+      memory += (uint64_t)header->n_uris * sizeof(LV2_URID) +
+                (uint64_t)header->n_entries * sizeof(LV2_State_Store_Index);
+    }
+
+    if (backend == BACKEND_COMPRESSED) {
+      lv2_state_store_reader_set_scratch(
+        &b->readers[0], b->scratch, CONTAINER_SIZE);
+    }
+
+    LV2_State_Delta_Reader layered = {b->readers, n_layers};
+    LV2_State_Status       st      = LV2_STATE_SUCCESS;
+
+    plugin->n_bytes = 0U;
+    if (deltas) {
+      st = iface.restore(
+        plugin, lv2_state_delta_retrieve, &layered, 0U, b->features);
+    } else {
+      st = iface.restore(
+        plugin, lv2_state_store_retrieve, &b->readers[0], 0U, b->features);
+    }
+
+    result->restore_time += now() - start;
+    if (st || !plugin_check(plugin)) {
+      return false;
+    }
+
+    result->restore_bytes += plugin->n_bytes;
+    result->restore_props += n_props;
+    update_buffers(result, memory + b->readers[0].scratch_used);
+  }
+
+  result->peak_bytes = peak_bytes();
+  return true;
+}
+
+static double
+rate(const uint64_t amount, const double seconds)
+{
+  return seconds > 0.0 ? (double)amount / seconds : 0.0;
+}
+
+int
+main(int argc, char** argv)
+{
+  static const PluginSpec specs[] = {
+    {"small", 4000U, 0U, 0U, 0U},
+    {"blobs", 16U, 4U, 1U << 20U, 0U},
+    {"paths", 16U, 0U, 0U, 256U},
+  };
+
+  const unsigned long n_arg = (argc > 1) ? strtoul(argv[1], NULL, 10) : 20U;
+  const unsigned      n_iterations = n_arg ? (unsigned)n_arg : 1U;
+
+  static URIMap           map_data;
+  static MemoryFilesystem fs;
+  static Vocabulary       vocab;
+  static Backends         b;
+
+  LV2_URID_Map   map   = {&map_data, map_uri};
+  LV2_URID_Unmap unmap = {&map_data, unmap_uri};
+
+  vocab.atom_Chunk = map_uri(&map_data, LV2_ATOM__Chunk);
+  vocab.atom_Float = map_uri(&map_data, LV2_ATOM__Float);
+  vocab.atom_Path  = map_uri(&map_data, LV2_ATOM__Path);
+  for (uint32_t i = 0U; i < 4096U; ++i) {
+    char uri[64];
+    snprintf(uri, sizeof(uri), URI_PREFIX "p%u", i);
+    vocab.keys[i] = map_uri(&map_data, uri);
+  }
+
+  // Set up blob storage for paths
+  const LV2_State_Blobs_Filesystem fs_ops = {
+    &fs, mem_stat, mem_open, mem_read, mem_close, mem_copy, mem_make_dirs};
+
+  LV2_State_Blobs_File* const files =
+    (LV2_State_Blobs_File*)calloc(MAX_FILES, sizeof(LV2_State_Blobs_File));
+  uint32_t* const slots =
+    (uint32_t*)calloc(lv2_state_blobs_n_slots(MAX_FILES), sizeof(uint32_t));
+
+  LV2_State_Blobs          blobs;
+  LV2_State_Blobs_Instance paths;
+  lv2_state_blobs_init(
+    &blobs, "/blobs", "/scratch", &fs_ops, files, MAX_FILES, slots);
+  lv2_state_blobs_instance_init(&paths, &blobs, "bench");
+
+  const LV2_Feature map_feature       = {LV2_URID__map, &map};
+  const LV2_Feature make_path_feature = {LV2_STATE__makePath, &paths.make_path};
+  const LV2_Feature map_path_feature  = {LV2_STATE__mapPath, &paths.map_path};
+  const LV2_Feature free_path_feature = {LV2_STATE__freePath, &paths.free_path};
+  const LV2_Feature* const features[] = {&map_feature,
+                                         &make_path_feature,
+                                         &map_path_feature,
+                                         &free_path_feature,
+                                         NULL};
+
+  // Delta saves need a layer for every iteration after the first
+  const size_t n_layers = (size_t)n_iterations + 1U;
+
+  LV2_URID* const urids = (LV2_URID*)calloc(n_layers * 4096U, sizeof(LV2_URID));
+  LV2_State_Store_Index* const index = (LV2_State_Store_Index*)calloc(
+    n_layers * 4096U, sizeof(LV2_State_Store_Index));
+
+  b.map        = &map;
+  b.unmap      = &unmap;
+  b.features   = features;
+  b.layers     = (Layer*)calloc(n_layers, sizeof(Layer));
+  b.readers    = (LV2_State_Store_Reader*)calloc(n_layers,
+                                              sizeof(LV2_State_Store_Reader));
+  b.containers = (uint64_t*)malloc(LAYERS_SIZE);
+  b.scratch    = (uint64_t*)malloc(CONTAINER_SIZE);
+  for (size_t l = 0U; l < n_layers; ++l) {
+    b.layers[l].urids = urids + (l * 4096U);
+    b.layers[l].index = index + (l * 4096U);
+  }
+
+  uint8_t* const samples = (uint8_t*)malloc(sample_size + (256U * 64U));
+  for (uint32_t i = 0U; i < sample_size + (256U * 64U); ++i) {
+    samples[i] = (uint8_t)((i * 7U) ^ (i >> 5U));
+  }
+
+  printf("%-8s%-12s%12s%12s%14s%14s%12s\n",
+         "Plugin",
+         "Backend",
+         "Save MB/s",
+         "Load MB/s",
+         "Save props/s",
+         "Load props/s",
+         "Peak KiB");
+
+  int st = 0;
+  for (size_t s = 0U; !st && s < sizeof(specs) / sizeof(specs[0]); ++s) {
+    const PluginSpec* const spec = &specs[s];
+
+    float* const   values   = (float*)calloc(spec->n_small, sizeof(float));
+    float* const   restored = (float*)calloc(spec->n_small, sizeof(float));
+    const size_t   n_blob   = (size_t)spec->n_blobs * spec->blob_size;
+    uint8_t* const blob     = (uint8_t*)malloc(n_blob ? n_blob : 1U);
+    uint8_t* const loaded   = (uint8_t*)malloc(n_blob ? n_blob : 1U);
+    char** const   restored_paths =
+      (char**)calloc(spec->n_paths ? spec->n_paths : 1U, sizeof(char*));
+
+    // Generate wavetable-like blobs that compress moderately well
+    for (size_t i = 0U; i < n_blob; ++i) {
+      blob[i] = (uint8_t)(((i % 509U) * (i % 509U)) >> 8U);
+    }
+
+    for (unsigned i = 0U; !st && i <= (unsigned)BACKEND_DELTA; ++i) {
+      const Backend backend = (Backend)i;
+
+      Plugin plugin = {spec,
+                       &vocab,
+                       &fs,
+                       values,
+                       restored,
+                       blob,
+                       loaded,
+                       samples,
+                       restored_paths,
+                       0U};
+
+      Result result;
+      if (!bench_backend(&b, &plugin, backend, n_iterations, &result)) {
+        fprintf(stderr,
+                "error: Failed to benchmark %s with %s\n",
+                spec->name,
+                backend_names[backend]);
+        st = 1;
+        break;
+      }
+
+      // Fall back to the buffers the harness used if the peak is unknown
+      const uint64_t peak =
+        result.peak_bytes ? result.peak_bytes : result.buffer_bytes;
+
+      printf("%-8s%-12s%12.1f%12.1f%14.0f%14.0f%12.0f\n",
+             spec->name,
+             backend_names[backend],
+             rate(result.save_bytes, result.save_time) / 1.0e6,
+             rate(result.restore_bytes, result.restore_time) / 1.0e6,
+             rate(result.save_props, result.save_time),
+             rate(result.restore_props, result.restore_time),
+             (double)peak / 1024.0);
+    }
+
+    for (uint32_t i = 0U; i < spec->n_paths; ++i) {
+      free(restored_paths[i]);
+    }
+
+    free(restored_paths);
+    free(loaded);
+    free(blob);
+    free(restored);
+    free(values);
+  }
+
+  lv2_state_blobs_cleanup(&blobs);
+  for (uint32_t i = 0U; i < fs.n_files; ++i) {
+    free(fs.files[i].path);
+  }
+
+  for (uint32_t i = 0U; i < map_data.n_uris; ++i) {
+    free(map_data.uris[i]);
+  }
+
+  free(samples);
+  free(b.scratch);
+  free(b.containers);
+  free(b.readers);
+  free(b.layers);
+  free(index);
+  free(urids);
+  free(slots);
+  free(files);
+  return st;
+}
@@ -13,10 +13,19 @@ _Pragma("GCC diagnostic ignored \"-Wsuggest-attribute=const\"")
 #include <lv2/atom/atom.h>                       // IWYU pragma: keep
 #include <lv2/atom/forge.h>                      // IWYU pragma: keep
 #include <lv2/atom/util.h>                       // IWYU pragma: keep
+#include <lv2/batch/batch.h>                     // IWYU pragma: keep
+#include <lv2/batch/util.h>                      // IWYU pragma: keep
 #include <lv2/buf-size/buf-size.h>               // IWYU pragma: keep
+#include <lv2/clone/clone.h>                     // IWYU pragma: keep
+#include <lv2/connect/connect.h>                 // IWYU pragma: keep
+#include <lv2/connect/util.h>                    // IWYU pragma: keep
+#include <lv2/core/atomic.h>                     // IWYU pragma: keep
 #include <lv2/core/attributes.h>                 // IWYU pragma: keep
+#include <lv2/core/buffers.h>                    // IWYU pragma: keep
+#include <lv2/core/extensions.h>                 // IWYU pragma: keep
 #include <lv2/core/lv2.h>                        // IWYU pragma: keep
 #include <lv2/core/lv2_util.h>                   // IWYU pragma: keep
+#include <lv2/core/schedule.h>                   // IWYU pragma: keep
 #include <lv2/data-access/data-access.h>         // IWYU pragma: keep
 #include <lv2/dynmanifest/dynmanifest.h>         // IWYU pragma: keep
 #include <lv2/event/event-helpers.h>             // IWYU pragma: keep
@@ -24,6 +33,8 @@ _Pragma("GCC diagnostic ignored \"-Wsuggest-attribute=const\"")
 #include <lv2/instance-access/instance-access.h> // IWYU pragma: keep
 #include <lv2/log/log.h>                         // IWYU pragma: keep
 #include <lv2/log/logger.h>                      // IWYU pragma: keep
+#include <lv2/memory/arena.h>                    // IWYU pragma: keep
+#include <lv2/memory/memory.h>                   // IWYU pragma: keep
 #include <lv2/midi/midi.h>                       // IWYU pragma: keep
 #include <lv2/morph/morph.h>                     // IWYU pragma: keep
 #include <lv2/options/options.h>                 // IWYU pragma: keep
@@ -33,12 +44,25 @@ _Pragma("GCC diagnostic ignored \"-Wsuggest-attribute=const\"")
 #include <lv2/port-props/port-props.h>           // IWYU pragma: keep
 #include <lv2/presets/presets.h>                 // IWYU pragma: keep
 #include <lv2/resize-port/resize-port.h>         // IWYU pragma: keep
+#include <lv2/resource/resource.h>               // IWYU pragma: keep
+#include <lv2/resource/store.h>                  // IWYU pragma: keep
+#include <lv2/state/blobs.h>                     // IWYU pragma: keep
+#include <lv2/state/cell.h>                      // IWYU pragma: keep
+#include <lv2/state/delta.h>                     // IWYU pragma: keep
+#include <lv2/state/lazy.h>                      // IWYU pragma: keep
+#include <lv2/state/paths.h>                     // IWYU pragma: keep
+#include <lv2/state/restore.h>                   // IWYU pragma: keep
 #include <lv2/state/state.h>                     // IWYU pragma: keep
+#include <lv2/state/store.h>                     // IWYU pragma: keep
+#include <lv2/state/swap.h>                      // IWYU pragma: keep
 #include <lv2/time/time.h>                       // IWYU pragma: keep
 #include <lv2/ui/ui.h>                           // IWYU pragma: keep
 #include <lv2/units/units.h>                     // IWYU pragma: keep
 #include <lv2/uri-map/uri-map.h>                 // IWYU pragma: keep
 #include <lv2/urid/urid.h>                       // IWYU pragma: keep
+#include <lv2/worker/pool.h>                     // IWYU pragma: keep
+#include <lv2/worker/stats.h>                    // IWYU pragma: keep
+#include <lv2/worker/tasks.h>                    // IWYU pragma: keep
 #include <lv2/worker/worker.h>                   // IWYU pragma: keep
 
 int
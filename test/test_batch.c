@@ -0,0 +1,160 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/batch/batch.h>
+#include <lv2/batch/util.h>
+#include <lv2/core/lv2.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define N_INSTANCES 5U
+#define N_SAMPLES 16U
+
+enum { GAIN, INPUT, OUTPUT, COUNT, N_PORTS };
+
+// A gain with a counter of processed samples as a non-signal port
+typedef struct {
+  const float* gain;
+  const float* input;
+  float*       output;
+  uint32_t*    count;
+  float        smoothed;
+} Gain;
+
+static Gain gains[N_INSTANCES];
+
+static void
+connect_port(LV2_Handle instance, uint32_t port, void* data_location)
+{
+  Gain* const gain = (Gain*)instance;
+
+  switch (port) {
+  case GAIN:
+    gain->gain = (const float*)data_location;
+    break;
+  case INPUT:
+    gain->input = (const float*)data_location;
+    break;
+  case OUTPUT:
+    gain->output = (float*)data_location;
+    break;
+  case COUNT:
+    gain->count = (uint32_t*)data_location;
+    break;
+  default:
+    break;
+  }
+}
+
+static void
+run(LV2_Handle instance, uint32_t sample_count)
+{
+  Gain* const gain = (Gain*)instance;
+
+  for (uint32_t s = 0U; s < sample_count; ++s) {
+    gain->smoothed  = (0.5f * gain->smoothed) + (0.5f * *gain->gain);
+    gain->output[s] = gain->input[s] * gain->smoothed;
+  }
+
+  *gain->count += sample_count;
+}
+
+static void
+run_batch(const LV2_Handle* instances,
+          uint32_t          n_instances,
+          void* const*      ports,
+          uint32_t          sample_count)
+{
+  const float* const gain   = (const float*)ports[GAIN];
+  const float* const input  = (const float*)ports[INPUT];
+  float* const       output = (float*)ports[OUTPUT];
+  uint32_t** const   counts = (uint32_t**)ports[COUNT];
+
+  // Instances are the inner loop, so this is easy to vectorise
+  for (uint32_t s = 0U; s < sample_count; ++s) {
+    for (uint32_t i = 0U; i < n_instances; ++i) {
+      Gain* const  self  = (Gain*)instances[i];
+      const size_t index = lv2_batch_index(n_instances, i, s);
+
+      self->smoothed = (0.5f * self->smoothed) + (0.5f * gain[i]);
+      output[index]  = input[index] * self->smoothed;
+    }
+  }
+
+  for (uint32_t i = 0U; i < n_instances; ++i) {
+    *counts[i] += sample_count;
+  }
+}
+
+static void
+test_batch(void)
+{
+  float    gain_values[N_INSTANCES];
+  float    inputs[N_INSTANCES][N_SAMPLES];
+  float    outputs[N_INSTANCES][N_SAMPLES];
+  uint32_t counts[N_INSTANCES];
+
+  memset(gains, 0, sizeof(gains));
+  memset(counts, 0, sizeof(counts));
+  for (uint32_t i = 0U; i < N_INSTANCES; ++i) {
+    gain_values[i] = (float)(i + 1U) * 0.25f;
+    for (uint32_t s = 0U; s < N_SAMPLES; ++s) {
+      inputs[i][s] = (float)s - (float)i;
+    }
+  }
+
+  // Run every instance separately for reference
+  for (uint32_t i = 0U; i < N_INSTANCES; ++i) {
+    connect_port(&gains[i], GAIN, &gain_values[i]);
+    connect_port(&gains[i], INPUT, inputs[i]);
+    connect_port(&gains[i], OUTPUT, outputs[i]);
+    connect_port(&gains[i], COUNT, &counts[i]);
+    run(&gains[i], N_SAMPLES);
+  }
+
+  // Run the batch from the same initial state
+  float        batch_inputs[N_INSTANCES * N_SAMPLES];
+  float        batch_outputs[N_INSTANCES * N_SAMPLES];
+  float        results[N_INSTANCES][N_SAMPLES];
+  const float* input_buffers[N_INSTANCES];
+  float*       result_buffers[N_INSTANCES];
+  uint32_t*    count_buffers[N_INSTANCES];
+  LV2_Handle   instances[N_INSTANCES];
+  for (uint32_t i = 0U; i < N_INSTANCES; ++i) {
+    gains[i].smoothed = 0.0f;
+    input_buffers[i]  = inputs[i];
+    result_buffers[i] = results[i];
+    count_buffers[i]  = &counts[i];
+    instances[i]      = &gains[i];
+  }
+
+  lv2_batch_interleave(batch_inputs, input_buffers, N_INSTANCES, N_SAMPLES);
+  assert(batch_inputs[lv2_batch_index(N_INSTANCES, 2U, 3U)] == inputs[2][3]);
+
+  void* const ports[N_PORTS] = {
+    gain_values, batch_inputs, batch_outputs, count_buffers};
+
+  const LV2_Batch_Interface iface = {0U, run_batch};
+  iface.run_batch(instances, N_INSTANCES, ports, N_SAMPLES);
+  lv2_batch_deinterleave(result_buffers, batch_outputs, N_INSTANCES, N_SAMPLES);
+
+  for (uint32_t i = 0U; i < N_INSTANCES; ++i) {
+    assert(counts[i] == 2U * N_SAMPLES);
+    assert(!memcmp(results[i], outputs[i], sizeof(results[i])));
+
+    // Ports connected with connect_port() are not changed
+    assert(gains[i].output == outputs[i]);
+  }
+}
+
+int
+main(void)
+{
+  test_batch();
+  return 0;
+}
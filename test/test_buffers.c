@@ -0,0 +1,286 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/core/buffers.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define NONE LV2_BUFFERS_NONE
+#define UNSHARED LV2_BUFFERS_UNSHARED
+#define N_RANDOM_NODES 64U
+#define MAX_PORTS 6U
+
+enum {
+  SYNTH_OUT,
+  GAIN_IN,
+  GAIN_LEVEL,
+  GAIN_OUT,
+  DIST_IN,
+  DIST_OUT,
+  MIX_IN_1,
+  MIX_IN_2,
+  MIX_OUT,
+  MIX_METER,
+  MIX_SPARE,
+  FX_IN,
+  FX_SIDECHAIN,
+  FX_KEY,
+  FX_OUT,
+  FX_MONITOR,
+  N_PORTS
+};
+
+static uint32_t
+rng(uint32_t* const state)
+{
+  *state = (*state * 1664525U) + 1013904223U;
+  return *state >> 8U;
+}
+
+// Check that no data is overwritten before it is read, by simulating a cycle
+static void
+check_plan(const LV2_Buffers_Node* const nodes,
+           const uint32_t                n_nodes,
+           const LV2_Buffers_Port* const ports,
+           const LV2_Buffers_Plan* const plan)
+{
+  uint32_t owners[N_RANDOM_NODES * MAX_PORTS];
+  for (uint32_t b = 0U; b < plan->n_buffers; ++b) {
+    owners[b] = LV2_BUFFERS_NONE;
+    assert(!(plan->buffers[b].offset % LV2_BUFFERS_ALIGN));
+    assert(!(plan->buffers[b].size % LV2_BUFFERS_ALIGN));
+    assert(plan->buffers[b].offset + plan->buffers[b].size <= plan->size);
+  }
+
+  uint32_t first = 0U;
+  for (uint32_t n = 0U; n < n_nodes; ++n) {
+    const uint32_t last = first + nodes[n].n_ports;
+
+    for (uint32_t p = first; p < last; ++p) {
+      const LV2_Buffers_Port* const port = &ports[p];
+      const uint32_t                b    = port->buffer;
+      if (b != LV2_BUFFERS_NONE) {
+        assert(plan->buffers[b].size >= port->size);
+      }
+
+      if (port->flags & LV2_BUFFERS_OUTPUT) {
+        // Outputs never share a buffer, or an input of a broken plugin, and
+        // unshared ports never process in place
+        for (uint32_t q = first; q < last && b != LV2_BUFFERS_NONE; ++q) {
+          const bool output   = ports[q].flags & LV2_BUFFERS_OUTPUT;
+          const bool unshared = (port->flags | ports[q].flags) & UNSHARED;
+          assert(q == p || ports[q].buffer != b ||
+                 (!output && !unshared && !nodes[n].in_place_broken));
+        }
+      } else if (port->source != LV2_BUFFERS_NONE) {
+        assert(owners[b] == port->source);
+      } else if (b != LV2_BUFFERS_NONE) {
+        assert(plan->buffers[b].silent);
+        assert(plan->buffers[b].unshared == (bool)(port->flags & UNSHARED));
+      } else {
+        assert(port->flags & LV2_BUFFERS_OPTIONAL);
+      }
+    }
+
+    for (uint32_t p = first; p < last; ++p) {
+      if ((ports[p].flags & LV2_BUFFERS_OUTPUT) &&
+          ports[p].buffer != LV2_BUFFERS_NONE) {
+        assert(!plan->buffers[ports[p].buffer].silent);
+        owners[ports[p].buffer] = p;
+      }
+    }
+
+    first = last;
+  }
+}
+
+static void
+test_chain(void)
+{
+  static const LV2_Buffers_Node nodes[] = {
+    {1U, false}, // Synth
+    {3U, false}, // Gain
+    {2U, true},  // Distortion, which is broken in place
+    {5U, false}, // Mixer
+    {5U, false}, // Effect
+  };
+
+  static const uint32_t external = LV2_BUFFERS_EXTERNAL;
+  static const uint32_t optional = LV2_BUFFERS_OPTIONAL;
+  static const uint32_t output   = LV2_BUFFERS_OUTPUT;
+
+  LV2_Buffers_Port ports[N_PORTS] = {
+    {output, 256U, NONE, 0U, 0U},            // SYNTH_OUT
+    {0U, 256U, SYNTH_OUT, 0U, 0U},           // GAIN_IN
+    {UNSHARED, 4U, NONE, 0U, 0U},            // GAIN_LEVEL
+    {output, 256U, NONE, 0U, 0U},            // GAIN_OUT
+    {0U, 256U, GAIN_OUT, 0U, 0U},            // DIST_IN
+    {output, 256U, NONE, 0U, 0U},            // DIST_OUT
+    {0U, 256U, SYNTH_OUT, 0U, 0U},           // MIX_IN_1
+    {0U, 256U, DIST_OUT, 0U, 0U},            // MIX_IN_2
+    {output, 256U, NONE, 0U, 0U},            // MIX_OUT
+    {output | optional, 4U, NONE, 0U, 0U},   // MIX_METER
+    {output, 200U, NONE, 0U, 0U},            // MIX_SPARE
+    {0U, 256U, MIX_OUT, 0U, 0U},             // FX_IN
+    {0U, 256U, NONE, 0U, 0U},                // FX_SIDECHAIN
+    {optional, 256U, NONE, 0U, 0U},          // FX_KEY
+    {output | external, 256U, NONE, 0U, 0U}, // FX_OUT
+    {output, 256U, NONE, 0U, 0U},            // FX_MONITOR
+  };
+
+  LV2_Buffers_Buffer buffers[N_PORTS];
+  LV2_Buffers_Plan   plan = {buffers, 0U, 0U};
+  assert(lv2_buffers_plan(nodes, 5U, ports, N_PORTS, &plan, N_PORTS));
+  check_plan(nodes, 5U, ports, &plan);
+
+  // The synth output is still needed by the mixer, so the gain can't reuse it
+  assert(ports[SYNTH_OUT].n_reads == 2U);
+  assert(ports[GAIN_OUT].buffer != ports[GAIN_IN].buffer);
+  assert(ports[DIST_OUT].buffer != ports[DIST_IN].buffer);
+
+  // The mixer processes in place, and reuses the free gain buffer as scratch
+  assert(ports[MIX_OUT].buffer == ports[MIX_IN_1].buffer);
+  assert(ports[MIX_SPARE].buffer == ports[GAIN_OUT].buffer);
+  assert(ports[MIX_METER].buffer == LV2_BUFFERS_NONE);
+
+  // Unconnected inputs read silence, unless they are optional
+  const uint32_t level     = ports[GAIN_LEVEL].buffer;
+  const uint32_t sidechain = ports[FX_SIDECHAIN].buffer;
+  assert(level != LV2_BUFFERS_NONE && sidechain != LV2_BUFFERS_NONE);
+  assert(buffers[level].silent);
+  assert(buffers[level].size == LV2_BUFFERS_ALIGN);
+  assert(buffers[sidechain].silent);
+  assert(ports[FX_KEY].buffer == LV2_BUFFERS_NONE);
+  assert(ports[FX_OUT].buffer == LV2_BUFFERS_NONE);
+  assert(ports[FX_MONITOR].buffer == ports[FX_IN].buffer);
+
+  // Three audio buffers and two silent ones are enough for everything
+  assert(plan.n_buffers == 5U);
+  assert(plan.size == (4U * 256U) + LV2_BUFFERS_ALIGN);
+
+  const uint32_t synth = ports[SYNTH_OUT].buffer;
+  assert(synth != LV2_BUFFERS_NONE);
+
+  uint8_t block[2048];
+  assert(lv2_buffers_data(&plan, &ports[FX_KEY], block) == NULL);
+  assert(lv2_buffers_data(&plan, &ports[SYNTH_OUT], block) ==
+         block + buffers[synth].offset);
+
+  // Invalid connections and running out of buffers fail
+  assert(!lv2_buffers_plan(nodes, 5U, ports, N_PORTS, &plan, 4U));
+  ports[GAIN_IN].source = GAIN_OUT;
+  assert(!lv2_buffers_plan(nodes, 5U, ports, N_PORTS, &plan, N_PORTS));
+  ports[GAIN_IN].source = DIST_IN;
+  assert(!lv2_buffers_plan(nodes, 5U, ports, N_PORTS, &plan, N_PORTS));
+  ports[GAIN_IN].source = FX_OUT;
+  assert(!lv2_buffers_plan(nodes, 5U, ports, N_PORTS, &plan, N_PORTS));
+  assert(!lv2_buffers_plan(nodes, 5U, ports, N_PORTS - 1U, &plan, N_PORTS));
+}
+
+static void
+test_unshared(void)
+{
+  static const LV2_Buffers_Node nodes[] = {
+    {2U, false}, // Sequencer
+    {5U, false}, // Filter, with atom and control ports
+  };
+
+  static const uint32_t output = LV2_BUFFERS_OUTPUT;
+
+  LV2_Buffers_Port ports[] = {
+    {output | UNSHARED, 256U, NONE, 0U, 0U}, // Sequencer events out
+    {output, 256U, NONE, 0U, 0U},            // Sequencer audio out
+    {UNSHARED, 256U, 0U, 0U, 0U},            // Filter events in
+    {output | UNSHARED, 256U, NONE, 0U, 0U}, // Filter events out
+    {UNSHARED, 4U, NONE, 0U, 0U},            // Filter cutoff
+    {UNSHARED, 4U, NONE, 0U, 0U},            // Filter resonance
+    {0U, 4U, NONE, 0U, 0U},                  // Filter modulation
+  };
+
+  LV2_Buffers_Buffer buffers[7U];
+  LV2_Buffers_Plan   plan = {buffers, 0U, 0U};
+  assert(lv2_buffers_plan(nodes, 2U, ports, 7U, &plan, 7U));
+  check_plan(nodes, 2U, ports, &plan);
+
+  // An atom output never overwrites an input, even if it could be in place
+  assert(ports[2].buffer == ports[0].buffer);
+  assert(ports[3].buffer != ports[2].buffer);
+
+  // Every unconnected control input has its own value
+  assert(ports[4].buffer != ports[5].buffer);
+  assert(ports[4].buffer != ports[6].buffer);
+  assert(ports[5].buffer != ports[6].buffer);
+  assert(buffers[ports[4].buffer].silent);
+  assert(buffers[ports[5].buffer].silent);
+
+  // Without the flag, the control inputs would share a silent buffer
+  ports[4].flags = 0U;
+  ports[5].flags = 0U;
+  assert(lv2_buffers_plan(nodes, 2U, ports, 7U, &plan, 7U));
+  assert(ports[4].buffer == ports[5].buffer);
+  assert(ports[4].buffer == ports[6].buffer);
+}
+
+static void
+test_random(void)
+{
+  LV2_Buffers_Node   nodes[N_RANDOM_NODES];
+  LV2_Buffers_Port   ports[N_RANDOM_NODES * MAX_PORTS];
+  LV2_Buffers_Buffer buffers[N_RANDOM_NODES * MAX_PORTS];
+  uint32_t           state = 1U;
+
+  for (uint32_t i = 0U; i < 100U; ++i) {
+    uint32_t n_ports = 0U;
+    for (uint32_t n = 0U; n < N_RANDOM_NODES; ++n) {
+      nodes[n].n_ports         = 1U + (rng(&state) % MAX_PORTS);
+      nodes[n].in_place_broken = !(rng(&state) % 4U);
+
+      for (uint32_t p = n_ports; p < n_ports + nodes[n].n_ports; ++p) {
+        LV2_Buffers_Port* const port = &ports[p];
+
+        memset(port, 0, sizeof(LV2_Buffers_Port));
+        port->flags  = (rng(&state) % 2U) ? LV2_BUFFERS_OUTPUT : 0U;
+        port->size   = (rng(&state) % 3U) ? 256U : 4U;
+        port->source = LV2_BUFFERS_NONE;
+        if (!(rng(&state) % 5U)) {
+          port->flags |= LV2_BUFFERS_OPTIONAL;
+        }
+
+        if (!(rng(&state) % 4U)) {
+          port->flags |= LV2_BUFFERS_UNSHARED;
+        }
+
+        // Connect inputs to a random earlier output of the same size
+        if (!(port->flags & LV2_BUFFERS_OUTPUT) && n_ports) {
+          const uint32_t source = rng(&state) % n_ports;
+          if ((ports[source].flags & LV2_BUFFERS_OUTPUT) &&
+              ports[source].size == port->size) {
+            port->source = source;
+          }
+        }
+      }
+
+      n_ports += nodes[n].n_ports;
+    }
+
+    LV2_Buffers_Plan plan = {buffers, 0U, 0U};
+    assert(lv2_buffers_plan(
+      nodes, N_RANDOM_NODES, ports, n_ports, &plan, n_ports));
+    assert(plan.n_buffers < n_ports);
+    check_plan(nodes, N_RANDOM_NODES, ports, &plan);
+  }
+}
+
+int
+main(void)
+{
+  test_chain();
+  test_unshared();
+  test_random();
+  return 0;
+}
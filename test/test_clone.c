@@ -0,0 +1,209 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/clone/clone.h>
+#include <lv2/core/extensions.h>
+#include <lv2/core/lv2.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TABLE_SIZE 256U
+#define N_SAMPLES 64U
+
+enum { INPUT, OUTPUT, N_PORTS };
+
+// An expensive immutable resource shared between copies
+typedef struct {
+  uint32_t n_refs;
+  float    curve[TABLE_SIZE];
+} Table;
+
+// A waveshaper followed by a one-pole lowpass filter
+typedef struct {
+  Table*       table;
+  const float* input;
+  float*       output;
+  float        coefficient;
+  float        history;
+  bool         active;
+} Shaper;
+
+static uint32_t n_tables_built = 0U;
+
+static LV2_Handle
+instantiate(const LV2_Descriptor*     descriptor,
+            double                    rate,
+            const char*               bundle_path,
+            const LV2_Feature* const* features)
+{
+  (void)descriptor;
+  (void)bundle_path;
+  (void)features;
+
+  Shaper* const self = (Shaper*)calloc(1U, sizeof(Shaper));
+
+  self->table         = (Table*)calloc(1U, sizeof(Table));
+  self->table->n_refs = 1U;
+  for (uint32_t i = 0U; i < TABLE_SIZE; ++i) {
+    const float x         = (float)i / (float)(TABLE_SIZE - 1U);
+    self->table->curve[i] = x * (1.5f - (0.5f * x * x));
+  }
+
+  self->coefficient = (float)(1000.0 / rate);
+  ++n_tables_built;
+  return self;
+}
+
+static LV2_Handle
+clone(LV2_Handle instance, const LV2_Feature* const* features)
+{
+  (void)features;
+
+  const Shaper* const original = (const Shaper*)instance;
+  Shaper* const       self     = (Shaper*)calloc(1U, sizeof(Shaper));
+
+  *self        = *original;
+  self->input  = NULL;
+  self->output = NULL;
+  ++self->table->n_refs;
+  return self;
+}
+
+static void
+connect_port(LV2_Handle instance, uint32_t port, void* data_location)
+{
+  Shaper* const self = (Shaper*)instance;
+
+  if (port == INPUT) {
+    self->input = (const float*)data_location;
+  } else if (port == OUTPUT) {
+    self->output = (float*)data_location;
+  }
+}
+
+static void
+activate(LV2_Handle instance)
+{
+  Shaper* const self = (Shaper*)instance;
+
+  self->history = 0.0f;
+  self->active  = true;
+}
+
+static void
+run(LV2_Handle instance, uint32_t sample_count)
+{
+  Shaper* const self = (Shaper*)instance;
+
+  assert(self->active);
+  for (uint32_t s = 0U; s < sample_count; ++s) {
+    const float    x     = self->input[s] < 0.0f ? 0.0f : self->input[s];
+    const uint32_t index = x >= 1.0f ? TABLE_SIZE - 1U
+                                     : (uint32_t)(x * (float)(TABLE_SIZE - 1U));
+
+    const float y = self->table->curve[index];
+
+    self->output[s] = self->history + (self->coefficient * (y - self->history));
+    self->history   = self->output[s];
+  }
+}
+
+static void
+cleanup(LV2_Handle instance)
+{
+  Shaper* const self = (Shaper*)instance;
+
+  if (!--self->table->n_refs) {
+    free(self->table);
+  }
+
+  free(self);
+}
+
+static const LV2_Clone_Interface clone_iface = {clone};
+
+static const void*
+extension_data(const char* uri)
+{
+  return !strcmp(uri, LV2_CLONE__interface) ? &clone_iface : NULL;
+}
+
+static const LV2_Descriptor descriptor = {"http://example.org/shaper",
+                                          instantiate,
+                                          connect_port,
+                                          activate,
+                                          run,
+                                          NULL,
+                                          cleanup,
+                                          extension_data};
+
+static void
+run_cycle(LV2_Handle instance, const float* input, float* output)
+{
+  descriptor.connect_port(instance, INPUT, (void*)input);
+  descriptor.connect_port(instance, OUTPUT, output);
+  descriptor.run(instance, N_SAMPLES);
+}
+
+static void
+test_clone(void)
+{
+  static const char* const uris[] = {LV2_CLONE__interface};
+
+  const void*         data[1];
+  LV2_Extension_Table table;
+  lv2_extension_table_init(&table, &descriptor, uris, 1U, data);
+
+  const LV2_Clone_Interface* const iface =
+    (const LV2_Clone_Interface*)lv2_extension_table_get(&table, 0U);
+  assert(iface == &clone_iface);
+
+  float input[N_SAMPLES];
+  float a_output[N_SAMPLES];
+  float b_output[N_SAMPLES];
+  for (uint32_t s = 0U; s < N_SAMPLES; ++s) {
+    input[s] = (float)((s * 7U) % 13U) / 12.0f;
+  }
+
+  // Run the original for a while so its filter has some history
+  const LV2_Handle original =
+    descriptor.instantiate(&descriptor, 48000.0, "", NULL);
+  descriptor.activate(original);
+  run_cycle(original, input, a_output);
+
+  // The clone shares the table, and continues from the same filter state
+  const LV2_Handle copy = iface->clone(original, NULL);
+  assert(copy);
+  assert(n_tables_built == 1U);
+  assert(((const Shaper*)copy)->table == ((const Shaper*)original)->table);
+  assert(((const Shaper*)copy)->table->n_refs == 2U);
+  assert(!((const Shaper*)copy)->output);
+
+  run_cycle(original, input, a_output);
+  run_cycle(copy, input, b_output);
+  assert(!memcmp(a_output, b_output, sizeof(a_output)));
+
+  // The instances are independent, and may be destroyed in any order
+  descriptor.activate(copy);
+  run_cycle(copy, input, b_output);
+  assert(memcmp(a_output, b_output, sizeof(a_output)));
+
+  descriptor.cleanup(original);
+  assert(((const Shaper*)copy)->table->n_refs == 1U);
+  run_cycle(copy, input, b_output);
+  descriptor.cleanup(copy);
+}
+
+int
+main(void)
+{
+  test_clone();
+  return 0;
+}
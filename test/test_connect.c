@@ -0,0 +1,118 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/connect/connect.h>
+#include <lv2/connect/util.h>
+#include <lv2/core/extensions.h>
+#include <lv2/core/lv2.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define N_PORTS 8U
+
+typedef struct {
+  void*    ports[N_PORTS];
+  uint32_t n_connect_port_calls;
+  uint32_t n_connect_ports_calls;
+} TestPlugin;
+
+static TestPlugin test_plugin;
+
+static void
+connect_port(LV2_Handle instance, uint32_t port, void* data_location)
+{
+  TestPlugin* const plugin = (TestPlugin*)instance;
+
+  assert(port < N_PORTS);
+  plugin->ports[port] = data_location;
+  ++plugin->n_connect_port_calls;
+}
+
+static void
+connect_ports(LV2_Handle         instance,
+              uint32_t           first,
+              uint32_t           n_ports,
+              void* const* const data_locations)
+{
+  TestPlugin* const plugin = (TestPlugin*)instance;
+
+  assert(first <= N_PORTS && n_ports <= N_PORTS - first);
+  memcpy(plugin->ports + first, data_locations, n_ports * sizeof(void*));
+  ++plugin->n_connect_ports_calls;
+}
+
+static const LV2_Connect_Interface connect_iface = {connect_ports};
+
+static const void*
+extension_data(const char* uri)
+{
+  return !strcmp(uri, LV2_CONNECT__interface) ? &connect_iface : NULL;
+}
+
+static void
+test_connect(const LV2_Descriptor* const descriptor)
+{
+  float buffers[N_PORTS] = {0.0f};
+  void* locations[N_PORTS];
+  for (uint32_t i = 0U; i < N_PORTS; ++i) {
+    locations[i] = &buffers[i];
+  }
+
+  const LV2_Connect_Interface* const iface = lv2_connect_interface(descriptor);
+
+  // Connect every port, then reconnect a range to nothing
+  memset(&test_plugin, 0, sizeof(test_plugin));
+  lv2_connect_ports(descriptor, iface, &test_plugin, 0U, N_PORTS, locations);
+  for (uint32_t i = 0U; i < N_PORTS; ++i) {
+    assert(test_plugin.ports[i] == &buffers[i]);
+  }
+
+  void* const nothing[3] = {NULL, NULL, NULL};
+  lv2_connect_ports(descriptor, iface, &test_plugin, 2U, 3U, nothing);
+  for (uint32_t i = 0U; i < N_PORTS; ++i) {
+    assert(test_plugin.ports[i] == ((i >= 2U && i < 5U) ? NULL : &buffers[i]));
+  }
+
+  if (iface) {
+    assert(test_plugin.n_connect_ports_calls == 2U);
+    assert(test_plugin.n_connect_port_calls == 0U);
+  } else {
+    assert(test_plugin.n_connect_ports_calls == 0U);
+    assert(test_plugin.n_connect_port_calls == N_PORTS + 3U);
+  }
+}
+
+int
+main(void)
+{
+  LV2_Descriptor descriptor = {"http://example.org/plugin",
+                               NULL,
+                               connect_port,
+                               NULL,
+                               NULL,
+                               NULL,
+                               NULL,
+                               extension_data};
+
+  // The interface is used if the plugin provides it
+  static const char* const uris[] = {LV2_CONNECT__interface};
+
+  const void*         data[1];
+  LV2_Extension_Table table;
+  lv2_extension_table_init(&table, &descriptor, uris, 1U, data);
+  assert(lv2_extension_table_get(&table, 0U) == &connect_iface);
+  assert(lv2_connect_interface(&descriptor) == &connect_iface);
+  test_connect(&descriptor);
+
+  // Otherwise, connect_port() is called for every port
+  descriptor.extension_data = NULL;
+  assert(!lv2_connect_interface(&descriptor));
+  test_connect(&descriptor);
+
+  return 0;
+}
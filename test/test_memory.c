@@ -0,0 +1,217 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/memory/arena.h>
+#include <lv2/memory/memory.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ARENA_SIZE (1U << 20U)
+#define N_PTRS 256U
+
+static uint64_t memory[ARENA_SIZE / sizeof(uint64_t)];
+
+static uint32_t
+rng(uint32_t* const state)
+{
+  *state = (*state * 1664525U) + 1013904223U;
+  return *state >> 8U;
+}
+
+// Check every block, and that free blocks are merged and listed
+static size_t
+check_arena(const LV2_Memory_Arena* const arena)
+{
+  size_t                  n_free    = 0U;
+  size_t                  prev_size = 0U;
+  bool                    prev_free = false;
+  const LV2_Memory_Block* block     = (const LV2_Memory_Block*)arena->memory;
+  while (block->size != LV2_MEMORY_USED) {
+    const size_t size = lv2_memory_block_size(block);
+    const bool   free = !(block->size & LV2_MEMORY_USED);
+
+    assert(size >= LV2_MEMORY_MIN_BLOCK);
+    assert(!(size % LV2_MEMORY_ALIGN));
+    assert(block->prev_size == prev_size);
+    assert(!(free && prev_free));
+    if (free) {
+      uint32_t fl = 0U;
+      uint32_t sl = 0U;
+      assert(lv2_memory_mapping(size, &fl, &sl));
+      assert(arena->fl_bitmap & (1U << fl));
+      assert(arena->sl_bitmaps[fl] & (1U << sl));
+      n_free += size;
+    }
+
+    prev_size = size;
+    prev_free = free;
+    block     = (const LV2_Memory_Block*)((const uint8_t*)block + size);
+  }
+
+  assert((const uint8_t*)block + LV2_MEMORY_HEADER ==
+         arena->memory + arena->size);
+
+  return n_free;
+}
+
+static void
+test_mapping(void)
+{
+  uint32_t fl = 0U;
+  uint32_t sl = 0U;
+
+  assert(lv2_memory_fls(1U) == 0U);
+  assert(lv2_memory_fls(0x80000000U) == 31U);
+  assert(lv2_memory_fls(UINT64_C(0x100000000)) == 32U);
+  assert(lv2_memory_ffs(0x18U) == 3U);
+
+  assert(lv2_memory_mapping(32U, &fl, &sl) && fl == 0U && sl == 2U);
+  assert(lv2_memory_mapping(256U, &fl, &sl) && fl == 1U && sl == 0U);
+  assert(lv2_memory_mapping(511U, &fl, &sl) && fl == 1U && sl == 15U);
+  assert(lv2_memory_mapping(512U, &fl, &sl) && fl == 2U && sl == 0U);
+  assert(lv2_memory_mapping(544U, &fl, &sl) && fl == 2U && sl == 1U);
+}
+
+static void
+test_arena(void)
+{
+  LV2_Memory_Arena arena;
+  assert(!lv2_memory_arena_init(&arena, memory, 40U));
+  assert(lv2_memory_arena_init(&arena, (uint8_t*)memory + 3U, ARENA_SIZE - 3U));
+  assert(!((uintptr_t)arena.memory % LV2_MEMORY_ALIGN));
+
+  const size_t total = check_arena(&arena);
+  assert(total == arena.size - LV2_MEMORY_HEADER);
+
+  // Invalid requests fail
+  assert(!lv2_memory_arena_allocate(&arena, 0U, 0U));
+  assert(!lv2_memory_arena_allocate(&arena, 16U, 48U));
+  assert(!lv2_memory_arena_allocate(&arena, ARENA_SIZE, 0U));
+  assert(!lv2_memory_arena_allocate(&arena, SIZE_MAX, 0U));
+
+  // Allocate and free randomly, checking that memory is never shared
+  uint8_t* ptrs[N_PTRS];
+  size_t   sizes[N_PTRS];
+  uint32_t state = 1U;
+  memset(ptrs, 0, sizeof(ptrs));
+  for (uint32_t i = 0U; i < 20000U; ++i) {
+    const uint32_t r = rng(&state) % N_PTRS;
+    if (ptrs[r]) {
+      for (size_t j = 0U; j < sizes[r]; ++j) {
+        assert(ptrs[r][j] == (uint8_t)r);
+      }
+
+      lv2_memory_arena_deallocate(&arena, ptrs[r]);
+      ptrs[r] = NULL;
+    } else {
+      const size_t align = (size_t)1U << (rng(&state) % 9U);
+
+      sizes[r] = 1U + (rng(&state) % ((rng(&state) % 8U) ? 256U : 16384U));
+      ptrs[r]  = (uint8_t*)lv2_memory_arena_allocate(&arena, sizes[r], align);
+      assert(ptrs[r]);
+      assert(!((uintptr_t)ptrs[r] % align));
+      assert(!((uintptr_t)ptrs[r] % LV2_MEMORY_ALIGN));
+      assert(lv2_memory_arena_block_size(ptrs[r]) >= sizes[r]);
+      memset(ptrs[r], (int)r, sizes[r]);
+    }
+
+    if (!(i % 1000U)) {
+      check_arena(&arena);
+    }
+  }
+
+  // Freeing everything merges all blocks back into one
+  for (uint32_t r = 0U; r < N_PTRS; ++r) {
+    if (ptrs[r]) {
+      lv2_memory_arena_deallocate(&arena, ptrs[r]);
+    }
+  }
+
+  assert(check_arena(&arena) == total);
+  assert(lv2_memory_block_size((const LV2_Memory_Block*)arena.memory) ==
+         total);
+
+  // The whole arena can be used, and running out fails cleanly
+  void* const big = lv2_memory_arena_allocate(&arena, total / 2U, 0U);
+  assert(big);
+  assert(!lv2_memory_arena_allocate(&arena, total / 2U, 0U));
+  lv2_memory_arena_deallocate(&arena, big);
+  assert(check_arena(&arena) == total);
+}
+
+static void
+test_client(void)
+{
+  LV2_Memory_Arena  arena;
+  LV2_Memory_Client a;
+  LV2_Memory_Client b;
+  LV2_Memory_Stats  stats;
+
+  assert(lv2_memory_arena_init(&arena, memory, ARENA_SIZE));
+  assert(!lv2_memory_client_init(&a, &arena, ARENA_SIZE));
+  assert(!lv2_memory_client_init(&a, &arena, SIZE_MAX));
+  assert(lv2_memory_client_init(&a, &arena, 4096U));
+  assert(lv2_memory_client_init(&b, &arena, 0U));
+
+  // A client with a budget has its own sub-arena, and one without shares
+  assert(a.region && a.arena == &a.own);
+  assert(!b.region && b.arena == &arena);
+
+  const LV2_Memory_Allocator* const alloc = &a.allocator;
+
+  // Allocations are counted against the budget of each client
+  void* const p = alloc->allocate(alloc->handle, 1000U, 0U);
+  void* const q = alloc->allocate(alloc->handle, 2000U, 64U);
+  assert(p && q);
+  assert(!((uintptr_t)q % 64U));
+  assert((uint8_t*)p >= a.own.memory && (uint8_t*)q >= a.own.memory);
+  assert((uint8_t*)q < a.own.memory + a.own.size);
+  assert(!alloc->allocate(alloc->handle, 2000U, 0U));
+
+  lv2_memory_client_stats(&a, &stats);
+  assert(stats.used == lv2_memory_arena_block_size(p) +
+                         lv2_memory_arena_block_size(q));
+  assert(stats.used <= 4096U);
+  assert(stats.n_allocs == 2U);
+  assert(stats.n_failures == 1U);
+
+  void* const r = b.allocator.allocate(b.allocator.handle, 100000U, 0U);
+  assert(r);
+  lv2_memory_client_stats(&b, &stats);
+  assert(stats.used >= 100000U);
+
+  // Freeing returns memory to the client and the arena
+  alloc->deallocate(alloc->handle, q);
+  alloc->deallocate(alloc->handle, NULL);
+  lv2_memory_client_stats(&a, &stats);
+  assert(stats.used == lv2_memory_arena_block_size(p));
+  assert(stats.peak > stats.used);
+  assert(stats.n_frees == 1U);
+
+  alloc->deallocate(alloc->handle, p);
+  b.allocator.deallocate(b.allocator.handle, r);
+  lv2_memory_client_stats(&a, &stats);
+  assert(!stats.used);
+  assert(check_arena(&a.own) == a.own.size - LV2_MEMORY_HEADER);
+
+  // Cleanup returns the region of the client to the shared arena
+  lv2_memory_client_cleanup(&a);
+  lv2_memory_client_cleanup(&b);
+  assert(!a.region && a.arena == &arena);
+  assert(check_arena(&arena) == arena.size - LV2_MEMORY_HEADER);
+}
+
+int
+main(void)
+{
+  test_mapping();
+  test_arena();
+  test_client();
+  return 0;
+}
@@ -0,0 +1,348 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/core/atomic.h>
+#include <lv2/resource/resource.h>
+#include <lv2/resource/store.h>
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+#define TABLE_SIZE 1000U
+#define N_THREADS 4U
+
+static const char* const path = "test_resource.tmp";
+
+typedef struct {
+  uint64_t mtime;
+  uint32_t n_locked;
+  uint32_t n_builds;
+} TestHost;
+
+static int
+test_stat(void* handle, const char* file_path, uint64_t* size, uint64_t* mtime)
+{
+  const TestHost* const host = (const TestHost*)handle;
+
+  FILE* const file = fopen(file_path, "rb");
+  if (!file) {
+    return 1;
+  }
+
+  fseek(file, 0, SEEK_END);
+  *size  = (uint64_t)ftell(file);
+  *mtime = host->mtime;
+  fclose(file);
+  return 0;
+}
+
+static void
+test_lock(void* handle)
+{
+  TestHost* const host = (TestHost*)handle;
+
+  assert(!host->n_locked);
+  ++host->n_locked;
+}
+
+static void
+test_unlock(void* handle)
+{
+  TestHost* const host = (TestHost*)handle;
+
+  assert(host->n_locked == 1U);
+  --host->n_locked;
+}
+
+static int
+build_table(void* data, void* buffer, size_t size)
+{
+  TestHost* const host  = (TestHost*)data;
+  float* const    table = (float*)buffer;
+
+  assert(!host->n_locked);
+  assert(size == TABLE_SIZE * sizeof(float));
+  for (uint32_t i = 0U; i < TABLE_SIZE; ++i) {
+    table[i] = (float)i * 0.5f;
+  }
+
+  ++host->n_builds;
+  return 0;
+}
+
+static int
+build_failure(void* data, void* buffer, size_t size)
+{
+  (void)data;
+  (void)buffer;
+  (void)size;
+  return 1;
+}
+
+static void
+write_file(const char* const contents)
+{
+  FILE* const file = fopen(path, "wb");
+  assert(file);
+  assert(fwrite(contents, 1U, strlen(contents), file) == strlen(contents));
+  assert(!fclose(file));
+}
+
+static void
+test_acquire(const LV2_Resource_Cache* const cache, TestHost* const host)
+{
+  const char* const   key  = "http://example.org/plugin#table";
+  const size_t        size = TABLE_SIZE * sizeof(float);
+  const LV2_Resource* a    = NULL;
+  const LV2_Resource* b    = NULL;
+
+  // The first request builds the resource, and later ones share it
+  assert((a = cache->acquire(cache->handle, key, size, build_table, host)));
+  assert((b = cache->acquire(cache->handle, key, size, build_table, host)));
+  assert(a == b);
+  assert(host->n_builds == 1U);
+  assert(a->size == size);
+  assert(!((uintptr_t)a->data % LV2_RESOURCE_STORE_ALIGN));
+  assert(((const float*)a->data)[TABLE_SIZE - 1U] == 499.5f);
+
+  // Requests with a different size or a failed build return nothing
+  assert(!cache->acquire(cache->handle, key, size * 2U, build_table, host));
+  assert(!cache->acquire(cache->handle, key, 0U, build_table, host));
+  assert(!cache->acquire(cache->handle, "other", size, build_failure, host));
+  assert(host->n_builds == 1U);
+
+  // The resource is built again once every reference is released
+  cache->release(cache->handle, a);
+  cache->release(cache->handle, b);
+  assert((a = cache->acquire(cache->handle, key, size, build_table, host)));
+  assert(host->n_builds == 2U);
+  cache->release(cache->handle, a);
+}
+
+static void
+test_map_file(const LV2_Resource_Cache* const cache, TestHost* const host)
+{
+  const LV2_Resource* a = NULL;
+  const LV2_Resource* b = NULL;
+  const LV2_Resource* c = NULL;
+
+  assert(!cache->map_file(cache->handle, "/does/not/exist"));
+
+  // A file is shared while it is unchanged
+  write_file("first");
+  assert((a = cache->map_file(cache->handle, path)));
+  assert((b = cache->map_file(cache->handle, path)));
+  assert(a == b);
+  assert(a->size == 5U);
+  assert(!memcmp(a->data, "first", 5U));
+  assert(!((uintptr_t)a->data % LV2_RESOURCE_STORE_ALIGN));
+
+  // A modified file is loaded again, and the old contents stay valid
+  write_file("second");
+  host->mtime = 2U;
+  assert((c = cache->map_file(cache->handle, path)));
+  assert(c != a);
+  assert(c->size == 6U);
+  assert(!memcmp(c->data, "second", 6U));
+  assert(!memcmp(a->data, "first", 5U));
+
+  cache->release(cache->handle, a);
+  cache->release(cache->handle, b);
+  cache->release(cache->handle, c);
+  assert(!remove(path));
+}
+
+static void
+test_store(void)
+{
+  TestHost                      host = {1U, 0U, 0U};
+  const LV2_Resource_Store_Host ops  = {&host,
+                                        test_stat,
+                                        lv2_resource_store_stdio_map,
+                                        lv2_resource_store_stdio_unmap,
+                                        test_lock,
+                                        test_unlock,
+                                        NULL,
+                                        NULL};
+
+  LV2_Resource_Store store;
+  lv2_resource_store_init(&store, &ops);
+
+  test_acquire(&store.cache, &host);
+  assert(!store.entries);
+  assert(!store.n_bytes);
+  assert(store.n_loads == 2U);
+  assert(store.n_shares == 1U);
+
+  test_map_file(&store.cache, &host);
+  assert(!store.entries);
+  assert(!store.n_bytes);
+  assert(store.n_loads == 4U);
+  assert(store.n_shares == 2U);
+
+  // Cleanup frees any resources that were not released
+  write_file("leak");
+  assert(store.cache.map_file(store.cache.handle, path));
+  assert(store.n_bytes == 4U);
+  lv2_resource_store_cleanup(&store);
+  assert(!store.entries);
+  assert(!store.n_bytes);
+  assert(!host.n_locked);
+  assert(!remove(path));
+}
+
+#ifndef _WIN32
+
+typedef struct {
+  pthread_mutex_t    mutex;
+  pthread_cond_t     cond;
+  LV2_Resource_Store store;
+  volatile uint32_t  n_builds;
+  volatile uint32_t  other_built;
+} ThreadHost;
+
+static void
+thread_lock(void* handle)
+{
+  assert(!pthread_mutex_lock(&((ThreadHost*)handle)->mutex));
+}
+
+static void
+thread_unlock(void* handle)
+{
+  assert(!pthread_mutex_unlock(&((ThreadHost*)handle)->mutex));
+}
+
+static void
+thread_wait(void* handle)
+{
+  ThreadHost* const host = (ThreadHost*)handle;
+
+  assert(!pthread_cond_wait(&host->cond, &host->mutex));
+}
+
+static void
+thread_wake(void* handle)
+{
+  assert(!pthread_cond_broadcast(&((ThreadHost*)handle)->cond));
+}
+
+// Builds a slow resource, which only finishes after another one is built
+static int
+build_slow(void* data, void* buffer, size_t size)
+{
+  ThreadHost* const host = (ThreadHost*)data;
+
+  lv2_atomic_add(&host->n_builds, 1U);
+  while (!lv2_atomic_load(&host->other_built)) {
+    sched_yield();
+  }
+
+  memset(buffer, 1, size);
+  return 0;
+}
+
+static int
+build_other(void* data, void* buffer, size_t size)
+{
+  ThreadHost* const host = (ThreadHost*)data;
+
+  memset(buffer, 2, size);
+  lv2_atomic_store(&host->other_built, 1U);
+  return 0;
+}
+
+static void*
+acquire_slow(void* data)
+{
+  ThreadHost* const         host  = (ThreadHost*)data;
+  const LV2_Resource_Cache* cache = &host->store.cache;
+
+  return (void*)cache->acquire(cache->handle, "slow", 4096U, build_slow, host);
+}
+
+// Builds a resource while other threads request it and another resource
+static void
+test_threads(void)
+{
+  static ThreadHost host;
+
+  // Files are not used here, only built resources
+  const LV2_Resource_Store_Host ops = {&host,
+                                       NULL,
+                                       NULL,
+                                       NULL,
+                                       thread_lock,
+                                       thread_unlock,
+                                       thread_wait,
+                                       thread_wake};
+
+  pthread_t           threads[N_THREADS];
+  const LV2_Resource* results[N_THREADS];
+  assert(!pthread_mutex_init(&host.mutex, NULL));
+  assert(!pthread_cond_init(&host.cond, NULL));
+  lv2_resource_store_init(&host.store, &ops);
+
+  for (uint32_t i = 0U; i < N_THREADS; ++i) {
+    assert(!pthread_create(&threads[i], NULL, acquire_slow, &host));
+  }
+
+  // Wait until the slow build has started, then build another meanwhile
+  while (!lv2_atomic_load(&host.n_builds)) {
+    sched_yield();
+  }
+
+  const LV2_Resource_Cache* const cache = &host.store.cache;
+  const LV2_Resource* const       other =
+    cache->acquire(cache->handle, "other", 64U, build_other, &host);
+  assert(other);
+  assert(((const uint8_t*)other->data)[63] == 2U);
+
+  // Every thread gets the same resource, which was only built once
+  for (uint32_t i = 0U; i < N_THREADS; ++i) {
+    void* result = NULL;
+    assert(!pthread_join(threads[i], &result));
+    results[i] = (const LV2_Resource*)result;
+    assert(results[i] == results[0]);
+  }
+
+  assert(results[0]);
+  assert(((const uint8_t*)results[0]->data)[4095] == 1U);
+  assert(host.n_builds == 1U);
+  assert(host.store.n_loads == 2U);
+  assert(host.store.n_shares == N_THREADS - 1U);
+
+  for (uint32_t i = 0U; i < N_THREADS; ++i) {
+    cache->release(cache->handle, results[i]);
+  }
+
+  cache->release(cache->handle, other);
+  assert(!host.store.entries);
+  assert(!host.store.n_bytes);
+
+  lv2_resource_store_cleanup(&host.store);
+  assert(!pthread_cond_destroy(&host.cond));
+  assert(!pthread_mutex_destroy(&host.mutex));
+}
+
+#endif
+
+int
+main(void)
+{
+  test_store();
+#ifndef _WIN32
+  test_threads();
+#endif
+  return 0;
+}
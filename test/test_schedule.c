@@ -0,0 +1,313 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/core/atomic.h>
+#include <lv2/core/lv2.h>
+#include <lv2/core/schedule.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+#define N_NODES 9U
+#define N_EDGES 8U
+#define N_WORKERS 2U
+#define N_CYCLES 3U
+#define N_STRESS_WORKERS 4U
+#define N_STRESS_CYCLES 3000U
+
+typedef struct {
+  uint32_t n_runs;
+  uint32_t sample_count;
+  uint32_t stamp;
+} TestNode;
+
+typedef struct {
+  LV2_Schedule* schedule;
+  uint32_t      n_notifies;
+  bool          help;
+} TestHost;
+
+static TestNode test_nodes[N_NODES];
+static uint32_t now = 0U;
+
+static const LV2_Schedule_Edge edges[N_EDGES] = {
+  {0U, 2U},
+  {1U, 2U},
+  {2U, 3U},
+  {2U, 4U},
+  {3U, 5U},
+  {4U, 5U},
+  {7U, 8U},
+  {5U, 8U},
+};
+
+static void
+run(LV2_Handle instance, uint32_t sample_count)
+{
+  TestNode* const node = (TestNode*)instance;
+
+  ++node->n_runs;
+  node->sample_count = sample_count;
+  node->stamp        = ++now;
+}
+
+static const LV2_Descriptor descriptor = {
+  "http://example.org/node", NULL, NULL, NULL, run, NULL, NULL, NULL};
+
+// Simulates another worker thread helping as soon as it is notified
+static void
+notify(void* handle)
+{
+  TestHost* const host = (TestHost*)handle;
+
+  ++host->n_notifies;
+  if (host->help) {
+    assert(lv2_schedule_help(host->schedule, 1U));
+  }
+}
+
+static void
+init_graph(LV2_Schedule_Node* const nodes)
+{
+  memset(test_nodes, 0, sizeof(test_nodes));
+  for (uint32_t n = 0U; n < N_NODES; ++n) {
+    nodes[n].descriptor = &descriptor;
+    nodes[n].instance   = &test_nodes[n];
+  }
+}
+
+static bool
+build(LV2_Schedule* const            schedule,
+      LV2_Schedule_Node* const       nodes,
+      const LV2_Schedule_Edge* const graph,
+      const uint32_t                 n_edges,
+      LV2_Schedule_Worker* const     workers,
+      const uint32_t                 n_workers,
+      uint32_t* const                memory)
+{
+  return lv2_schedule_init(schedule,
+                           nodes,
+                           N_NODES,
+                           graph,
+                           n_edges,
+                           workers,
+                           n_workers,
+                           memory,
+                           NULL,
+                           NULL);
+}
+
+// Check that every node ran once, and after all of its dependencies
+static void
+check_cycle(const uint32_t cycle, const uint32_t sample_count)
+{
+  for (uint32_t n = 0U; n < N_NODES; ++n) {
+    assert(test_nodes[n].n_runs == cycle + 1U);
+    assert(test_nodes[n].sample_count == sample_count);
+  }
+
+  for (uint32_t e = 0U; e < N_EDGES; ++e) {
+    assert(test_nodes[edges[e].from].stamp < test_nodes[edges[e].to].stamp);
+  }
+}
+
+static void
+test_init(void)
+{
+  LV2_Schedule_Node   nodes[N_NODES];
+  LV2_Schedule_Worker workers[N_WORKERS];
+  uint32_t            memory[N_EDGES + N_NODES + (N_WORKERS * N_NODES)];
+  LV2_Schedule        schedule;
+
+  assert(lv2_schedule_memory_size(N_NODES, N_EDGES, N_WORKERS) ==
+         sizeof(memory) / sizeof(uint32_t));
+
+  init_graph(nodes);
+  assert(build(&schedule, nodes, edges, N_EDGES, workers, 1U, memory));
+  assert(schedule.n_sources == 4U);
+  assert(nodes[2].n_predecessors == 2U);
+  assert(nodes[2].n_successors == 2U);
+  assert(nodes[8].n_predecessors == 2U);
+
+  // Graphs with cycles or invalid edges are rejected
+  const LV2_Schedule_Edge cycle[] = {{0U, 1U}, {1U, 2U}, {2U, 0U}};
+  const LV2_Schedule_Edge loop[]  = {{3U, 3U}};
+  const LV2_Schedule_Edge wild[]  = {{0U, N_NODES}};
+  assert(!build(&schedule, nodes, cycle, 3U, workers, 1U, memory));
+  assert(!build(&schedule, nodes, loop, 1U, workers, 1U, memory));
+  assert(!build(&schedule, nodes, wild, 1U, workers, 1U, memory));
+  assert(!build(&schedule, nodes, edges, N_EDGES, workers, 0U, memory));
+}
+
+static void
+test_serial(void)
+{
+  LV2_Schedule_Node   nodes[N_NODES];
+  LV2_Schedule_Worker workers[1];
+  uint32_t            memory[N_EDGES + N_NODES + N_NODES];
+  LV2_Schedule        schedule;
+
+  init_graph(nodes);
+  assert(build(&schedule, nodes, edges, N_EDGES, workers, 1U, memory));
+
+  for (uint32_t c = 0U; c < N_CYCLES; ++c) {
+    lv2_schedule_run(&schedule, 64U + c);
+    check_cycle(c, 64U + c);
+  }
+
+  assert(workers[0].n_run == N_CYCLES * N_NODES);
+  assert(!workers[0].n_stolen);
+}
+
+static void
+test_parallel(void)
+{
+  LV2_Schedule_Node   nodes[N_NODES];
+  LV2_Schedule_Worker workers[N_WORKERS];
+  uint32_t            memory[N_EDGES + N_NODES + (N_WORKERS * N_NODES)];
+  LV2_Schedule        schedule;
+  TestHost            host = {&schedule, 0U, false};
+
+  init_graph(nodes);
+  assert(lv2_schedule_init(&schedule,
+                           nodes,
+                           N_NODES,
+                           edges,
+                           N_EDGES,
+                           workers,
+                           N_WORKERS,
+                           memory,
+                           notify,
+                           &host));
+
+  // Without help, the calling worker steals the nodes dealt to the other
+  lv2_schedule_run(&schedule, 32U);
+  check_cycle(0U, 32U);
+  assert(host.n_notifies == 1U);
+  assert(workers[0].n_run == N_NODES);
+  assert(workers[0].n_stolen == 2U);
+
+  // A helping worker runs its own nodes, and steals the rest
+  host.help = true;
+  for (uint32_t c = 1U; c < N_CYCLES; ++c) {
+    lv2_schedule_run(&schedule, 32U);
+    check_cycle(c, 32U);
+  }
+
+  assert(host.n_notifies == N_CYCLES);
+  assert(workers[1].n_run == (N_CYCLES - 1U) * N_NODES);
+  assert(workers[1].n_stolen == (N_CYCLES - 1U) * 2U);
+  assert(workers[0].n_run == N_NODES);
+
+  // Workers can not join when no cycle is running
+  assert(!schedule.state);
+  assert(!lv2_schedule_help(&schedule, 1U));
+}
+
+#ifndef _WIN32
+
+typedef struct {
+  LV2_Schedule*     schedule;
+  uint32_t          index;
+  volatile uint32_t stop;
+} StressHelper;
+
+static volatile uint32_t stress_clock = 0U;
+
+static void
+stress_run(LV2_Handle instance, uint32_t sample_count)
+{
+  TestNode* const node = (TestNode*)instance;
+
+  ++node->n_runs;
+  node->sample_count = sample_count;
+  node->stamp        = lv2_atomic_add(&stress_clock, 1U) + 1U;
+}
+
+static const LV2_Descriptor stress_descriptor = {
+  "http://example.org/node", NULL, NULL, NULL, stress_run, NULL, NULL, NULL};
+
+static void*
+stress_helper(void* data)
+{
+  StressHelper* const helper = (StressHelper*)data;
+
+  while (!lv2_atomic_load(&helper->stop)) {
+    if (!lv2_schedule_help(helper->schedule, helper->index)) {
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+// Runs many cycles while other threads help, and checks that every node runs
+// exactly once per cycle, after all of its dependencies
+static void
+test_stress(void)
+{
+  LV2_Schedule_Node   nodes[N_NODES];
+  LV2_Schedule_Worker workers[N_STRESS_WORKERS];
+  uint32_t            memory[N_EDGES + N_NODES + (N_STRESS_WORKERS * N_NODES)];
+  LV2_Schedule        schedule;
+  StressHelper        helpers[N_STRESS_WORKERS];
+  pthread_t           threads[N_STRESS_WORKERS];
+
+  init_graph(nodes);
+  for (uint32_t n = 0U; n < N_NODES; ++n) {
+    nodes[n].descriptor = &stress_descriptor;
+  }
+
+  assert(build(
+    &schedule, nodes, edges, N_EDGES, workers, N_STRESS_WORKERS, memory));
+
+  for (uint32_t i = 1U; i < N_STRESS_WORKERS; ++i) {
+    helpers[i].schedule = &schedule;
+    helpers[i].index    = i;
+    helpers[i].stop     = 0U;
+    assert(!pthread_create(&threads[i], NULL, stress_helper, &helpers[i]));
+  }
+
+  for (uint32_t c = 0U; c < N_STRESS_CYCLES; ++c) {
+    lv2_schedule_run(&schedule, 16U + (c % 7U));
+    check_cycle(c, 16U + (c % 7U));
+  }
+
+  for (uint32_t i = 1U; i < N_STRESS_WORKERS; ++i) {
+    lv2_atomic_store(&helpers[i].stop, 1U);
+    assert(!pthread_join(threads[i], NULL));
+  }
+
+  // Every node ran once per cycle, on some worker, and every helper has left
+  uint32_t n_run = 0U;
+  for (uint32_t w = 0U; w < N_STRESS_WORKERS; ++w) {
+    n_run += workers[w].n_run;
+  }
+
+  assert(n_run == N_STRESS_CYCLES * N_NODES);
+  assert(!schedule.state);
+}
+
+#endif
+
+int
+main(void)
+{
+  test_init();
+  test_serial();
+  test_parallel();
+#ifndef _WIN32
+  test_stress();
+#endif
+  return 0;
+}
@@ -0,0 +1,1233 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/atom/atom.h>
+#include <lv2/core/atomic.h>
+#include <lv2/core/lv2.h>
+#include <lv2/state/blobs.h>
+#include <lv2/state/cell.h>
+#include <lv2/state/delta.h>
+#include <lv2/state/lazy.h>
+#include <lv2/state/paths.h>
+#include <lv2/state/restore.h>
+#include <lv2/state/state.h>
+#include <lv2/state/store.h>
+#include <lv2/state/swap.h>
+#include <lv2/urid/urid.h>
+#include <lv2/worker/pool.h>
+#include <lv2/worker/worker.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define EG_PREFIX "http://example.org/"
+#define MAX_URIS 32U
+
+typedef struct {
+  const char* uris[MAX_URIS];
+  uint32_t    n_uris;
+} URITable;
+
+typedef struct {
+  char   buf[1024];
+  size_t len;
+} TextBuffer;
+
+static LV2_URID
+map_uri(LV2_URID_Map_Handle handle, const char* uri)
+{
+  URITable* const table = (URITable*)handle;
+  for (uint32_t i = 0U; i < table->n_uris; ++i) {
+    if (!strcmp(table->uris[i], uri)) {
+      return i + 1U;
+    }
+  }
+
+  assert(table->n_uris < MAX_URIS);
+  table->uris[table->n_uris++] = uri;
+  return table->n_uris;
+}
+
+static const char*
+unmap_uri(LV2_URID_Unmap_Handle handle, LV2_URID urid)
+{
+  const URITable* const table = (const URITable*)handle;
+
+  return (urid && urid <= table->n_uris) ? table->uris[urid - 1U] : NULL;
+}
+
+static size_t
+text_sink(const void* buf, size_t len, void* stream)
+{
+  TextBuffer* const text = (TextBuffer*)stream;
+  if (text->len + len >= sizeof(text->buf)) {
+    return 0U;
+  }
+
+  memcpy(text->buf + text->len, buf, len);
+  text->len += len;
+  text->buf[text->len] = '\0';
+  return len;
+}
+
+static void
+test_store(void)
+{
+  static uint64_t buf[128];
+  static uint64_t small[16];
+
+  LV2_State_Store_Entry entries[8];
+  LV2_URID              uris[16];
+  uint32_t              slots[16U + 32U];
+  URITable              saved = {{NULL}, 0U};
+  LV2_URID_Map          map   = {&saved, map_uri};
+  LV2_URID_Unmap        unmap = {&saved, unmap_uri};
+
+  const LV2_URID eg_gain  = map_uri(&saved, EG_PREFIX "gain");
+  const LV2_URID eg_name  = map_uri(&saved, EG_PREFIX "name");
+  const LV2_URID eg_table = map_uri(&saved, EG_PREFIX "table");
+  const LV2_URID eg_ptr   = map_uri(&saved, EG_PREFIX "pointer");
+  const LV2_URID a_Float  = map.map(map.handle, LV2_ATOM__Float);
+  const LV2_URID a_String = map.map(map.handle, LV2_ATOM__String);
+  const LV2_URID a_Chunk  = map.map(map.handle, LV2_ATOM__Chunk);
+  const uint32_t pod      = LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE;
+
+  const float   gain     = 0.5f;
+  const float   new_gain = 0.25f;
+  const char    name[]   = "Say \"hi\"";
+  const uint8_t table[5] = {1U, 2U, 3U, 4U, 5U};
+
+  assert(lv2_state_store_n_slots(8U, 16U) == sizeof(slots) / sizeof(uint32_t));
+
+  LV2_State_Store_Writer writer;
+  lv2_state_store_writer_init(
+    &writer, buf, sizeof(buf), entries, 8U, uris, 16U, slots, &unmap);
+
+  // Save properties as a plugin would, replacing one
+  LV2_State_Handle handle = &writer;
+  assert(!lv2_state_store_store(handle, eg_gain, &gain, 4U, a_Float, pod));
+  assert(!lv2_state_store_store(
+    handle, eg_name, name, sizeof(name), a_String, pod));
+  assert(!lv2_state_store_store(
+    handle, eg_table, table, sizeof(table), a_Chunk, pod));
+  assert(!lv2_state_store_store(handle, eg_gain, &new_gain, 4U, a_Float, pod));
+  assert(writer.n_entries == 3U);
+  assert(writer.n_uris == 6U);
+
+  // Values that are not POD are refused
+  assert(lv2_state_store_store(
+           handle, eg_ptr, &handle, sizeof(handle), a_Chunk, 0U) ==
+         LV2_STATE_ERR_BAD_FLAGS);
+
+  const uint64_t size = lv2_state_store_writer_finish(&writer);
+  assert(size > 0U && size <= sizeof(buf));
+
+  // Restore with a different mapping, as in a later run
+  URITable               loaded = {{NULL}, 0U};
+  LV2_URID_Map           map2   = {&loaded, map_uri};
+  LV2_URID               urids[16];
+  LV2_State_Store_Index  index[8];
+  LV2_State_Store_Reader reader;
+
+  map_uri(&loaded, EG_PREFIX "unrelated");
+  const LV2_State_Store_Header* const header = lv2_state_store_check(buf, size);
+  assert(header);
+  assert(header->n_entries == 3U);
+  assert(header->n_uris == 6U);
+  assert(!lv2_state_store_reader_init(&reader, header, &map2, urids, index));
+
+  size_t   value_size  = 0U;
+  uint32_t value_type  = 0U;
+  uint32_t value_flags = 0U;
+
+  const float* const gain_ptr = (const float*)lv2_state_store_retrieve(
+    &reader,
+    map_uri(&loaded, EG_PREFIX "gain"),
+    &value_size,
+    &value_type,
+    &value_flags);
+
+  assert(gain_ptr);
+  assert((const void*)gain_ptr > (const void*)buf);
+  assert((const void*)gain_ptr < (const void*)(buf + (size / 8U)));
+  assert(((uintptr_t)gain_ptr & 7U) == 0U);
+  assert(*gain_ptr == new_gain);
+  assert(value_size == sizeof(float));
+  assert(value_type == map_uri(&loaded, LV2_ATOM__Float));
+  assert(value_flags == pod);
+
+  const char* const name_ptr = (const char*)lv2_state_store_retrieve(
+    &reader, map_uri(&loaded, EG_PREFIX "name"), NULL, NULL, NULL);
+  assert(name_ptr && !strcmp(name_ptr, name));
+  assert(!lv2_state_store_retrieve(
+    &reader, map_uri(&loaded, EG_PREFIX "pointer"), NULL, NULL, NULL));
+
+  // Export as Turtle
+  TextBuffer text = {{0}, 0U};
+  assert(lv2_state_store_write_turtle(header, text_sink, &text, NULL));
+  assert(!strcmp(text.buf,
+                 "[\n"
+                 "\t<http://example.org/gain> \"0.25\"^^xsd:float ;\n"
+                 "\t<http://example.org/name> \"Say \\\"hi\\\"\" ;\n"
+                 "\t<http://example.org/table> \"AQIDBAU=\"^^<" LV2_ATOM__Chunk
+                 ">\n]"));
+
+  // Corrupt containers are rejected
+  assert(!lv2_state_store_check(buf, sizeof(LV2_State_Store_Header) - 1U));
+  assert(!lv2_state_store_check(buf, size - 1U));
+  ((uint8_t*)buf)[size - 1U] ^= 0x80U;
+  assert(!lv2_state_store_check(buf, size));
+  ((uint8_t*)buf)[size - 1U] ^= 0x80U;
+  ((LV2_State_Store_Header*)buf)->byte_order = 0x04030201U;
+  assert(!lv2_state_store_check(buf, size));
+
+  // A full URI table is detected before anything is added
+  lv2_state_store_writer_init(
+    &writer, buf, sizeof(buf), entries, 8U, uris, 3U, slots, &unmap);
+  assert(!lv2_state_store_store(handle, eg_gain, &gain, 4U, a_Float, pod));
+  const uint64_t used = writer.size;
+  assert(lv2_state_store_store(
+           handle, eg_name, name, sizeof(name), a_String, pod) ==
+         LV2_STATE_ERR_NO_SPACE);
+  assert(writer.size == used);
+  assert(writer.n_entries == 1U);
+  assert(writer.n_uris == 2U);
+
+  // The discarded key can still be stored with a known type
+  assert(!lv2_state_store_store(handle, eg_name, &gain, 4U, a_Float, pod));
+  assert(writer.n_entries == 2U);
+  assert(writer.n_uris == 3U);
+  assert(lv2_state_store_entry(&writer, eg_name) == &entries[1]);
+
+  // Writing fails cleanly without enough space
+  lv2_state_store_writer_init(
+    &writer, small, sizeof(small), entries, 8U, uris, 16U, slots, &unmap);
+  assert(!lv2_state_store_store(handle, eg_gain, &gain, 4U, a_Float, pod));
+  const uint64_t small_used = writer.size;
+  assert(lv2_state_store_store(handle, eg_table, buf, 80U, a_Chunk, pod) ==
+         LV2_STATE_ERR_NO_SPACE);
+  assert(writer.size == small_used);
+  assert(writer.n_entries == 1U);
+  assert(writer.n_uris == 2U);
+  assert(!lv2_state_store_writer_finish(&writer));
+}
+
+typedef struct {
+  LV2_State_Store_Entry  entries[8];
+  LV2_URID               uris[16];
+  uint32_t               slots[16U + 32U];
+  LV2_URID               urids[16];
+  LV2_State_Store_Index  index[8];
+  LV2_State_Store_Writer writer;
+  LV2_State_Store_Reader reader;
+  uint64_t               buf[64];
+} Container;
+
+static void
+test_sort(void)
+{
+  static LV2_State_Store_Entry entries[256];
+  static LV2_URID              urids[256];
+  static LV2_State_Store_Index index[256];
+
+  // Sort keys in order, reversed, and scrambled
+  for (uint32_t order = 0U; order < 3U; ++order) {
+    for (uint32_t i = 0U; i < 256U; ++i) {
+      entries[i].key = i;
+      urids[i]       = (order == 0U)   ? i + 1U
+                       : (order == 1U) ? 256U - i
+                                       : ((i * 97U) % 256U) + 1U;
+    }
+
+    lv2_state_store_sort(entries, 256U, urids, index);
+    for (uint32_t i = 0U; i < 256U; ++i) {
+      assert(index[i].key == i + 1U);
+      assert(urids[entries[index[i].entry].key] == index[i].key);
+      assert(!index[i].value);
+    }
+  }
+
+  lv2_state_store_sort(entries, 0U, urids, index);
+}
+
+static void
+test_delta(void)
+{
+  static Container containers[3];
+
+  URITable       table = {{NULL}, 0U};
+  LV2_URID_Map   map   = {&table, map_uri};
+  LV2_URID_Unmap unmap = {&table, unmap_uri};
+
+  const LV2_URID eg_gain  = map_uri(&table, EG_PREFIX "gain");
+  const LV2_URID eg_name  = map_uri(&table, EG_PREFIX "name");
+  const LV2_URID eg_mode  = map_uri(&table, EG_PREFIX "mode");
+  const LV2_URID a_Float  = map.map(map.handle, LV2_ATOM__Float);
+  const LV2_URID a_Int    = map.map(map.handle, LV2_ATOM__Int);
+  const LV2_URID a_String = map.map(map.handle, LV2_ATOM__String);
+  const uint32_t pod      = LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE;
+
+  const float   gain     = 0.5f;
+  const float   new_gain = 0.25f;
+  const char    name[]   = "Delta";
+  const int32_t mode     = 3;
+
+  // A new instance needs saving, and a saved one does not
+  LV2_State_Delta_Tracker tracker;
+  uint32_t                changes = 0U;
+  lv2_state_delta_tracker_init(&tracker, &map);
+  assert(lv2_state_delta_needs_save(&tracker, &changes));
+  lv2_state_delta_saved(&tracker, changes);
+  assert(!lv2_state_delta_needs_save(&tracker, &changes));
+
+  // Other events are ignored, but state:StateChanged is recorded
+  struct {
+    LV2_Atom_Sequence    seq;
+    LV2_Atom_Event       ev;
+    LV2_Atom_Object_Body body;
+  } output = {{{sizeof(output) - sizeof(LV2_Atom), 0U}, {0U, 0U}},
+              {{0U}, {sizeof(LV2_Atom_Object_Body), a_Int}},
+              {0U, 0U}};
+
+  output.seq.atom.type = map.map(map.handle, LV2_ATOM__Sequence);
+  lv2_state_delta_scan(&tracker, &output.seq);
+  assert(!lv2_state_delta_needs_save(&tracker, &changes));
+  output.ev.body.type = map.map(map.handle, LV2_ATOM__Object);
+  output.body.otype   = map.map(map.handle, LV2_STATE__StateChanged);
+  lv2_state_delta_scan(&tracker, &output.seq);
+  assert(lv2_state_delta_needs_save(&tracker, &changes));
+
+  LV2_State_Delta_Entry  hashes[8];
+  LV2_State_Delta        delta;
+  LV2_State_Delta_Writer writer;
+  uint64_t               sizes[3] = {0U, 0U, 0U};
+  lv2_state_delta_init(&delta, hashes, 8U);
+
+  for (unsigned i = 0U; i < 3U; ++i) {
+    Container* const c = &containers[i];
+    lv2_state_store_writer_init(&c->writer,
+                                c->buf,
+                                sizeof(c->buf),
+                                c->entries,
+                                8U,
+                                c->uris,
+                                16U,
+                                c->slots,
+                                &unmap);
+    lv2_state_delta_begin(&writer, &delta, &c->writer);
+
+    // Save as a plugin would, changing the gain and dropping the mode last
+    const float* const g = (i < 2U) ? &gain : &new_gain;
+    assert(!lv2_state_delta_store(&writer, eg_gain, g, 4U, a_Float, pod));
+    assert(!lv2_state_delta_store(
+      &writer, eg_name, name, sizeof(name), a_String, pod));
+    if (i < 2U) {
+      assert(!lv2_state_delta_store(&writer, eg_mode, &mode, 4U, a_Int, pod));
+    }
+
+    sizes[i] = lv2_state_delta_finish(&writer);
+    assert(sizes[i]);
+    assert(!lv2_state_store_reader_init(&c->reader,
+                                        lv2_state_store_check(c->buf, sizes[i]),
+                                        &map,
+                                        c->urids,
+                                        c->index));
+  }
+
+  // The first save is full, the second empty, and the third a delta
+  assert(containers[0].reader.header->n_entries == 3U);
+  assert(containers[1].reader.header->n_entries == 0U);
+  assert(containers[2].reader.header->n_entries == 2U);
+  assert(writer.n_changed == 2U);
+  assert(writer.n_unchanged == 1U);
+  assert(delta.n_entries == 2U);
+  assert(sizes[1] < sizes[2] && sizes[2] < sizes[0]);
+
+  // Removed properties are omitted when exported
+  TextBuffer text = {{0}, 0U};
+  assert(lv2_state_store_write_turtle(
+    containers[2].reader.header, text_sink, &text, NULL));
+  assert(!strcmp(text.buf,
+                 "[\n\t<http://example.org/gain> \"0.25\"^^xsd:float\n]"));
+
+  // Layered restore takes the newest value of each property
+  LV2_State_Store_Reader layers[3];
+  for (unsigned i = 0U; i < 3U; ++i) {
+    layers[i] = containers[i].reader;
+  }
+
+  LV2_State_Delta_Reader reader = {layers, 3U};
+  size_t                 size   = 0U;
+  uint32_t               type   = 0U;
+
+  const float* const gain_ptr = (const float*)lv2_state_delta_retrieve(
+    &reader, eg_gain, &size, &type, NULL);
+  assert(gain_ptr && *gain_ptr == new_gain);
+  assert(size == 4U && type == a_Float);
+
+  const char* const name_ptr = (const char*)lv2_state_delta_retrieve(
+    &reader, eg_name, NULL, NULL, NULL);
+  assert(name_ptr && !strcmp(name_ptr, name));
+  assert(!lv2_state_delta_retrieve(&reader, eg_mode, NULL, NULL, NULL));
+
+  // Without the last layer, the removed property is still there
+  reader.n_layers = 2U;
+  assert(lv2_state_delta_retrieve(&reader, eg_mode, NULL, NULL, NULL));
+  assert(*(const float*)lv2_state_delta_retrieve(
+           &reader, eg_gain, NULL, NULL, NULL) == gain);
+
+  // Resetting makes the next save full again
+  lv2_state_delta_reset(&delta);
+  Container* const c = &containers[1];
+  lv2_state_store_writer_init(&c->writer,
+                              c->buf,
+                              sizeof(c->buf),
+                              c->entries,
+                              8U,
+                              c->uris,
+                              16U,
+                              c->slots,
+                              &unmap);
+  lv2_state_delta_begin(&writer, &delta, &c->writer);
+  assert(!lv2_state_delta_store(&writer, eg_gain, &gain, 4U, a_Float, pod));
+  assert(writer.n_changed == 1U);
+  assert(lv2_state_delta_finish(&writer));
+}
+
+typedef struct {
+  LV2_State_Restore_Scheduler* sched;
+  uint32_t                     order;
+  uint32_t                     n_notified;
+  uint32_t                     n_exclusive;
+  uint64_t                     time;
+  bool                         nest;
+} RestoreLog;
+
+typedef struct {
+  RestoreLog* log;
+  uint32_t    order;
+  uint64_t    duration;
+} TestInstance;
+
+static void
+count_notify(void* handle)
+{
+  ++((RestoreLog*)handle)->n_notified;
+}
+
+static uint64_t
+step_clock(void* handle)
+{
+  return ((RestoreLog*)handle)->time;
+}
+
+static LV2_State_Status
+test_restore_func(LV2_Handle                  instance,
+                  LV2_State_Retrieve_Function retrieve,
+                  LV2_State_Handle            handle,
+                  uint32_t                    flags,
+                  const LV2_Feature* const*   features)
+{
+  TestInstance* const test = (TestInstance*)instance;
+
+  (void)retrieve;
+  (void)handle;
+  (void)flags;
+  (void)features;
+
+  // Only instances that are not thread-safe hold the token
+  if (lv2_atomic_load(&test->log->sched->token)) {
+    ++test->log->n_exclusive;
+  }
+
+  // Other thread-safe instances can be restored meanwhile
+  if (test->log->nest) {
+    test->log->nest = false;
+    assert(lv2_state_restore_run_one(test->log->sched, 9U));
+  }
+
+  test->order = ++test->log->order;
+  test->log->time += test->duration;
+  return test->duration > 50U ? LV2_STATE_ERR_UNKNOWN : LV2_STATE_SUCCESS;
+}
+
+static void
+test_restore(void)
+{
+  static const LV2_State_Interface iface = {NULL, test_restore_func};
+
+  LV2_State_Restore_Scheduler sched;
+  RestoreLog                  log = {&sched, 0U, 0U, 0U, 100U, false};
+  LV2_Worker_Pool_Slot*       slots[1];
+  LV2_Worker_Pool             pool;
+  lv2_worker_pool_init(&pool, slots, 1U, count_notify, &log);
+  lv2_worker_pool_set_clock(&pool, step_clock, &log);
+
+  TestInstance instances[5] = {{&log, 0U, 10U},
+                               {&log, 0U, 20U},
+                               {&log, 0U, 30U},
+                               {&log, 0U, 40U},
+                               {&log, 0U, 60U}};
+
+  LV2_State_Restore_Job jobs[5];
+  memset(jobs, 0, sizeof(jobs));
+  for (uint32_t i = 0U; i < 5U; ++i) {
+    jobs[i].instance    = &instances[i];
+    jobs[i].iface       = &iface;
+    jobs[i].thread_safe = (i % 2U) == 0U;
+  }
+
+  lv2_state_restore_init(&sched, jobs, 5U, &pool);
+  assert(!lv2_state_restore_run_one(&sched, 1U));
+
+  // Pool threads are notified once per thread-safe job
+  lv2_state_restore_start(&sched);
+  assert(log.n_notified == 3U);
+
+  // Serial jobs are restored in order, one at a time
+  assert(lv2_state_restore_run_serial(&sched, 0U) == 2U);
+  assert(instances[1].order == 1U && instances[3].order == 2U);
+  assert(log.n_exclusive == 2U);
+  assert(!sched.token);
+  assert(!lv2_state_restore_is_done(&sched));
+
+  // Background jobs are claimed by any thread, even during another restore
+  assert(lv2_state_restore_run_one(&sched, 1U));
+  log.nest = true;
+  assert(lv2_state_restore_run_one(&sched, 2U));
+  assert(!lv2_state_restore_run_one(&sched, 1U));
+  assert(lv2_state_restore_is_done(&sched));
+  assert(log.n_exclusive == 2U);
+  assert(instances[0].order == 3U);
+  assert(instances[4].order == 4U && instances[2].order == 5U);
+  assert(jobs[0].thread == 1U && jobs[2].thread == 2U && jobs[4].thread == 9U);
+  assert(jobs[0].queued == 100U);
+  assert(jobs[0].started == 160U && jobs[0].finished == 170U);
+  assert(jobs[2].started == 170U && jobs[2].finished == 260U);
+  assert(jobs[4].status == LV2_STATE_ERR_UNKNOWN);
+
+  // The summary shows where the time went
+  LV2_State_Restore_Summary summary;
+  lv2_state_restore_summarize(&sched, &summary);
+  assert(summary.n_background == 3U);
+  assert(summary.n_serial == 2U);
+  assert(summary.n_failed == 1U);
+  assert(summary.slowest == 2U);
+  assert(summary.background_time == 160U);
+  assert(summary.serial_time == 60U);
+  assert(summary.max_wait == 70U);
+  assert(summary.elapsed == 160U);
+}
+
+typedef struct {
+  char        path[64];
+  const char* data;
+  uint64_t    mtime;
+} MemoryFile;
+
+typedef struct {
+  MemoryFile files[8];
+  uint32_t   n_files;
+  uint32_t   n_opened;
+  uint32_t   n_copies;
+} MemoryFilesystem;
+
+typedef struct {
+  const MemoryFile* file;
+  size_t            offset;
+} MemoryStream;
+
+static MemoryFile*
+mem_find(MemoryFilesystem* const fs, const char* const path)
+{
+  for (uint32_t i = 0U; i < fs->n_files; ++i) {
+    if (!strcmp(fs->files[i].path, path)) {
+      return &fs->files[i];
+    }
+  }
+
+  return NULL;
+}
+
+static MemoryFile*
+mem_write(MemoryFilesystem* const fs,
+          const char* const       path,
+          const char* const       data)
+{
+  MemoryFile* file = mem_find(fs, path);
+  if (!file) {
+    assert(fs->n_files < 8U && strlen(path) < sizeof(file->path));
+    file = &fs->files[fs->n_files++];
+    memcpy(file->path, path, strlen(path) + 1U);
+  }
+
+  file->data = data;
+  ++file->mtime;
+  return file;
+}
+
+static int
+mem_stat(void* handle, const char* path, uint64_t* size, uint64_t* mtime)
+{
+  const MemoryFile* const file = mem_find((MemoryFilesystem*)handle, path);
+  if (file) {
+    *size  = strlen(file->data);
+    *mtime = file->mtime;
+  }
+
+  return !file;
+}
+
+static void*
+mem_open(void* handle, const char* path)
+{
+  MemoryFilesystem* const fs     = (MemoryFilesystem*)handle;
+  const MemoryFile* const file   = mem_find(fs, path);
+  MemoryStream* const     stream =
+    file ? (MemoryStream*)malloc(sizeof(MemoryStream)) : NULL;
+
+  if (stream) {
+    stream->file   = file;
+    stream->offset = 0U;
+    ++fs->n_opened;
+  }
+
+  return stream;
+}
+
+static size_t
+mem_read(void* handle, void* file, void* buf, size_t size)
+{
+  MemoryStream* const stream = (MemoryStream*)file;
+  const size_t        len    = strlen(stream->file->data) - stream->offset;
+  const size_t        n      = len < size ? len : size;
+
+  (void)handle;
+  memcpy(buf, stream->file->data + stream->offset, n);
+  stream->offset += n;
+  return n;
+}
+
+static void
+mem_close(void* handle, void* file)
+{
+  (void)handle;
+  free(file);
+}
+
+static int
+mem_copy(void* handle, const char* src, const char* dst)
+{
+  MemoryFilesystem* const fs   = (MemoryFilesystem*)handle;
+  const MemoryFile* const file = mem_find(fs, src);
+
+  ++fs->n_copies;
+  return !file || !mem_write(fs, dst, file->data);
+}
+
+static int
+mem_make_dirs(void* handle, const char* path)
+{
+  (void)handle;
+  return strncmp(path, "/scratch/", 9U) != 0;
+}
+
+static void
+test_blobs(void)
+{
+  static const char* const sample = "RIFF sample data";
+
+  MemoryFilesystem           memfs = {{{{0}, NULL, 0U}}, 0U, 0U, 0U};
+  LV2_State_Blobs_Filesystem fs    = {
+    &memfs, mem_stat, mem_open, mem_read, mem_close, mem_copy, mem_make_dirs};
+
+  LV2_State_Blobs_File     files[4];
+  uint32_t                 slots[8];
+  LV2_State_Blobs          blobs;
+  LV2_State_Blobs_Instance a;
+  LV2_State_Blobs_Instance b;
+  assert(lv2_state_blobs_n_slots(4U) == 8U);
+  lv2_state_blobs_init(&blobs, "/blobs", "/scratch/", &fs, files, 4U, slots);
+  lv2_state_blobs_instance_init(&a, &blobs, "a");
+  lv2_state_blobs_instance_init(&b, &blobs, "b");
+
+  // Both instances save the same sample in their own scratch directory
+  char* const a_path = a.make_path.path(a.make_path.handle, "kit/kick.wav");
+  char* const b_path = b.make_path.path(b.make_path.handle, "drum.WAV");
+  assert(!strcmp(a_path, "/scratch/a/kit/kick.wav"));
+  assert(!strcmp(b_path, "/scratch/b/drum.WAV"));
+  mem_write(&memfs, a_path, sample);
+  mem_write(&memfs, b_path, sample);
+
+  char* const a_abstract = a.map_path.abstract_path(a.map_path.handle, a_path);
+  assert(strlen(a_abstract) == 16U + 3U);
+  assert(!strcmp(a_abstract + 16U, "-16"));
+  assert(blobs.n_stored == 1U && memfs.n_copies == 1U);
+
+  // The second is shared after comparing contents
+  char* const b_abstract = b.map_path.abstract_path(b.map_path.handle, b_path);
+  assert(!strcmp(a_abstract, b_abstract));
+  assert(blobs.n_stored == 1U && blobs.n_shared == 1U);
+  assert(memfs.n_copies == 1U);
+
+  // Saving again gives the same abstract path without hashing
+  const uint32_t n_opened = memfs.n_opened;
+  char* const    again = a.map_path.abstract_path(a.map_path.handle, a_path);
+  assert(!strcmp(again, a_abstract));
+  assert(memfs.n_opened == n_opened);
+  assert(blobs.n_hashed == 2U);
+
+  // Abstract paths map to the blob, which has the original contents
+  char* const blob = b.map_path.absolute_path(b.map_path.handle, a_abstract);
+  assert(!strncmp(blob, "/blobs/", 7U) && !strcmp(blob + 7U, a_abstract));
+  assert(mem_find(&memfs, blob) && mem_find(&memfs, blob)->data == sample);
+
+  char* const name = a.map_path.abstract_path(a.map_path.handle, blob);
+  assert(!strcmp(name, a_abstract));
+
+  // A changed file is hashed again and stored as a new blob
+  mem_write(&memfs, a_path, "RIFF other");
+  char* const changed = a.map_path.abstract_path(a.map_path.handle, a_path);
+  assert(strcmp(changed, a_abstract));
+  assert(blobs.n_hashed == 3U && blobs.n_stored == 2U);
+  assert(blobs.n_files == 2U);
+  assert(lv2_state_blobs_find(&blobs, a_path) == &files[0]);
+  assert(lv2_state_blobs_find(&blobs, b_path) == &files[1]);
+
+  // Rewriting the file did not change the earlier blob
+  assert(mem_find(&memfs, blob)->data == sample);
+
+  // Paths outside the scratch directory are mapped to themselves
+  char* const user = a.map_path.abstract_path(a.map_path.handle, "/lib/x.wav");
+  char* const back = a.map_path.absolute_path(a.map_path.handle, user);
+  assert(!strcmp(user, "/lib/x.wav") && !strcmp(back, "/lib/x.wav"));
+
+  // Only blob names are mapped to and from blobs
+  char* const rel   = a.map_path.absolute_path(a.map_path.handle, "x.wav");
+  char* const inner = a.map_path.abstract_path(a.map_path.handle, "/blobs/x");
+  assert(!strcmp(rel, "x.wav") && !strcmp(inner, "/blobs/x"));
+  assert(!lv2_state_blobs_is_name("0123456789abcdef-"));
+  assert(!lv2_state_blobs_is_name("0123456789ABCDEF-16"));
+  assert(!lv2_state_blobs_is_name("0123456789abcdef-16.wav"));
+  assert(lv2_state_blobs_is_name("0123456789abcdef-16"));
+
+  char* const paths[] = {a_path,
+                         b_path,
+                         a_abstract,
+                         b_abstract,
+                         again,
+                         blob,
+                         name,
+                         changed,
+                         user,
+                         back,
+                         rel,
+                         inner};
+  for (size_t i = 0U; i < sizeof(paths) / sizeof(char*); ++i) {
+    a.free_path.free_path(a.free_path.handle, paths[i]);
+  }
+
+  lv2_state_blobs_cleanup(&blobs);
+}
+
+typedef struct {
+  char*  buf;
+  size_t size;
+  size_t len;
+} LargeText;
+
+static size_t
+large_text_sink(const void* buf, size_t len, void* stream)
+{
+  LargeText* const text = (LargeText*)stream;
+  if (text->len + len > text->size) {
+    return 0U;
+  }
+
+  memcpy(text->buf + text->len, buf, len);
+  text->len += len;
+  return len;
+}
+
+static void
+test_compress(void)
+{
+  static uint8_t  table[4096];
+  static uint8_t  wave[100000];
+  static uint8_t  noise[256];
+  static uint64_t bufs[2][16384];
+  static uint64_t scratch[16384];
+  static uint8_t  window[LV2_STATE_STORE_WINDOW_SIZE];
+  static uint32_t hashes[LV2_STATE_STORE_HASH_SIZE];
+  static char     texts[2][160000];
+
+  // Generate a periodic table, a long repetitive wave, and random noise
+  uint32_t rng = 1U;
+  for (size_t i = 0U; i < sizeof(table); ++i) {
+    table[i] = (uint8_t)((i * i) % 97U);
+  }
+
+  for (size_t i = 0U; i < sizeof(wave); ++i) {
+    rng     = (i % 1000U) ? (rng * 1103515245U) + 12345U : 1U;
+    wave[i] = (uint8_t)(rng >> 24U);
+  }
+
+  for (size_t i = 0U; i < sizeof(noise); ++i) {
+    rng      = (rng * 1103515245U) + 12345U;
+    noise[i] = (uint8_t)(rng >> 24U);
+  }
+
+  URITable       uris  = {{NULL}, 0U};
+  LV2_URID_Map   map   = {&uris, map_uri};
+  LV2_URID_Unmap unmap = {&uris, unmap_uri};
+
+  const LV2_URID eg_table = map_uri(&uris, EG_PREFIX "table");
+  const LV2_URID eg_wave  = map_uri(&uris, EG_PREFIX "wave");
+  const LV2_URID eg_noise = map_uri(&uris, EG_PREFIX "noise");
+  const LV2_URID a_Chunk  = map.map(map.handle, LV2_ATOM__Chunk);
+  const uint32_t pod      = LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE;
+
+  // Save the same values with and without compression
+  LV2_State_Store_Entry  entries[2][4];
+  LV2_URID               writer_uris[2][8];
+  uint32_t               slots[2][8U + 16U];
+  LV2_State_Store_Writer writers[2];
+  uint64_t               sizes[2] = {0U, 0U};
+  for (unsigned i = 0U; i < 2U; ++i) {
+    LV2_State_Store_Writer* const w = &writers[i];
+    lv2_state_store_writer_init(w,
+                                bufs[i],
+                                sizeof(bufs[i]),
+                                entries[i],
+                                4U,
+                                writer_uris[i],
+                                8U,
+                                slots[i],
+                                &unmap);
+    lv2_state_store_writer_set_compression(w, i ? 0U : 128U, hashes);
+    assert(!lv2_state_store_store(
+      w, eg_table, table, sizeof(table), a_Chunk, pod));
+    assert(
+      !lv2_state_store_store(w, eg_wave, wave, sizeof(wave), a_Chunk, pod));
+    assert(!lv2_state_store_store(
+      w, eg_noise, noise, sizeof(noise), a_Chunk, pod));
+    assert((sizes[i] = lv2_state_store_writer_finish(w)));
+  }
+
+  // Only compressible values are compressed
+  assert(entries[0][0].flags == (pod | LV2_STATE_STORE_COMPRESSED));
+  assert(entries[0][1].flags == (pod | LV2_STATE_STORE_COMPRESSED));
+  assert(entries[0][2].flags == pod);
+  assert(entries[0][0].size < sizeof(table) / 4U);
+  assert(entries[0][1].size < sizeof(wave) / 50U);
+  assert(sizes[0] < sizes[1] / 10U);
+
+  // Compressed values can not be retrieved without scratch space
+  LV2_URID                            urids[8];
+  LV2_State_Store_Index               index[4];
+  LV2_State_Store_Reader              reader;
+  const LV2_State_Store_Header* const header =
+    lv2_state_store_check(bufs[0], sizes[0]);
+  assert(header && header->version == LV2_STATE_STORE_VERSION);
+  assert(!lv2_state_store_reader_init(&reader, header, &map, urids, index));
+  assert(!lv2_state_store_retrieve(&reader, eg_table, NULL, NULL, NULL));
+  assert(lv2_state_store_retrieve(&reader, eg_noise, NULL, NULL, NULL));
+
+  // With enough, they are decompressed when retrieved
+  const uint64_t scratch_size = lv2_state_store_scratch_size(header);
+  assert(scratch_size == sizeof(table) + sizeof(wave));
+  assert(scratch_size <= sizeof(scratch));
+  lv2_state_store_reader_set_scratch(&reader, scratch, scratch_size);
+
+  size_t   size  = 0U;
+  uint32_t flags = 0U;
+  const void* const table_value =
+    lv2_state_store_retrieve(&reader, eg_table, &size, NULL, &flags);
+  assert(table_value == (const void*)scratch);
+  assert(size == sizeof(table) && flags == pod);
+  assert(!memcmp(table_value, table, sizeof(table)));
+
+  const void* const wave_value =
+    lv2_state_store_retrieve(&reader, eg_wave, &size, NULL, NULL);
+  assert(wave_value && size == sizeof(wave));
+  assert(!memcmp(wave_value, wave, sizeof(wave)));
+  assert(reader.scratch_used == scratch_size);
+
+  // Retrieving again returns the same data without using more space
+  assert(lv2_state_store_retrieve(&reader, eg_wave, NULL, NULL, NULL) ==
+         wave_value);
+  assert(lv2_state_store_retrieve(&reader, eg_table, NULL, NULL, NULL) ==
+         table_value);
+  assert(reader.scratch_used == scratch_size);
+
+  // Setting the scratch space again forgets the decompressed values
+  lv2_state_store_reader_set_scratch(&reader, scratch, sizeof(table));
+  assert(lv2_state_store_retrieve(&reader, eg_table, NULL, NULL, NULL));
+  assert(!lv2_state_store_retrieve(&reader, eg_wave, NULL, NULL, NULL));
+
+  // Exported Turtle is the same as without compression
+  LargeText text[2] = {{texts[0], sizeof(texts[0]), 0U},
+                       {texts[1], sizeof(texts[1]), 0U}};
+  for (unsigned i = 0U; i < 2U; ++i) {
+    const LV2_State_Store_Header* const h =
+      lv2_state_store_check(bufs[i], sizes[i]);
+
+    assert(lv2_state_store_write_turtle(h, large_text_sink, &text[i], window));
+  }
+
+  assert(text[0].len == text[1].len);
+  assert(!memcmp(texts[0], texts[1], text[0].len));
+
+  // Corrupt compressed data is rejected
+  uint8_t        packed[64];
+  uint8_t        unpacked[64];
+  const char     message[] = "abcabcabcabcabcabcabcabcabcabcabcabcabc";
+  const uint64_t n         = lv2_state_store_compress(
+    (const uint8_t*)message, sizeof(message), packed, sizeof(packed), hashes);
+  assert(n && n < sizeof(message));
+  assert(lv2_state_store_decompress(
+    packed, n, unpacked, sizeof(unpacked), sizeof(message), NULL, NULL));
+  assert(!memcmp(unpacked, message, sizeof(message)));
+  assert(!lv2_state_store_decompress(
+    packed, n - 1U, unpacked, sizeof(unpacked), sizeof(message), NULL, NULL));
+  assert(!lv2_state_store_decompress(
+    packed, n, unpacked, 8U, sizeof(message), NULL, NULL));
+
+  packed[4] = 0xFFU; // Offset before the start
+  assert(!lv2_state_store_decompress(
+    packed, n, unpacked, sizeof(unpacked), sizeof(message), NULL, NULL));
+}
+
+typedef struct {
+  float    gain;
+  uint32_t n_notes;
+} CellState;
+
+static void
+test_cell(void)
+{
+  const CellState initial = {1.0f, 0U};
+  CellState       copies[3];
+  LV2_State_Cell  cell;
+  uint32_t        version = 0U;
+
+  lv2_state_cell_init(&cell, copies, sizeof(CellState), &initial);
+
+  // The reader sees the initial state until something is published
+  const CellState* saved =
+    (const CellState*)lv2_state_cell_read(&cell, &version);
+  assert(saved->gain == 1.0f && !saved->n_notes && !version);
+
+  // The writer edits a private copy, which starts from the last state
+  CellState* state = (CellState*)lv2_state_cell_edit(&cell);
+  state->gain      = 0.5f;
+  state->n_notes   = 1U;
+  assert(((const CellState*)lv2_state_cell_read(&cell, NULL))->gain == 1.0f);
+
+  lv2_state_cell_publish(&cell);
+  state = (CellState*)lv2_state_cell_edit(&cell);
+  assert(state->gain == 0.5f && state->n_notes == 1U);
+
+  // A snapshot stays unchanged while the writer continues
+  saved = (const CellState*)lv2_state_cell_read(&cell, &version);
+  assert(saved->gain == 0.5f && saved->n_notes == 1U && version == 1U);
+  for (uint32_t i = 0U; i < 3U; ++i) {
+    state = (CellState*)lv2_state_cell_edit(&cell);
+    ++state->n_notes;
+    lv2_state_cell_publish(&cell);
+    assert(state != saved && saved->n_notes == 1U);
+  }
+
+  // The next read sees only the latest state
+  saved = (const CellState*)lv2_state_cell_read(&cell, &version);
+  assert(saved->n_notes == 4U && version == 4U);
+  assert(lv2_state_cell_read(&cell, NULL) == saved);
+}
+
+typedef struct {
+  LV2_State_Swap_Message queue[4];
+  uint32_t               n_queued;
+  uint32_t               capacity;
+  uint32_t               n_freed;
+} SwapWorker;
+
+static LV2_Worker_Status
+swap_schedule(LV2_Worker_Schedule_Handle handle,
+              uint32_t                   size,
+              const void*                data)
+{
+  SwapWorker* const worker = (SwapWorker*)handle;
+  if (worker->n_queued == worker->capacity) {
+    return LV2_WORKER_ERR_NO_SPACE;
+  }
+
+  assert(size == sizeof(LV2_State_Swap_Message));
+  memcpy(&worker->queue[worker->n_queued++], data, size);
+  return LV2_WORKER_SUCCESS;
+}
+
+static void
+swap_free(void* handle, void* object)
+{
+  ++((SwapWorker*)handle)->n_freed;
+  free(object);
+}
+
+static float*
+new_preset(const float gain)
+{
+  float* const preset = (float*)malloc(sizeof(float));
+  *preset             = gain;
+  return preset;
+}
+
+static void
+test_swap(void)
+{
+  SwapWorker          worker   = {{{{0U, 0U}, NULL}}, 0U, 4U, 0U};
+  LV2_Worker_Schedule schedule = {&worker, swap_schedule};
+  LV2_State_Swap      swap;
+  const uint32_t      type = 42U;
+
+  lv2_state_swap_init(
+    &swap, new_preset(1.0f), type, &schedule, swap_free, &worker);
+
+  // Nothing happens until a new object is submitted
+  assert(!lv2_state_swap_update(&swap));
+  assert(*(float*)lv2_state_swap_current(&swap) == 1.0f);
+
+  // Only the latest of several submitted objects is swapped in
+  lv2_state_swap_submit(&swap, new_preset(0.5f));
+  lv2_state_swap_submit(&swap, new_preset(0.25f));
+  assert(worker.n_freed == 1U);
+  assert(*(float*)lv2_state_swap_current(&swap) == 1.0f);
+  assert(lv2_state_swap_update(&swap));
+  assert(*(float*)lv2_state_swap_current(&swap) == 0.25f);
+  assert(!lv2_state_swap_update(&swap));
+
+  // The old object is freed by the worker
+  assert(worker.n_queued == 1U && worker.n_freed == 1U);
+  assert(!lv2_state_swap_work(&swap, 4U, &type));
+  assert(lv2_state_swap_work(&swap, sizeof(worker.queue[0]), &worker.queue[0]));
+  assert(worker.n_freed == 2U);
+  worker.n_queued = 0U;
+
+  // If the worker is full, the old object is sent later
+  worker.capacity = 0U;
+  lv2_state_swap_submit(&swap, new_preset(0.125f));
+  assert(lv2_state_swap_update(&swap));
+  assert(*(float*)lv2_state_swap_current(&swap) == 0.125f);
+  lv2_state_swap_submit(&swap, new_preset(2.0f));
+  assert(!lv2_state_swap_update(&swap));
+  assert(*(float*)lv2_state_swap_current(&swap) == 0.125f);
+
+  worker.capacity = 4U;
+  assert(lv2_state_swap_update(&swap));
+  assert(*(float*)lv2_state_swap_current(&swap) == 2.0f);
+  assert(worker.n_queued == 2U);
+  for (uint32_t i = 0U; i < worker.n_queued; ++i) {
+    assert(lv2_state_swap_work(
+      &swap, sizeof(worker.queue[i]), &worker.queue[i]));
+  }
+
+  assert(worker.n_freed == 4U);
+  lv2_state_swap_cleanup(&swap);
+  assert(worker.n_freed == 5U);
+}
+
+static void
+test_paths(void)
+{
+  LV2_State_Paths_Entry entries[4];
+  uint32_t              slots[16];
+  char                  strings[64];
+  LV2_State_Paths       paths;
+
+  lv2_state_paths_init(
+    &paths, "/state/", entries, 4U, slots, 8U, strings, sizeof(strings));
+
+  const LV2_State_Borrowed_Map_Path* const borrowed = &paths.borrowed_map_path;
+  const LV2_State_Map_Path* const          map_path = &paths.map_path;
+
+  // Paths in the directory are mapped to relative paths, others to themselves
+  void* const       handle = borrowed->handle;
+  const char* const a      = borrowed->abstract_path(handle, "/state/a.wav");
+  const char* const b      = borrowed->abstract_path(handle, "/lib/b.wav");
+  assert(!strcmp(a, "a.wav"));
+  assert(!strcmp(b, "/lib/b.wav"));
+  assert(!strcmp(borrowed->abstract_path(handle, "/state"), "/state"));
+  assert(!strcmp(borrowed->abstract_path(handle, "/stated/c"), "/stated/c"));
+  assert(paths.n_entries == 4U && paths.n_misses == 4U);
+
+  // Mapping again in either direction returns the same interned strings
+  const char* const a_path = borrowed->absolute_path(handle, "a.wav");
+  assert(!strcmp(a_path, "/state/a.wav") && a_path + 7 == a);
+  assert(borrowed->abstract_path(handle, "/state/a.wav") == a);
+  assert(borrowed->absolute_path(handle, "/lib/b.wav") == b);
+  assert(paths.n_entries == 4U && paths.n_hits == 3U);
+
+  // When the table is full, borrowing fails but copies are still mapped
+  assert(!borrowed->absolute_path(handle, "d.wav"));
+  char* const d = map_path->absolute_path(map_path->handle, "d.wav");
+  char* const e = map_path->abstract_path(map_path->handle, "/state/e/f.wav");
+  char* const f = map_path->abstract_path(map_path->handle, "/state/a.wav");
+  assert(!strcmp(d, "/state/d.wav"));
+  assert(!strcmp(e, "e/f.wav"));
+  assert(!strcmp(f, "a.wav"));
+  paths.free_path.free_path(paths.free_path.handle, f);
+  paths.free_path.free_path(paths.free_path.handle, e);
+  paths.free_path.free_path(paths.free_path.handle, d);
+
+  // Resetting forgets every path
+  lv2_state_paths_reset(&paths, "/other");
+  assert(!paths.n_entries && !paths.n_hits && !paths.n_misses);
+  assert(!strcmp(borrowed->absolute_path(handle, "x"), "/other/x"));
+  assert(!strcmp(borrowed->abstract_path(handle, "/other/x"), "x"));
+  assert(paths.n_entries == 1U && paths.n_hits == 1U);
+}
+
+typedef struct {
+  const uint8_t* data;
+  uint64_t       size;
+} LazyFile;
+
+static size_t
+lazy_read(void* handle, uint64_t offset, void* buf, size_t size)
+{
+  const LazyFile* const file = (const LazyFile*)handle;
+  if (offset >= file->size) {
+    return 0U;
+  }
+
+  const size_t n = (size_t)(file->size - offset) < size
+                     ? (size_t)(file->size - offset)
+                     : size;
+
+  memcpy(buf, file->data + offset, n);
+  return n;
+}
+
+static void
+test_lazy(void)
+{
+  static uint64_t buf[4096];
+  static uint64_t meta[128];
+  static uint64_t cache[1024];
+  static uint8_t  legacy[3][2048];
+  static uint8_t  table[4096];
+
+  static const char* const legacy_keys[] = {
+    EG_PREFIX "legacy0", EG_PREFIX "legacy1", EG_PREFIX "legacy2"};
+
+  uint32_t rng = 1U;
+  for (size_t i = 0U; i < sizeof(legacy); ++i) {
+    rng                          = (rng * 1103515245U) + 12345U;
+    legacy[i / 2048U][i % 2048U] = (uint8_t)(rng >> 24U);
+  }
+
+  for (size_t i = 0U; i < sizeof(table); ++i) {
+    table[i] = (uint8_t)(i % 64U);
+  }
+
+  URITable       uris  = {{NULL}, 0U};
+  LV2_URID_Map   map   = {&uris, map_uri};
+  LV2_URID_Unmap unmap = {&uris, unmap_uri};
+
+  const LV2_URID eg_gain   = map_uri(&uris, EG_PREFIX "gain");
+  const LV2_URID eg_table  = map_uri(&uris, EG_PREFIX "table");
+  const LV2_URID eg_legacy = map_uri(&uris, EG_PREFIX "legacy");
+  const LV2_URID a_Float   = map.map(map.handle, LV2_ATOM__Float);
+  const LV2_URID a_Chunk   = map.map(map.handle, LV2_ATOM__Chunk);
+  const uint32_t pod       = LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE;
+  const float    gain      = 0.5f;
+
+  // Save a gain, a compressed table, and large values the plugin ignores
+  LV2_State_Store_Entry  entries[8];
+  LV2_URID               writer_uris[16];
+  uint32_t               slots[16U + 32U];
+  uint32_t               hashes[LV2_STATE_STORE_HASH_SIZE];
+  LV2_State_Store_Writer writer;
+  lv2_state_store_writer_init(
+    &writer, buf, sizeof(buf), entries, 8U, writer_uris, 16U, slots, &unmap);
+  lv2_state_store_writer_set_compression(&writer, 1024U, hashes);
+  for (uint32_t i = 0U; i < 3U; ++i) {
+    const LV2_URID key = map_uri(&uris, legacy_keys[i]);
+    assert(!lv2_state_store_store(
+      &writer, key, legacy[i], sizeof(legacy[i]), a_Chunk, pod));
+  }
+
+  assert(!lv2_state_store_store(&writer, eg_gain, &gain, 4U, a_Float, pod));
+  assert(!lv2_state_store_store(
+    &writer, eg_table, table, sizeof(table), a_Chunk, pod));
+
+  const LazyFile file = {(const uint8_t*)buf,
+                         lv2_state_store_writer_finish(&writer)};
+  assert(file.size);
+
+  // Opening only reads the header and tables
+  LV2_URID              urids[16];
+  LV2_State_Store_Index index[8];
+  LV2_State_Lazy_Reader reader;
+  assert(lv2_state_lazy_open(&reader, lazy_read, (void*)&file));
+  assert(reader.header.n_entries == 5U);
+  assert(reader.meta_size <= sizeof(meta));
+  assert(!lv2_state_lazy_load(&reader, meta, &map, urids, index));
+  assert(reader.n_bytes == reader.meta_size && !reader.n_reads);
+
+  // Only retrieved values are read, and compressed ones are decompressed
+  size_t   size = 0U;
+  uint32_t type = 0U;
+  lv2_state_lazy_set_cache(&reader, cache, sizeof(cache));
+
+  const float* const gain_ptr =
+    (const float*)lv2_state_lazy_retrieve(&reader, eg_gain, &size, &type, NULL);
+  assert(gain_ptr && *gain_ptr == gain && size == 4U && type == a_Float);
+
+  const uint8_t* const table_ptr = (const uint8_t*)lv2_state_lazy_retrieve(
+    &reader, eg_table, &size, &type, NULL);
+  assert(table_ptr && size == sizeof(table) && type == a_Chunk);
+  assert(!memcmp(table_ptr, table, sizeof(table)));
+  assert(*gain_ptr == gain);
+  assert(!lv2_state_lazy_retrieve(&reader, eg_legacy, NULL, NULL, NULL));
+  assert(reader.n_reads == 2U);
+  assert(reader.n_bytes < reader.meta_size + 1024U);
+  assert(reader.n_bytes < file.size / 4U);
+
+  // Values can not be retrieved without enough cache
+  lv2_state_lazy_set_cache(&reader, cache, sizeof(table));
+  assert(!lv2_state_lazy_retrieve(&reader, eg_table, NULL, NULL, NULL));
+  assert(lv2_state_lazy_retrieve(&reader, eg_gain, NULL, NULL, NULL));
+
+  // Truncated or corrupt files are rejected
+  const LazyFile header_only = {file.data, sizeof(LV2_State_Store_Header)};
+  const LazyFile short_file  = {file.data, sizeof(LV2_State_Store_Header) - 1U};
+  assert(!lv2_state_lazy_open(&reader, lazy_read, (void*)&short_file));
+  assert(lv2_state_lazy_open(&reader, lazy_read, (void*)&header_only));
+  assert(lv2_state_lazy_load(&reader, meta, &map, urids, index));
+
+  ((uint8_t*)buf)[file.size - 1U] ^= 0x80U;
+  assert(lv2_state_lazy_open(&reader, lazy_read, (void*)&file));
+  assert(lv2_state_lazy_load(&reader, meta, &map, urids, index));
+}
+
+int
+main(void)
+{
+  test_store();
+  test_sort();
+  test_delta();
+  test_restore();
+  test_blobs();
+  test_compress();
+  test_cell();
+  test_swap();
+  test_paths();
+  test_lazy();
+  return 0;
+}
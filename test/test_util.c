@@ -0,0 +1,218 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/core/extensions.h>
+#include <lv2/core/lv2.h>
+#include <lv2/core/lv2_util.h>
+#include <lv2/options/options.h>
+#include <lv2/state/state.h>
+#include <lv2/worker/worker.h>
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define N_MANY 100U
+
+static int a_data = 1;
+static int b_data = 2;
+static int c_data = 3;
+
+static uint32_t n_extension_data_calls = 0U;
+
+static const LV2_Extension_Data extensions[] = {
+  {LV2_STATE__interface, &a_data},
+  {LV2_WORKER__interface, &b_data},
+  {"http://example.org/custom#interface", &c_data},
+};
+
+LV2_EXTENSION_DATA_FUNCTION(plugin_extension_data, extensions)
+
+static const void*
+counting_extension_data(const char* const uri)
+{
+  ++n_extension_data_calls;
+  return plugin_extension_data(uri);
+}
+
+static void
+test_index(void)
+{
+  const LV2_Feature a     = {"http://example.org/a", &a_data};
+  const LV2_Feature b     = {"http://example.org/b", &b_data};
+  const LV2_Feature dup   = {"http://example.org/a", &c_data};
+  const LV2_Feature empty = {"http://example.org/empty", NULL};
+
+  const LV2_Feature* const features[] = {&a, &b, &dup, &empty, NULL};
+
+  LV2_Features_Index index;
+  lv2_features_index_init(&index, features);
+  assert(index.complete);
+
+  // The first of duplicate features is found, like lv2_features_data()
+  assert(lv2_features_index_data(&index, "http://example.org/a") == &a_data);
+  assert(lv2_features_index_data(&index, "http://example.org/b") == &b_data);
+  assert(!lv2_features_index_data(&index, "http://example.org/empty"));
+  assert(!lv2_features_index_data(&index, "http://example.org/c"));
+
+  lv2_features_index_init(&index, NULL);
+  assert(index.complete);
+  assert(!lv2_features_index_data(&index, "http://example.org/a"));
+}
+
+static void
+test_overflow(void)
+{
+  static char        uris[N_MANY][32];
+  static LV2_Feature many[N_MANY];
+
+  const LV2_Feature* features[N_MANY + 1U];
+  for (uint32_t i = 0U; i < N_MANY; ++i) {
+    snprintf(uris[i], sizeof(uris[i]), "http://example.org/f%u", i);
+    many[i].URI  = uris[i];
+    many[i].data = &uris[i];
+    features[i]  = &many[i];
+  }
+
+  features[N_MANY] = NULL;
+
+  // Too many features to index, so lookups fall back to scanning
+  LV2_Features_Index index;
+  lv2_features_index_init(&index, features);
+  assert(!index.complete);
+  for (uint32_t i = 0U; i < N_MANY; ++i) {
+    assert(lv2_features_index_data(&index, uris[i]) == &uris[i]);
+  }
+
+  assert(!lv2_features_index_data(&index, "http://example.org/missing"));
+}
+
+static void
+test_resolve(void)
+{
+  const LV2_Feature        a          = {"http://example.org/a", &a_data};
+  const LV2_Feature        b          = {"http://example.org/b", &b_data};
+  const LV2_Feature* const features[] = {&a, &b, NULL};
+
+  void* a_ptr = NULL;
+  void* b_ptr = NULL;
+  void* x_ptr = &a_data;
+  void* y_ptr = NULL;
+  void* z_ptr = NULL;
+
+  const LV2_Feature_Query queries[] = {
+    {"http://example.org/a", &a_ptr, true},
+    {"http://example.org/x", &x_ptr, true},
+    {"http://example.org/b", &b_ptr, false},
+    {"http://example.org/y", &y_ptr, false},
+    {"http://example.org/z", &z_ptr, true},
+    {NULL, NULL, false},
+  };
+
+  // Every missing required feature is reported, and optional ones are not
+  const char* missing[2] = {NULL, NULL};
+  assert(lv2_features_resolve(features, queries, missing, 2U) == 2U);
+  assert(a_ptr == &a_data);
+  assert(b_ptr == &b_data);
+  assert(!x_ptr);
+  assert(!y_ptr);
+  assert(!z_ptr);
+  assert(!strcmp(missing[0], "http://example.org/x"));
+  assert(!strcmp(missing[1], "http://example.org/z"));
+
+  // The count includes missing features that do not fit
+  missing[0] = NULL;
+  assert(lv2_features_resolve(features, queries, missing, 1U) == 2U);
+  assert(!strcmp(missing[0], "http://example.org/x"));
+  assert(lv2_features_resolve(features, queries, NULL, 0U) == 2U);
+  assert(lv2_features_resolve(NULL, queries, NULL, 0U) == 3U);
+  assert(!a_ptr);
+
+  // Existing query interface still returns the first missing feature
+  assert(!lv2_features_query(features,
+                             "http://example.org/b",
+                             &b_ptr,
+                             true,
+                             "http://example.org/y",
+                             &y_ptr,
+                             false,
+                             NULL));
+  assert(b_ptr == &b_data);
+  assert(!strcmp(lv2_features_query(features,
+                                    "http://example.org/x",
+                                    &x_ptr,
+                                    true,
+                                    "http://example.org/z",
+                                    &z_ptr,
+                                    true,
+                                    NULL),
+                 "http://example.org/x"));
+}
+
+static void
+test_extensions(void)
+{
+  enum { STATE, WORKER, OPTIONS, N_INTERFACES };
+
+  static const char* const uris[N_INTERFACES] = {
+    LV2_STATE__interface,
+    LV2_WORKER__interface,
+    LV2_OPTIONS__interface,
+  };
+
+  // The plugin side returns interfaces by URI
+  assert(plugin_extension_data(LV2_STATE__interface) == &a_data);
+  assert(plugin_extension_data("http://example.org/custom#interface") ==
+         &c_data);
+  assert(!plugin_extension_data("http://example.org/missing#interface"));
+
+  const LV2_Descriptor descriptor = {"http://example.org/plugin",
+                                     NULL,
+                                     NULL,
+                                     NULL,
+                                     NULL,
+                                     NULL,
+                                     NULL,
+                                     counting_extension_data};
+
+  // Initialising queries every interface in the table once
+  const void*         data[N_INTERFACES];
+  LV2_Extension_Table table;
+  lv2_extension_table_init(&table, &descriptor, uris, N_INTERFACES, data);
+  assert(n_extension_data_calls == N_INTERFACES);
+
+  // Interfaces in the table are then found without calling the plugin
+  assert(lv2_extension_table_get(&table, STATE) == &a_data);
+  assert(lv2_extension_table_get(&table, WORKER) == &b_data);
+  assert(!lv2_extension_table_get(&table, OPTIONS));
+  assert(!lv2_extension_table_get(&table, N_INTERFACES));
+  assert(lv2_extension_table_find(&table, LV2_WORKER__interface) == &b_data);
+  assert(n_extension_data_calls == N_INTERFACES);
+
+  // Other interfaces are queried from the plugin
+  assert(lv2_extension_table_find(
+           &table, "http://example.org/custom#interface") == &c_data);
+  assert(n_extension_data_calls == N_INTERFACES + 1U);
+
+  // A descriptor without extension_data() has no interfaces
+  const LV2_Descriptor bare = {
+    "http://example.org/bare", NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+
+  lv2_extension_table_init(&table, &bare, uris, N_INTERFACES, data);
+  assert(!lv2_extension_table_get(&table, STATE));
+  assert(!lv2_extension_table_find(&table, LV2_STATE__interface));
+  assert(!lv2_extension_table_find(&table, "http://example.org/x"));
+}
+
+int
+main(void)
+{
+  test_index();
+  test_overflow();
+  test_resolve();
+  test_extensions();
+  return 0;
+}
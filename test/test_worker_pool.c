@@ -0,0 +1,714 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/core/atomic.h>
+#include <lv2/core/lv2.h>
+#include <lv2/worker/pool.h>
+#include <lv2/worker/stats.h>
+#include <lv2/worker/worker.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+#define RING_SIZE 128U
+#define N_SLOTS 4U
+#define N_THREADS 3U
+#define N_STRESS_RUNS 2000U
+
+typedef struct {
+  LV2_Worker_Pool*      pool;
+  LV2_Worker_Pool_Slot* slot;
+  uint32_t              n_work;
+  uint32_t              n_responses;
+  uint32_t              n_end_runs;
+  uint32_t              last_response;
+  uint32_t              responses[8];
+  bool                  superseded;
+  bool                  nested;
+} TestPlugin;
+
+static LV2_Worker_Status
+work(LV2_Handle                  instance,
+     LV2_Worker_Respond_Function respond,
+     LV2_Worker_Respond_Handle   handle,
+     const uint32_t              size,
+     const void*                 data)
+{
+  TestPlugin* const plugin = (TestPlugin*)instance;
+  uint32_t          value  = 0U;
+
+  assert(size == sizeof(value));
+  memcpy(&value, data, sizeof(value));
+  ++plugin->n_work;
+
+  if (value == 99U) {
+    // Supersede this request as if run() had scheduled a new one meanwhile
+    LV2_Worker_Keyed_Schedule* const keyed = &plugin->slot->keyed_schedule;
+    assert(!keyed->superseded(keyed->handle, handle));
+    const uint32_t                   next  = 98U;
+    assert(!keyed->schedule_keyed_work(
+      keyed->handle, 7U, sizeof(next), &next));
+    plugin->superseded = keyed->superseded(keyed->handle, handle);
+  } else if (value == 50U && plugin->pool) {
+    // Respond, then run the next request as if another thread had started it
+    uint8_t        buf[RING_SIZE];
+    const uint32_t first = 99U;
+    assert(!respond(handle, sizeof(first), &first));
+    plugin->nested = lv2_worker_pool_run_one(plugin->pool, buf, sizeof(buf));
+
+    // Responses to the next request wait until this one is finished
+    lv2_worker_pool_deliver(plugin->slot);
+  }
+
+  value *= 2U;
+  return respond(handle, sizeof(value), &value);
+}
+
+static LV2_Worker_Status
+work_response(LV2_Handle instance, const uint32_t size, const void* body)
+{
+  TestPlugin* const plugin = (TestPlugin*)instance;
+
+  assert(size == sizeof(plugin->last_response));
+  memcpy(&plugin->last_response, body, sizeof(plugin->last_response));
+  if (plugin->n_responses < 8U) {
+    plugin->responses[plugin->n_responses] = plugin->last_response;
+  }
+
+  ++plugin->n_responses;
+  return LV2_WORKER_SUCCESS;
+}
+
+static LV2_Worker_Status
+end_run(LV2_Handle instance)
+{
+  ++((TestPlugin*)instance)->n_end_runs;
+  return LV2_WORKER_SUCCESS;
+}
+
+static void
+notify(void* handle)
+{
+  ++*(uint32_t*)handle;
+}
+
+static LV2_Worker_Status
+schedule_value(LV2_Worker_Pool_Slot* const slot, const uint32_t value)
+{
+  return slot->schedule.schedule_work(
+    slot->schedule.handle, sizeof(value), &value);
+}
+
+static LV2_Worker_Status
+schedule_keyed_value(LV2_Worker_Pool_Slot* const slot,
+                     const uint32_t              key,
+                     const uint32_t              value)
+{
+  return slot->keyed_schedule.schedule_keyed_work(
+    slot->keyed_schedule.handle, key, sizeof(value), &value);
+}
+
+static void
+test_ring(void)
+{
+  uint8_t         buf[16];
+  uint8_t         out[16];
+  uint32_t        size = 0U;
+  LV2_Worker_Ring ring;
+
+  assert(!lv2_worker_ring_init(&ring, buf, 12U));
+  assert(lv2_worker_ring_init(&ring, buf, sizeof(buf)));
+  assert(!lv2_worker_ring_read(&ring, sizeof(out), out, &size));
+
+  // Write and read messages that wrap around the end of the buffer
+  for (uint32_t i = 0U; i < 16U; ++i) {
+    const char msg[] = "wrapped";
+    assert(!lv2_worker_ring_write(&ring, sizeof(msg), msg));
+    assert(lv2_worker_ring_write_space(&ring) == 4U);
+    assert(lv2_worker_ring_write(&ring, 1U, msg) == LV2_WORKER_ERR_NO_SPACE);
+    assert(lv2_worker_ring_read(&ring, sizeof(out), out, &size));
+    assert(size == sizeof(msg));
+    assert(!memcmp(out, msg, sizeof(msg)));
+    assert(!lv2_worker_ring_read_space(&ring));
+  }
+
+  // Messages larger than the output buffer are discarded
+  assert(!lv2_worker_ring_write(&ring, 8U, "discard"));
+  assert(lv2_worker_ring_read(&ring, 4U, out, &size));
+  assert(size == 0U);
+  assert(!lv2_worker_ring_read_space(&ring));
+}
+
+static void
+test_pool(void)
+{
+  static const LV2_Worker_Interface iface = {work, work_response, end_run};
+
+  static uint8_t memory[N_SLOTS][LV2_WORKER_POOL_SLOT_MEMORY(RING_SIZE)];
+
+  uint8_t               buf[RING_SIZE];
+  TestPlugin            plugins[N_SLOTS];
+  LV2_Worker_Pool_Slot  slots[N_SLOTS];
+  LV2_Worker_Pool_Slot* slot_ptrs[N_SLOTS - 1U];
+  LV2_Worker_Pool       pool;
+  uint32_t              n_notifications = 0U;
+
+  memset(plugins, 0, sizeof(plugins));
+  lv2_worker_pool_init(
+    &pool, slot_ptrs, N_SLOTS - 1U, notify, &n_notifications);
+  assert(!lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+
+  for (uint32_t i = 0U; i < N_SLOTS; ++i) {
+    assert(lv2_worker_pool_slot_init(
+      &slots[i], &plugins[i], &iface, memory[i], RING_SIZE));
+  }
+
+  // Scheduling fails before the slot is added to a pool
+  assert(schedule_value(&slots[0], 1U) == LV2_WORKER_ERR_UNKNOWN);
+
+  // Add slots until the pool is full
+  for (uint32_t i = 0U; i < N_SLOTS - 1U; ++i) {
+    assert(lv2_worker_pool_add(&pool, &slots[i]));
+  }
+  assert(!lv2_worker_pool_add(&pool, &slots[N_SLOTS - 1U]));
+
+  // Schedule a few requests for every instance
+  for (uint32_t i = 0U; i < N_SLOTS - 1U; ++i) {
+    for (uint32_t j = 1U; j <= 3U; ++j) {
+      assert(!schedule_value(&slots[i], (i * 10U) + j));
+    }
+  }
+  assert(n_notifications == 9U);
+  assert(pool.n_pending == 9U);
+
+  // Fill a request ring (24 bytes per request) until scheduling fails
+  uint32_t n_extra = 0U;
+  while (!schedule_value(&slots[0], 100U)) {
+    ++n_extra;
+  }
+  assert(n_extra == (RING_SIZE / 24U) - 3U);
+  assert(pool.n_pending == 9U + n_extra);
+
+  // Execute everything, which must be done fairly and in order per instance
+  uint32_t n_run = 0U;
+  while (lv2_worker_pool_run_one(&pool, buf, sizeof(buf))) {
+    ++n_run;
+    if (n_run == 3U) {
+      for (uint32_t i = 0U; i < N_SLOTS - 1U; ++i) {
+        assert(plugins[i].n_work == 1U);
+      }
+    }
+  }
+  assert(n_run == 9U + n_extra);
+  assert(pool.n_pending == 0U);
+  assert(plugins[1].n_work == 3U);
+
+  // Nothing is delivered until the audio thread calls deliver
+  assert(!plugins[1].n_responses);
+  lv2_worker_pool_deliver(&slots[1]);
+  assert(plugins[1].n_responses == 3U);
+  assert(plugins[1].last_response == 26U);
+  assert(plugins[1].n_end_runs == 1U);
+
+  // Removing a slot discards requests which have not been started
+  assert(!schedule_value(&slots[2], 5U));
+  assert(pool.n_pending == 1U);
+  lv2_worker_pool_remove(&pool, &slots[2]);
+  assert(pool.n_pending == 0U);
+  assert(!lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+  assert(lv2_worker_pool_add(&pool, &slots[N_SLOTS - 1U]));
+
+  // Synchronous slots execute work immediately
+  lv2_worker_pool_slot_set_synchronous(&slots[0], true);
+  lv2_worker_pool_deliver(&slots[0]);
+  assert(plugins[0].n_responses == 3U + n_extra);
+  assert(!schedule_value(&slots[0], 21U));
+  assert(plugins[0].n_work == 4U + n_extra);
+  lv2_worker_pool_deliver(&slots[0]);
+  assert(plugins[0].last_response == 42U);
+  assert(plugins[0].n_end_runs == 2U);
+
+  // Otherwise, work is left to pool threads again
+  lv2_worker_pool_slot_set_synchronous(&slots[0], false);
+  assert(!schedule_value(&slots[0], 22U));
+  assert(plugins[0].n_work == 4U + n_extra);
+  assert(lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+  assert(plugins[0].n_work == 5U + n_extra);
+}
+
+static void
+test_keyed(void)
+{
+  static const LV2_Worker_Interface iface = {work, work_response, NULL};
+
+  uint8_t               memory[LV2_WORKER_POOL_SLOT_MEMORY(1024U)];
+  uint8_t               buf[1024U];
+  TestPlugin            plugin;
+  LV2_Worker_Pool_Slot  slot;
+  LV2_Worker_Pool_Slot* slot_ptr = NULL;
+  LV2_Worker_Pool       pool;
+
+  memset(&plugin, 0, sizeof(plugin));
+  plugin.slot = &slot;
+  lv2_worker_pool_init(&pool, &slot_ptr, 1U, NULL, NULL);
+  assert(lv2_worker_pool_slot_init(&slot, &plugin, &iface, memory, 1024U));
+  assert(lv2_worker_pool_add(&pool, &slot));
+
+  // Only the latest request for a key is executed, unkeyed ones always are
+  assert(!schedule_keyed_value(&slot, 7U, 1U));
+  assert(!schedule_value(&slot, 2U));
+  assert(!schedule_keyed_value(&slot, 7U, 3U));
+  assert(!schedule_keyed_value(&slot, 8U, 4U));
+  assert(!schedule_keyed_value(&slot, 7U, 5U));
+  while (lv2_worker_pool_run_one(&pool, buf, sizeof(buf))) {
+  }
+  assert(plugin.n_work == 3U);
+  assert(pool.n_pending == 0U);
+  lv2_worker_pool_deliver(&slot);
+  assert(plugin.n_responses == 3U);
+  assert(plugin.last_response == 10U);
+
+  // A running request is superseded by a new one with the same key
+  assert(!schedule_keyed_value(&slot, 7U, 99U));
+  assert(lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+  assert(plugin.superseded);
+  assert(lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+  assert(plugin.n_work == 5U);
+  plugin.superseded = false;
+
+  // Requests are never skipped when there are too many keys to track
+  plugin.n_work = 0U;
+  for (uint32_t i = 0U; i < 2U; ++i) {
+    for (uint32_t k = 1U; k <= LV2_WORKER_POOL_N_KEYS + 1U; ++k) {
+      assert(!schedule_keyed_value(&slot, 100U + k, k));
+    }
+  }
+  while (lv2_worker_pool_run_one(&pool, buf, sizeof(buf))) {
+  }
+  assert(plugin.n_work == LV2_WORKER_POOL_N_KEYS + 2U);
+  assert(!plugin.superseded);
+}
+
+static LV2_Worker_Status
+schedule_prioritized_value(LV2_Worker_Pool_Slot* const slot,
+                           const LV2_Worker_Priority   priority,
+                           const uint32_t              deadline,
+                           const uint32_t              value)
+{
+  return slot->priority_schedule.schedule_prioritized_work(
+    slot->priority_schedule.handle, priority, deadline, sizeof(value), &value);
+}
+
+static void
+test_priority(void)
+{
+  static const LV2_Worker_Interface iface = {work, work_response, NULL};
+  static uint8_t memory[N_SLOTS][LV2_WORKER_POOL_SLOT_MEMORY(RING_SIZE)];
+
+  uint8_t               buf[RING_SIZE];
+  TestPlugin            plugins[N_SLOTS];
+  LV2_Worker_Pool_Slot  slots[N_SLOTS];
+  LV2_Worker_Pool_Slot* slot_ptrs[N_SLOTS];
+  LV2_Worker_Pool       pool;
+
+  memset(plugins, 0, sizeof(plugins));
+  lv2_worker_pool_init(&pool, slot_ptrs, N_SLOTS, NULL, NULL);
+  for (uint32_t i = 0U; i < N_SLOTS; ++i) {
+    assert(lv2_worker_pool_slot_init(
+      &slots[i], &plugins[i], &iface, memory[i], RING_SIZE));
+    assert(lv2_worker_pool_add(&pool, &slots[i]));
+  }
+
+  // Deadlines are relative to the pool time, which may wrap around
+  lv2_worker_pool_set_time(&pool, UINT32_MAX - 5U);
+
+  assert(!schedule_prioritized_value(
+    &slots[0], LV2_WORKER_PRIORITY_BACKGROUND, 1U, 1U));
+  assert(!schedule_prioritized_value(
+    &slots[1], LV2_WORKER_PRIORITY_NORMAL, 100U, 2U));
+  assert(!schedule_prioritized_value(
+    &slots[2], LV2_WORKER_PRIORITY_URGENT, LV2_WORKER_NO_DEADLINE, 3U));
+  assert(!schedule_prioritized_value(
+    &slots[3], LV2_WORKER_PRIORITY_NORMAL, 10U, 4U));
+  assert(!schedule_value(&slots[3], 5U));
+
+  // Slots are served by priority, then deadline, and each slot is in order
+  static const uint32_t expected[] = {2U, 3U, 3U, 1U, 0U};
+  for (uint32_t i = 0U; i < sizeof(expected) / sizeof(uint32_t); ++i) {
+    const uint32_t before = plugins[expected[i]].n_work;
+    assert(lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+    assert(plugins[expected[i]].n_work == before + 1U);
+  }
+  assert(!lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+
+  // The urgency of a slot is reset once it has no pending requests
+  for (uint32_t i = 0U; i < N_SLOTS; ++i) {
+    assert(slots[i].priority == LV2_WORKER_PRIORITY_BACKGROUND);
+    assert(slots[i].deadline == LV2_WORKER_NO_DEADLINE);
+  }
+}
+
+static uint64_t
+test_clock(void* handle)
+{
+  uint64_t* const time = (uint64_t*)handle;
+
+  return *time += 10U;
+}
+
+static void
+test_stats(void)
+{
+  static const LV2_Worker_Interface iface = {work, work_response, NULL};
+  static uint8_t memory[LV2_WORKER_POOL_SLOT_MEMORY(RING_SIZE)];
+
+  uint8_t               buf[RING_SIZE];
+  uint32_t              counts[LV2_WORKER_HISTOGRAM_N_BUCKETS];
+  TestPlugin            plugin;
+  LV2_Worker_Pool_Slot  slot;
+  LV2_Worker_Pool_Slot* slot_ptr = NULL;
+  LV2_Worker_Pool       pool;
+  LV2_Worker_Stats      worker_stats;
+  LV2_Worker_Stats      audio_stats;
+  uint64_t              time = 0U;
+
+  // Latencies are bucketed by their base 2 logarithm
+  assert(lv2_worker_histogram_bucket(0U) == 0U);
+  assert(lv2_worker_histogram_bucket(1U) == 0U);
+  assert(lv2_worker_histogram_bucket(2U) == 1U);
+  assert(lv2_worker_histogram_bucket(1023U) == 9U);
+  assert(lv2_worker_histogram_bucket(UINT64_MAX) ==
+         LV2_WORKER_HISTOGRAM_N_BUCKETS - 1U);
+
+  memset(&plugin, 0, sizeof(plugin));
+  lv2_worker_stats_init(&worker_stats);
+  lv2_worker_stats_init(&audio_stats);
+  lv2_worker_pool_init(&pool, &slot_ptr, 1U, NULL, NULL);
+  lv2_worker_pool_set_clock(&pool, test_clock, &time);
+  assert(lv2_worker_pool_slot_init(&slot, &plugin, &iface, memory, RING_SIZE));
+  assert(lv2_worker_pool_add(&pool, &slot));
+
+  // Every stage is timestamped by the clock, which advances 10 per call
+  assert(!schedule_value(&slot, 1U));
+  time += 1000U;
+  assert(lv2_worker_pool_run_one_measured(
+    &pool, buf, sizeof(buf), &worker_stats));
+  lv2_worker_pool_deliver_measured(&slot, &audio_stats);
+  assert(plugin.last_response == 2U);
+
+  // Each stage is recorded by the thread that completes it
+  const struct {
+    LV2_Worker_Stats* stats;
+    LV2_Worker_Stage  stage;
+    uint32_t          bucket;
+  } expected[] = {
+    {&worker_stats, LV2_WORKER_STAGE_QUEUED, 9U},
+    {&worker_stats, LV2_WORKER_STAGE_WORKING, 3U},
+    {&audio_stats, LV2_WORKER_STAGE_RESPONDING, 3U},
+    {&audio_stats, LV2_WORKER_STAGE_ROUND_TRIP, 10U},
+  };
+
+  for (uint32_t i = 0U; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+    memset(counts, 0, sizeof(counts));
+    lv2_worker_histogram_snapshot(&expected[i].stats->stages[expected[i].stage],
+                                  counts);
+    for (uint32_t b = 0U; b < LV2_WORKER_HISTOGRAM_N_BUCKETS; ++b) {
+      assert(counts[b] == (b == expected[i].bucket ? 1U : 0U));
+    }
+
+    assert(lv2_worker_histogram_percentile(counts, 50.0) ==
+           (uint64_t)1U << (expected[i].bucket + 1U));
+  }
+
+  // Snapshots of several threads can be merged
+  memset(counts, 0, sizeof(counts));
+  lv2_worker_histogram_snapshot(
+    &worker_stats.stages[LV2_WORKER_STAGE_WORKING], counts);
+  lv2_worker_histogram_snapshot(
+    &audio_stats.stages[LV2_WORKER_STAGE_RESPONDING], counts);
+  assert(counts[3] == 2U);
+
+  // Resetting only affects later snapshots
+  LV2_Worker_Histogram* const queued =
+    &worker_stats.stages[LV2_WORKER_STAGE_QUEUED];
+  lv2_worker_histogram_reset(queued);
+  memset(counts, 0, sizeof(counts));
+  lv2_worker_histogram_snapshot(queued, counts);
+  assert(!lv2_worker_histogram_percentile(counts, 99.0));
+  lv2_worker_histogram_record(queued, UINT64_MAX);
+  lv2_worker_histogram_snapshot(queued, counts);
+  assert(counts[LV2_WORKER_HISTOGRAM_N_BUCKETS - 1U] == 1U);
+  assert(lv2_worker_histogram_percentile(counts, 99.0) == UINT64_MAX);
+
+  // Without a clock, nothing is recorded
+  lv2_worker_pool_set_clock(&pool, NULL, NULL);
+  lv2_worker_stats_init(&worker_stats);
+  assert(!schedule_value(&slot, 2U));
+  assert(lv2_worker_pool_run_one_measured(
+    &pool, buf, sizeof(buf), &worker_stats));
+  for (uint32_t s = 0U; s < LV2_WORKER_N_STAGES; ++s) {
+    memset(counts, 0, sizeof(counts));
+    lv2_worker_histogram_snapshot(&worker_stats.stages[s], counts);
+    assert(!lv2_worker_histogram_percentile(counts, 100.0));
+  }
+}
+
+static void
+test_reentrant(void)
+{
+  static const LV2_Worker_Interface iface = {work, work_response, NULL};
+  static uint8_t memory[LV2_WORKER_POOL_SLOT_MEMORY(RING_SIZE)];
+
+  uint8_t               buf[RING_SIZE];
+  TestPlugin            plugin;
+  LV2_Worker_Pool_Slot  slot;
+  LV2_Worker_Pool_Slot* slot_ptr = NULL;
+  LV2_Worker_Pool       pool;
+
+  // The ring must be large enough to split into lanes that fit a response
+  assert(lv2_worker_pool_slot_init(&slot, &plugin, &iface, memory, 16U));
+  assert(!lv2_worker_pool_slot_set_reentrant(&slot));
+  assert(lv2_worker_pool_slot_init(&slot, &plugin, &iface, memory, 64U));
+  assert(!lv2_worker_pool_slot_set_reentrant(&slot));
+
+  for (uint32_t reentrant = 0U; reentrant < 2U; ++reentrant) {
+    memset(&plugin, 0, sizeof(plugin));
+    plugin.pool = &pool;
+    plugin.slot = &slot;
+    lv2_worker_pool_init(&pool, &slot_ptr, 1U, NULL, NULL);
+    assert(
+      lv2_worker_pool_slot_init(&slot, &plugin, &iface, memory, RING_SIZE));
+    assert(!reentrant || lv2_worker_pool_slot_set_reentrant(&slot));
+    assert(lv2_worker_pool_add(&pool, &slot));
+
+    // The second request only starts during the first if work() is reentrant
+    assert(!schedule_value(&slot, 50U));
+    assert(!schedule_value(&slot, 51U));
+    assert(lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+    assert(plugin.nested == (bool)reentrant);
+    assert(plugin.n_responses == 1U);
+    assert(plugin.responses[0] == 99U);
+    while (lv2_worker_pool_run_one(&pool, buf, sizeof(buf))) {
+    }
+
+    // Responses are delivered in request order either way
+    lv2_worker_pool_deliver(&slot);
+    assert(plugin.n_work == 2U);
+    assert(plugin.n_responses == 3U);
+    assert(plugin.responses[1] == 100U);
+    assert(plugin.responses[2] == 102U);
+  }
+
+  // Synchronous re-entrant slots respond through lanes as well
+  lv2_worker_pool_slot_set_synchronous(&slot, true);
+  plugin.pool = NULL;
+  assert(!schedule_value(&slot, 7U));
+  lv2_worker_pool_deliver(&slot);
+  assert(plugin.n_responses == 4U);
+  assert(plugin.last_response == 14U);
+
+  // Responses that would not leave room to end the job are refused
+  const uint32_t      lane_size = RING_SIZE / LV2_WORKER_POOL_N_LANES;
+  const uint32_t      overhead  = 8U + sizeof(LV2_Worker_Pool_Response);
+  LV2_Worker_Pool_Job job       = {&slot, &slot.lanes[0], 0U, 0U, 0U, 0U, NULL};
+  assert(lv2_worker_pool_respond(&job, lane_size - overhead + 1U, buf) ==
+         LV2_WORKER_ERR_NO_SPACE);
+
+  lv2_worker_pool_remove(&pool, &slot);
+}
+
+// Responds with as many bytes as requested, or not at all for zero
+static LV2_Worker_Status
+work_sized(LV2_Handle                  instance,
+           LV2_Worker_Respond_Function respond,
+           LV2_Worker_Respond_Handle   handle,
+           const uint32_t              size,
+           const void*                 data)
+{
+  TestPlugin* const plugin        = (TestPlugin*)instance;
+  uint8_t           body[RING_SIZE] = {0U};
+  uint32_t          n_bytes         = 0U;
+
+  assert(size == sizeof(n_bytes));
+  memcpy(&n_bytes, data, sizeof(n_bytes));
+  ++plugin->n_work;
+
+  return n_bytes ? respond(handle, n_bytes, body) : LV2_WORKER_SUCCESS;
+}
+
+static LV2_Worker_Status
+work_sized_response(LV2_Handle instance, const uint32_t size, const void* body)
+{
+  TestPlugin* const plugin = (TestPlugin*)instance;
+
+  (void)body;
+  plugin->last_response = size;
+  ++plugin->n_responses;
+  return LV2_WORKER_SUCCESS;
+}
+
+// A lane is only reused once the responses of its previous job are delivered,
+// so a job that fills its lane can not stop a later job from ending
+static void
+test_lanes(void)
+{
+  static const LV2_Worker_Interface iface = {
+    work_sized, work_sized_response, NULL};
+
+  static uint8_t memory[LV2_WORKER_POOL_SLOT_MEMORY(2U * RING_SIZE)];
+
+  uint8_t               buf[2U * RING_SIZE];
+  TestPlugin            plugin;
+  LV2_Worker_Pool_Slot  slot;
+  LV2_Worker_Pool_Slot* slot_ptr = NULL;
+  LV2_Worker_Pool       pool;
+
+  memset(&plugin, 0, sizeof(plugin));
+  lv2_worker_pool_init(&pool, &slot_ptr, 1U, NULL, NULL);
+  assert(lv2_worker_pool_slot_init(
+    &slot, &plugin, &iface, memory, 2U * RING_SIZE));
+  assert(lv2_worker_pool_slot_set_reentrant(&slot));
+  assert(lv2_worker_pool_add(&pool, &slot));
+
+  // The first job fills its 64-byte lane, then the next lane use waits for it
+  static const uint32_t sizes[] = {40U, 0U, 0U, 0U, 0U, 4U};
+  for (uint32_t i = 0U; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+    assert(!schedule_value(&slot, sizes[i]));
+  }
+
+  while (lv2_worker_pool_run_one(&pool, buf, sizeof(buf))) {
+  }
+
+  assert(plugin.n_work == LV2_WORKER_POOL_N_LANES);
+  assert(pool.n_pending == 2U);
+
+  lv2_worker_pool_deliver(&slot);
+  assert(plugin.n_responses == 1U);
+  assert(plugin.last_response == 40U);
+
+  while (lv2_worker_pool_run_one(&pool, buf, sizeof(buf))) {
+  }
+
+  lv2_worker_pool_deliver(&slot);
+  assert(plugin.n_work == 6U);
+  assert(plugin.n_responses == 2U);
+  assert(plugin.last_response == 4U);
+
+  // Later cycles still deliver every response
+  for (uint32_t c = 0U; c < 2U * LV2_WORKER_POOL_N_LANES; ++c) {
+    assert(!schedule_value(&slot, 40U));
+    assert(lv2_worker_pool_run_one(&pool, buf, sizeof(buf)));
+    lv2_worker_pool_deliver(&slot);
+    assert(plugin.n_responses == 3U + c);
+  }
+
+  lv2_worker_pool_remove(&pool, &slot);
+}
+
+#ifndef _WIN32
+
+typedef struct {
+  LV2_Worker_Pool*  pool;
+  volatile uint32_t stop;
+} StressHost;
+
+typedef struct {
+  LV2_Worker_Pool_Slot slot;
+  TestPlugin           plugin;
+  uint8_t              memory[LV2_WORKER_POOL_SLOT_MEMORY(RING_SIZE)];
+} StressInstance;
+
+static void*
+stress_thread(void* data)
+{
+  StressHost* const host = (StressHost*)data;
+  uint8_t           buf[RING_SIZE];
+
+  while (!lv2_atomic_load(&host->stop)) {
+    if (!lv2_worker_pool_run_one(host->pool, buf, sizeof(buf))) {
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+// Repeatedly adds an instance with requests, removes it, and frees it, while
+// pool threads run, which must never touch the slot after it is removed
+static void
+test_stress(void)
+{
+  static const LV2_Worker_Interface iface = {work, work_response, NULL};
+
+  LV2_Worker_Pool_Slot* slot_ptrs[N_SLOTS];
+  LV2_Worker_Pool       pool;
+  StressHost            host = {&pool, 0U};
+  pthread_t             threads[N_THREADS];
+
+  lv2_worker_pool_init(&pool, slot_ptrs, N_SLOTS, NULL, NULL);
+  for (uint32_t i = 0U; i < N_THREADS; ++i) {
+    assert(!pthread_create(&threads[i], NULL, stress_thread, &host));
+  }
+
+  for (uint32_t r = 0U; r < N_STRESS_RUNS; ++r) {
+    StressInstance* const instance =
+      (StressInstance*)calloc(1U, sizeof(StressInstance));
+
+    assert(instance);
+    assert(lv2_worker_pool_slot_init(&instance->slot,
+                                     &instance->plugin,
+                                     &iface,
+                                     instance->memory,
+                                     RING_SIZE));
+    assert(lv2_worker_pool_add(&pool, &instance->slot));
+    for (uint32_t j = 1U; j <= 3U; ++j) {
+      assert(!schedule_value(&instance->slot, j));
+    }
+
+    // Give pool threads a varying head start, to remove at different points
+    for (uint32_t y = 0U; y < r % 4U; ++y) {
+      sched_yield();
+    }
+
+    lv2_worker_pool_remove(&pool, &instance->slot);
+    assert(instance->plugin.n_work <= 3U);
+    memset(instance, 0xFF, sizeof(StressInstance));
+    free(instance);
+  }
+
+  lv2_atomic_store(&host.stop, 1U);
+  for (uint32_t i = 0U; i < N_THREADS; ++i) {
+    assert(!pthread_join(threads[i], NULL));
+  }
+
+  assert(!pool.n_pending);
+  assert(!pool.n_claims[0] && !pool.n_claims[1]);
+}
+
+#endif
+
+int
+main(void)
+{
+  test_ring();
+  test_pool();
+  test_keyed();
+  test_priority();
+  test_stats();
+  test_reentrant();
+  test_lanes();
+#ifndef _WIN32
+  test_stress();
+#endif
+  return 0;
+}
@@ -0,0 +1,242 @@
+// Copyright 2026 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+#undef NDEBUG
+
+#include <lv2/core/atomic.h>
+#include <lv2/worker/tasks.h>
+#include <lv2/worker/worker.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef _WIN32
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
+#define N_BANDS 12U
+#define N_CALLERS 3U
+#define N_HELPERS 3U
+#define N_STRESS_TASKS 64U
+#define N_STRESS_RUNS 2000U
+
+typedef struct {
+  uint32_t results[N_BANDS];
+  uint32_t threads[N_BANDS];
+  uint32_t thread;
+} TestPlugin;
+
+typedef struct {
+  LV2_Worker_Tasks* tasks;
+  TestPlugin*       plugin;
+  uint32_t          n_notifies;
+  uint32_t          n_helped;
+  bool              help;
+} TestHost;
+
+static void
+process_band(void* data, uint32_t index)
+{
+  TestPlugin* const plugin = (TestPlugin*)data;
+
+  assert(index < N_BANDS);
+  assert(!plugin->results[index]);
+  plugin->results[index] = (index + 1U) * 10U;
+  plugin->threads[index] = plugin->thread;
+}
+
+// Simulates another host thread helping as soon as it is notified
+static void
+notify(void* handle, uint32_t n_tasks)
+{
+  TestHost* const host = (TestHost*)handle;
+
+  assert(n_tasks == N_BANDS);
+  ++host->n_notifies;
+  if (host->help) {
+    host->plugin->thread = 1U;
+    while (lv2_worker_tasks_help(host->tasks)) {
+      ++host->n_helped;
+    }
+
+    host->plugin->thread = 0U;
+  }
+}
+
+static void
+run_plugin(const LV2_Worker_Task_Scheduler* const scheduler,
+           TestPlugin* const                      plugin)
+{
+  memset(plugin, 0, sizeof(TestPlugin));
+  scheduler->run_tasks(scheduler->handle, process_band, plugin, N_BANDS);
+  for (uint32_t i = 0U; i < N_BANDS; ++i) {
+    assert(plugin->results[i] == (i + 1U) * 10U);
+  }
+}
+
+static void
+test_tasks(void)
+{
+  LV2_Worker_Tasks tasks;
+  TestPlugin       plugin;
+  TestHost         host = {&tasks, &plugin, 0U, 0U, false};
+
+  lv2_worker_tasks_init(&tasks, 3U, notify, &host);
+
+  const LV2_Worker_Task_Scheduler* const scheduler = &tasks.scheduler;
+  assert(scheduler->concurrency(scheduler->handle) == 4U);
+
+  // Without help, the calling thread runs every task
+  run_plugin(scheduler, &plugin);
+  assert(host.n_notifies == 1U);
+  assert(tasks.n_jobs == 1U);
+  assert(!tasks.n_inline);
+
+  // A helping thread takes all the tasks the caller has not started yet
+  host.help = true;
+  run_plugin(scheduler, &plugin);
+  assert(host.n_notifies == 2U);
+  assert(host.n_helped == 1U);
+  for (uint32_t i = 0U; i < N_BANDS; ++i) {
+    assert(plugin.threads[i] == 1U);
+  }
+
+  // Every job is finished and closed, so there is nothing left to help with
+  for (uint32_t i = 0U; i < LV2_WORKER_TASKS_N_JOBS; ++i) {
+    assert(!tasks.jobs[i].owner);
+    assert(!tasks.jobs[i].state);
+  }
+
+  assert(!lv2_worker_tasks_help(&tasks));
+
+  // If every slot is taken, tasks run in the caller without notifying
+  for (uint32_t i = 0U; i < LV2_WORKER_TASKS_N_JOBS; ++i) {
+    tasks.jobs[i].owner = 1U;
+  }
+
+  run_plugin(scheduler, &plugin);
+  assert(host.n_notifies == 2U);
+  assert(tasks.n_inline == 1U);
+  assert(tasks.n_jobs == 2U);
+
+  for (uint32_t i = 0U; i < LV2_WORKER_TASKS_N_JOBS; ++i) {
+    tasks.jobs[i].owner = 0U;
+  }
+
+  // Without host threads, tasks always run in the caller
+  lv2_worker_tasks_init(&tasks, 0U, notify, &host);
+  assert(scheduler->concurrency(scheduler->handle) == 1U);
+  run_plugin(scheduler, &plugin);
+  assert(tasks.n_inline == 1U);
+  assert(host.n_notifies == 2U);
+}
+
+#ifndef _WIN32
+
+typedef struct {
+  LV2_Worker_Tasks* tasks;
+  volatile uint32_t counts[N_STRESS_TASKS];
+} StressCaller;
+
+typedef struct {
+  LV2_Worker_Tasks* tasks;
+  volatile uint32_t stop;
+} StressHelper;
+
+static void
+count_task(void* data, uint32_t index)
+{
+  StressCaller* const caller = (StressCaller*)data;
+
+  assert(index < N_STRESS_TASKS);
+  lv2_atomic_add(&caller->counts[index], 1U);
+}
+
+static void*
+stress_caller(void* data)
+{
+  StressCaller* const     caller = (StressCaller*)data;
+  LV2_Worker_Tasks* const tasks  = caller->tasks;
+
+  for (uint32_t r = 0U; r < N_STRESS_RUNS; ++r) {
+    tasks->scheduler.run_tasks(tasks, count_task, caller, N_STRESS_TASKS);
+    for (uint32_t i = 0U; i < N_STRESS_TASKS; ++i) {
+      assert(lv2_atomic_exchange(&caller->counts[i], 0U) == 1U);
+    }
+  }
+
+  return NULL;
+}
+
+static void*
+stress_helper(void* data)
+{
+  StressHelper* const helper = (StressHelper*)data;
+
+  while (!lv2_atomic_load(&helper->stop)) {
+    if (!lv2_worker_tasks_help(helper->tasks)) {
+      sched_yield();
+    }
+  }
+
+  return NULL;
+}
+
+// Runs jobs from several threads at once, while others help, and checks
+// that every task of every job runs exactly once
+static void
+test_stress(void)
+{
+  LV2_Worker_Tasks tasks;
+  StressCaller     callers[N_CALLERS];
+  StressHelper     helper;
+  pthread_t        caller_threads[N_CALLERS];
+  pthread_t        helper_threads[N_HELPERS];
+
+  lv2_worker_tasks_init(&tasks, N_HELPERS, NULL, NULL);
+  memset(callers, 0, sizeof(callers));
+  memset(&helper, 0, sizeof(helper));
+  helper.tasks = &tasks;
+
+  for (uint32_t i = 0U; i < N_HELPERS; ++i) {
+    assert(!pthread_create(&helper_threads[i], NULL, stress_helper, &helper));
+  }
+
+  for (uint32_t i = 0U; i < N_CALLERS; ++i) {
+    callers[i].tasks = &tasks;
+    assert(
+      !pthread_create(&caller_threads[i], NULL, stress_caller, &callers[i]));
+  }
+
+  for (uint32_t i = 0U; i < N_CALLERS; ++i) {
+    assert(!pthread_join(caller_threads[i], NULL));
+  }
+
+  lv2_atomic_store(&helper.stop, 1U);
+  for (uint32_t i = 0U; i < N_HELPERS; ++i) {
+    assert(!pthread_join(helper_threads[i], NULL));
+  }
+
+  // There are enough slots for every caller, so no job ran inline
+  assert(tasks.n_jobs == N_CALLERS * N_STRESS_RUNS);
+  assert(!tasks.n_inline);
+  for (uint32_t i = 0U; i < LV2_WORKER_TASKS_N_JOBS; ++i) {
+    assert(!tasks.jobs[i].owner);
+    assert(!tasks.jobs[i].state);
+  }
+}
+
+#endif
+
+int
+main(void)
+{
+  test_tasks();
+#ifndef _WIN32
+  test_stress();
+#endif
+  return 0;
+}